@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "NadaBigInt.h"
+
+// Find the division crossover for NadaBigInt.h. For each size n (in limbs) a
+// 2n-limb dividend is divided by an n-limb divisor, once with Algorithm D and
+// once with the Newton reciprocal. The first size from which Newton keeps
+// winning is the suggested threshold. Every result is checked against
+// a == q * b + r with r < b.
+
+static const size_t sizes[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+#define SIZE_COUNT (sizeof(sizes) / sizeof(sizes[0]))
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void random_big(NadaBigInt *r, size_t limbs) {
+    nada_big_set_u64(r, 0);
+    for (size_t i = 0; i < limbs; i++) {
+        nada_big_shl(r, r, NADA_LIMB_BITS);
+        nada_big_add_small(r, r, (NadaLimb)rand() ^ ((NadaLimb)rand() << 16));
+    }
+    nada_big_add_small(r, r, 1);
+}
+
+// Seconds per division with the given threshold (best of five runs)
+static double time_div(const NadaBigInt *a, const NadaBigInt *b, NadaBigInt *q, NadaBigInt *r,
+                       size_t newton) {
+    nada_big_newton_threshold = newton;
+
+    double best = 0.0;
+    for (int run = 0; run < 5; run++) {
+        int reps = 1;
+        double elapsed;
+        do {
+            double start = now_seconds();
+            for (int i = 0; i < reps; i++) {
+                nada_big_divmod(q, r, a, b);
+            }
+            elapsed = now_seconds() - start;
+            reps *= 2;
+        } while (elapsed < 0.01);
+        double per_div = elapsed / (reps / 2);
+        if (run == 0 || per_div < best) best = per_div;
+    }
+    return best;
+}
+
+// Check a == q * b + r and r < b
+static int check_div(const NadaBigInt *a, const NadaBigInt *b, const NadaBigInt *q, const NadaBigInt *r) {
+    NadaBigInt t = NADA_BIG_INIT;
+    nada_big_mul(&t, q, b);
+    nada_big_add(&t, &t, r);
+    int ok = nada_big_cmp(&t, a) == 0 && nada_big_cmp(r, b) < 0;
+    nada_big_free(&t);
+    return ok;
+}
+
+int main(void) {
+    double knuth[SIZE_COUNT], newton[SIZE_COUNT];
+    NadaBigInt a = NADA_BIG_INIT, b = NADA_BIG_INIT, q = NADA_BIG_INIT, r = NADA_BIG_INIT;
+    int failures = 0;
+
+    srand(1);
+
+    printf("%8s %14s %14s\n", "limbs", "algorithm D us", "newton us");
+    for (size_t i = 0; i < SIZE_COUNT; i++) {
+        random_big(&a, 2 * sizes[i]);
+        random_big(&b, sizes[i]);
+        knuth[i] = time_div(&a, &b, &q, &r, SIZE_MAX);
+        if (!check_div(&a, &b, &q, &r)) failures++;
+        newton[i] = time_div(&a, &b, &q, &r, 1);
+        if (!check_div(&a, &b, &q, &r)) failures++;
+        printf("%8zu %14.2f %14.2f\n", sizes[i], knuth[i] * 1e6, newton[i] * 1e6);
+    }
+
+    size_t threshold = 0;
+    for (size_t i = 0; i < SIZE_COUNT; i++) {
+        if (newton[i] < knuth[i]) {
+            if (!threshold) threshold = sizes[i];
+        } else {
+            threshold = 0;
+        }
+    }
+    printf("\nNewton threshold: %zu limbs (default %d)\n", threshold, NADA_BIG_NEWTON_THRESHOLD);
+    if (failures) printf("ERROR: %d divisions gave a wrong result\n", failures);
+
+    nada_big_free(&a);
+    nada_big_free(&b);
+    nada_big_free(&q);
+    nada_big_free(&r);
+    return failures != 0;
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "NadaEval.h"
+#include "NadaParser.h"
+#include "NadaValue.h"
+#include "NadaEnv.h"
+#include "NadaVM.h"
+
+// Evaluator workloads dominated by short-lived temporaries: arithmetic
+// steps, list building/mapping and small function calls. Each case runs
+// its step expression `iterations` times against a fresh standard env,
+// once with function bodies on the analyzed tree and once on the VM.
+
+typedef struct {
+    const char *name;
+    const char *setup;
+    const char *step;
+    int iterations;
+} BenchCase;
+
+static const BenchCase cases[] = {
+    {"arith", "(define acc 0)", "(set! acc (+ acc (* 3 (- 1000 999)) (/ 10 5)))", 200000},
+    {"calls", "(define (sq x) (* x x)) (define (f a b) (+ (sq a) (sq b)))", "(f 12 34)", 200000},
+    {"map", "(define xs (list 1 2 3 4 5 6 7 8 9 10))", "(map (lambda (x) (* x x)) xs)", 50000},
+    {"lists", "(define (mk n) (if (= n 0) '() (cons n (mk (- n 1)))))", "(length (mk 50))", 5000},
+    {"frames", "(define (g a b c d) (let ((x (+ a b)) (y (+ c d))) (let ((z (* x y))) (+ z a b c d x y))))",
+     "(g 1 2 3 4)", 100000},
+    {"hof", "(define (compose f g) (lambda (x) (f (g x))))", "((compose car cdr) (list 1 2 3))", 200000},
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double run_case(const BenchCase *bc, int n, NadaEngine engine) {
+    nada_set_engine(engine);
+    NadaEnv *env = nada_create_standard_env();
+    nada_free(nada_parse_eval_multi(bc->setup, env));
+
+    NadaValue *step = nada_parse(bc->step);
+    double start = now_seconds();
+    for (int k = 0; k < n; k++) {
+        nada_free(nada_eval(step, env));
+    }
+    double elapsed = now_seconds() - start;
+
+    nada_free(step);
+    nada_cleanup_env(env);
+    return elapsed;
+}
+
+int main(int argc, char **argv) {
+    double scale = argc > 1 ? atof(argv[1]) : 1.0;
+
+    printf("%-8s %12s %12s %12s %12s\n", "case", "tree ms", "tree us/step", "vm ms", "vm us/step");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const BenchCase *bc = &cases[i];
+        int n = (int)(bc->iterations * scale);
+        double tree = run_case(bc, n, NADA_ENGINE_TREE);
+        double vm = run_case(bc, n, NADA_ENGINE_VM);
+        printf("%-8s %12.2f %12.3f %12.2f %12.3f\n", bc->name, tree * 1e3, tree * 1e6 / n, vm * 1e3,
+               vm * 1e6 / n);
+    }
+    nada_set_engine(NADA_ENGINE_TREE);
+    return 0;
+}
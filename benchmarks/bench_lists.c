@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "NadaEval.h"
+#include "NadaParser.h"
+#include "NadaValue.h"
+#include "NadaEnv.h"
+
+// Build a list of n elements one cons at a time through the evaluator:
+// every step looks up `acc`, conses onto it and stores it back with set!.
+// With structural sharing each step is O(1), so the time per element should
+// stay flat as n grows; copying values on lookup/cons/set! made it O(n).
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void eval_string(const char *src, NadaEnv *env) {
+    NadaValue *expr = nada_parse(src);
+    NadaValue *result = nada_eval(expr, env);
+    nada_free(result);
+    nada_free(expr);
+}
+
+static double bench_build(int n) {
+    NadaEnv *env = nada_create_standard_env();
+    eval_string("(define acc '())", env);
+
+    NadaValue *step = nada_parse("(set! acc (cons 1 acc))");
+    double start = now_seconds();
+    for (int i = 0; i < n; i++) {
+        nada_free(nada_eval(step, env));
+    }
+    double elapsed = now_seconds() - start;
+
+    nada_free(step);
+    nada_cleanup_env(env);
+    return elapsed;
+}
+
+int main(int argc, char **argv) {
+    int max_n = argc > 1 ? atoi(argv[1]) : 64000;
+
+    printf("%10s %12s %14s\n", "elements", "total ms", "ns/element");
+    double prev = 0.0;
+    for (int n = 1000; n <= max_n; n *= 2) {
+        double t = bench_build(n);
+        printf("%10d %12.2f %14.1f", n, t * 1e3, t * 1e9 / n);
+        if (prev > 0.0) {
+            printf("   (x%.2f vs previous size)", t / prev);
+        }
+        printf("\n");
+        prev = t;
+    }
+    return 0;
+}
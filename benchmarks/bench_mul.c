@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "NadaBigInt.h"
+
+// Find the multiplication crossovers for NadaBigInt.h. For each operand size
+// (in limbs) one level of Karatsuba over schoolbook, and one level of Toom-3
+// over Karatsuba, are timed against the algorithm below them. The first size
+// from which the faster algorithm keeps winning is the suggested threshold.
+
+static const size_t sizes[] = {8, 12, 16, 20, 24, 28, 32, 40, 48, 64, 80, 96,
+                               128, 160, 192, 256, 320, 384, 512, 768, 1024};
+#define SIZE_COUNT (sizeof(sizes) / sizeof(sizes[0]))
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void random_big(NadaBigInt *r, size_t limbs) {
+    nada_big_set_u64(r, 0);
+    for (size_t i = 0; i < limbs; i++) {
+        nada_big_shl(r, r, NADA_LIMB_BITS);
+        nada_big_add_small(r, r, ((NadaLimb)rand() ^ ((NadaLimb)rand() << 16)) | (1u << 31));
+    }
+}
+
+// Seconds per multiplication with the given thresholds (best of five runs)
+static double time_mul(const NadaBigInt *a, const NadaBigInt *b, NadaBigInt *product,
+                       size_t karatsuba, size_t toom3) {
+    nada_big_karatsuba_threshold = karatsuba;
+    nada_big_toom3_threshold = toom3;
+
+    double best = 0.0;
+    for (int run = 0; run < 5; run++) {
+        int reps = 1;
+        double elapsed;
+        do {
+            double start = now_seconds();
+            for (int i = 0; i < reps; i++) {
+                nada_big_mul(product, a, b);
+            }
+            elapsed = now_seconds() - start;
+            reps *= 2;
+        } while (elapsed < 0.01);
+        double per_mul = elapsed / (reps / 2);
+        if (run == 0 || per_mul < best) best = per_mul;
+    }
+    return best;
+}
+
+// First size from which the second column wins for good, or 0
+static size_t crossover(const double *slow, const double *fast) {
+    size_t found = 0;
+    for (size_t i = 0; i < SIZE_COUNT; i++) {
+        if (fast[i] < slow[i]) {
+            if (!found) found = sizes[i];
+        } else {
+            found = 0;
+        }
+    }
+    return found;
+}
+
+int main(void) {
+    double basecase[SIZE_COUNT], karatsuba[SIZE_COUNT], karatsuba_tuned[SIZE_COUNT], toom3[SIZE_COUNT];
+    NadaBigInt a = NADA_BIG_INIT, b = NADA_BIG_INIT, p1 = NADA_BIG_INIT, p2 = NADA_BIG_INIT, p3 = NADA_BIG_INIT;
+    int mismatches = 0;
+
+    srand(1);
+
+    // Karatsuba first, then Toom-3 on top of the measured Karatsuba threshold
+    printf("%8s %14s %14s\n", "limbs", "schoolbook us", "karatsuba us");
+    for (size_t i = 0; i < SIZE_COUNT; i++) {
+        random_big(&a, sizes[i]);
+        random_big(&b, sizes[i]);
+        basecase[i] = time_mul(&a, &b, &p1, SIZE_MAX, SIZE_MAX);
+        karatsuba[i] = time_mul(&a, &b, &p2, sizes[i], SIZE_MAX);
+        if (nada_big_cmp(&p1, &p2) != 0) mismatches++;
+        printf("%8zu %14.2f %14.2f\n", sizes[i], basecase[i] * 1e6, karatsuba[i] * 1e6);
+    }
+    size_t karatsuba_threshold = crossover(basecase, karatsuba);
+    if (karatsuba_threshold == 0) karatsuba_threshold = NADA_BIG_KARATSUBA_THRESHOLD;
+
+    printf("\n%8s %14s %14s\n", "limbs", "karatsuba us", "toom-3 us");
+    for (size_t i = 0; i < SIZE_COUNT; i++) {
+        random_big(&a, sizes[i]);
+        random_big(&b, sizes[i]);
+        karatsuba_tuned[i] = time_mul(&a, &b, &p2, karatsuba_threshold, SIZE_MAX);
+        toom3[i] = time_mul(&a, &b, &p3, karatsuba_threshold, sizes[i]);
+        if (nada_big_cmp(&p2, &p3) != 0) mismatches++;
+        printf("%8zu %14.2f %14.2f\n", sizes[i], karatsuba_tuned[i] * 1e6, toom3[i] * 1e6);
+    }
+
+    printf("\nKaratsuba threshold: %zu limbs (default %d)\n", karatsuba_threshold, NADA_BIG_KARATSUBA_THRESHOLD);
+    printf("Toom-3 threshold:    %zu limbs (default %d)\n", crossover(karatsuba_tuned, toom3),
+           NADA_BIG_TOOM3_THRESHOLD);
+    if (mismatches) printf("ERROR: %d products differ between algorithms\n", mismatches);
+
+    nada_big_free(&a);
+    nada_big_free(&b);
+    nada_big_free(&p1);
+    nada_big_free(&p2);
+    nada_big_free(&p3);
+    return mismatches != 0;
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "NadaBigInt.h"
+
+// Time decimal conversion for NadaBigInt.h. For each size n (in limbs) a
+// random n-limb number is printed and parsed back, once nine digits at a
+// time and once with divide-and-conquer splitting at each candidate
+// threshold. The threshold with the lowest total time is suggested. Every
+// parse is checked against the original number.
+
+static const size_t sizes[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384};
+#define SIZE_COUNT (sizeof(sizes) / sizeof(sizes[0]))
+
+static const size_t thresholds[] = {8, 16, 32, 64, 128};
+#define THRESHOLD_COUNT (sizeof(thresholds) / sizeof(thresholds[0]))
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void random_big(NadaBigInt *r, size_t limbs) {
+    nada_big_set_u64(r, 0);
+    for (size_t i = 0; i < limbs; i++) {
+        nada_big_shl(r, r, NADA_LIMB_BITS);
+        nada_big_add_small(r, r, (NadaLimb)rand() ^ ((NadaLimb)rand() << 16));
+    }
+    nada_big_add_small(r, r, 1);
+}
+
+// Seconds to print a and parse it back with the given threshold (best of
+// three runs); failures counts round trips that lose the value
+static double time_round_trip(const NadaBigInt *a, size_t threshold, int *failures) {
+    nada_big_radix_threshold = threshold;
+    NadaBigInt parsed = NADA_BIG_INIT;
+
+    double best = 0.0;
+    for (int run = 0; run < 3; run++) {
+        int reps = 1;
+        double elapsed;
+        do {
+            double start = now_seconds();
+            for (int i = 0; i < reps; i++) {
+                char *digits = nada_big_to_decimal(a);
+                if (!nada_big_from_decimal(&parsed, digits, strlen(digits)) || nada_big_cmp(&parsed, a) != 0) {
+                    (*failures)++;
+                }
+                free(digits);
+            }
+            elapsed = now_seconds() - start;
+            reps *= 2;
+        } while (elapsed < 0.01);
+        double per_trip = elapsed / (reps / 2);
+        if (run == 0 || per_trip < best) best = per_trip;
+    }
+
+    nada_big_free(&parsed);
+    return best;
+}
+
+int main(void) {
+    double totals[THRESHOLD_COUNT] = {0};
+    NadaBigInt a = NADA_BIG_INIT;
+    int failures = 0;
+
+    srand(1);
+
+    printf("%8s %12s", "limbs", "chunked us");
+    for (size_t t = 0; t < THRESHOLD_COUNT; t++) {
+        printf("  split@%-4zu us", thresholds[t]);
+    }
+    printf("\n");
+
+    for (size_t i = 0; i < SIZE_COUNT; i++) {
+        random_big(&a, sizes[i]);
+        printf("%8zu %12.1f", sizes[i], time_round_trip(&a, SIZE_MAX, &failures) * 1e6);
+        for (size_t t = 0; t < THRESHOLD_COUNT; t++) {
+            double seconds = time_round_trip(&a, thresholds[t], &failures);
+            totals[t] += seconds;
+            printf(" %15.1f", seconds * 1e6);
+        }
+        printf("\n");
+    }
+
+    size_t best = 0;
+    for (size_t t = 1; t < THRESHOLD_COUNT; t++) {
+        if (totals[t] < totals[best]) best = t;
+    }
+    printf("\nRadix threshold: %zu limbs (default %d)\n", thresholds[best], NADA_BIG_RADIX_THRESHOLD);
+    if (failures) printf("ERROR: %d conversions gave a wrong result\n", failures);
+
+    nada_big_free(&a);
+    return failures != 0;
+}
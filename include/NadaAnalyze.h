@@ -0,0 +1,127 @@
+#ifndef NADA_ANALYZE_H
+#define NADA_ANALYZE_H
+
+#include "NadaValue.h"
+#include "NadaEnv.h"
+
+// Analysis of lambda bodies (SICP-style analyze/execute).
+//
+// A lambda body is converted once into a tree of nodes: constants, variable
+// references, if, cond, let, define, set!, lambda, begin, and/or and calls,
+// each with a function that executes it. Special forms are recognized and
+// parameter lists are parsed during analysis, so calling the function only
+// runs the tree. The result is stored as a NadaCode on the function value
+// and shared by every copy of the closure. With the VM engine (NadaVM.h)
+// the body is compiled to bytecode instead.
+//
+// Calls keep the evaluator's conventions: a builtin receives its unevaluated
+// argument expressions and the environment. The arguments of closures, and
+// of builtins that evaluate all their arguments like a function, are
+// evaluated by their nodes instead. Malformed special forms are left to the
+// builtin special form, which reports the error when executed.
+//
+// Closures called in tail position (the last expression of a body, of an if
+// or cond branch, of a let body, or the last operand of and/or) do not run
+// below their caller: the call is left to the nada_run_code that runs the
+// caller, which makes it once the caller's frame is released. Tail recursive
+// loops run in constant stack and keep only the current frame alive.
+
+typedef struct NadaCode NadaCode;
+typedef struct NadaBytecode NadaBytecode;
+
+// Analyze (lambda params body...), NULL params means no parameters. The body
+// is analyzed or compiled when it first runs. scope is the layout of the
+// frame the closures are created in, NULL if it is not known; variables of
+// known frames are then addressed by their slots.
+NadaCode *nada_analyze_lambda(NadaValue *params, NadaValue *body, NadaFrameLayout *scope);
+
+// Reference counting for code shared between closures
+NadaCode *nada_code_retain(NadaCode *code);
+void nada_code_release(NadaCode *code);
+
+// Closure over env for (lambda params body...). params and body are retained,
+// code is analyzed when NULL and retained otherwise.
+NadaValue *nada_make_closure(NadaValue *params, NadaValue *body, NadaCode *code, NadaEnv *env);
+
+// Drop the code cached for closures made outside analyzed code, together
+// with the bodies it was analyzed from
+void nada_clear_lambda_cache(void);
+
+// Call a closure with evaluated arguments; argv stays owned by the caller
+NadaValue *nada_apply_closure(NadaValue *func, NadaValue **argv, int argc);
+
+// The parts of nada_apply_closure: the closure's code, analyzed on first use,
+// and running code with its parameters bound in a new frame below env. The
+// references to the arguments move into the frame, so nada_run_code takes
+// them over (argv itself stays owned by the caller).
+NadaCode *nada_closure_code(NadaValue *func);
+NadaValue *nada_run_code(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc);
+
+// Closure calls in progress are limited to a maximum depth, and to what fits
+// on the C stack for calls that recurse in C. A call past the limit returns
+// a NADA_ERROR value, and so does every call still in progress, once it
+// returns, up to the innermost error? or the top level.
+#define NADA_DEFAULT_MAX_DEPTH 1000000
+void nada_set_max_depth(int depth);
+int nada_get_max_depth(void);
+
+// error? catches the depth error: calls made between nada_catch_begin and
+// nada_catch_end stop unwinding there, and nada_catch_end tells whether one
+// of them went too deep. outer is what nada_catch_begin returned.
+int nada_catch_begin(void);
+bool nada_catch_end(int outer);
+
+// Steps of nada_run_code for the bytecode VM, which runs calls between
+// compiled bodies without recursing in C. nada_code_bytecode compiles the
+// code on first use. nada_start_call counts the call and returns a new frame
+// below env with the parameters bound to the arguments, taken over like in
+// nada_run_code, or NULL with the value of the call in *result if it could
+// not start. nada_end_call ends it with the value of the body, after releasing
+// the let frames deferred since nada_deferred_let_count was lets (see below).
+NadaBytecode *nada_code_bytecode(NadaCode *code);
+NadaEnv *nada_start_call(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc, NadaValue **result);
+NadaValue *nada_end_call(int lets, NadaValue *result);
+
+// Tail calls, shared with the bytecode VM. nada_tail_call leaves a call of
+// code in a new frame below env with the argc arguments of argv; it takes
+// over the references to code, env and the arguments (argv itself stays
+// owned by the caller) and returns a marker that the body returns as its
+// value. nada_leave_let releases the frame of a let like
+// nada_release_let_env, for a body value that may be that marker.
+NadaValue *nada_tail_call(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc);
+NadaValue *nada_leave_let(NadaEnv *let_env, NadaValue *result, bool named);
+
+// Making a pending tail call in place of the body that returned the marker:
+// nada_take_tail_call hands over its code and returns its bound frame, NULL
+// if it did not start. Let frames the call may still use are kept until the
+// call that was running when it was left ends; nada_deferred_let_count is
+// their number.
+bool nada_is_tail_call(NadaValue *value);
+NadaEnv *nada_take_tail_call(NadaCode **code);
+int nada_deferred_let_count(void);
+
+// Builtins that evaluate each argument once, in order, like a function
+int nada_builtin_is_strict(NadaValue *(*builtin)(NadaValue *, NadaEnv *));
+
+// Call a builtin with evaluated arguments; argv stays owned by the caller
+NadaValue *nada_call_builtin_values(NadaValue *(*builtin)(NadaValue *, NadaEnv *),
+                                    NadaValue **argv, int argc, NadaEnv *env);
+
+// Syntax checks shared with the bytecode compiler:
+// length of a proper list, -1 for anything else
+int nada_list_length(NadaValue *list);
+// parameter lists accepted by builtin_lambda: a symbol, or a list of symbols
+// that may end in a dotted rest parameter
+int nada_valid_lambda_params(NadaValue *params);
+// binding list of a let: count (name expr) pairs, -1 if malformed
+int nada_let_bindings(NadaValue *bindings);
+
+// Frame layouts shared with the bytecode compiler:
+// add the names of the defines at the top level of body
+void nada_layout_add_defines(NadaFrameLayout *layout, NadaValue *body);
+// frame of a let: its count variables in order, the loop function of a named
+// let, then the defines of the body; NULL if a variable is repeated
+NadaFrameLayout *nada_let_layout(NadaValue *bindings, int count, const char *loop_name, NadaValue *body,
+                                 NadaFrameLayout *scope);
+
+#endif  // NADA_ANALYZE_H
@@ -0,0 +1,115 @@
+#ifndef NADA_BIGINT_H
+#define NADA_BIGINT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Arbitrary precision natural numbers, the magnitude type behind NadaNum.
+// Values are stored as little-endian binary limbs with an explicit length;
+// the most significant limb is never zero, so zero has len == 0.
+//
+// All functions write their result into the first argument, which may be
+// the same object as any of the inputs.
+
+typedef uint32_t NadaLimb;
+typedef uint64_t NadaDLimb;  // Holds the product of two limbs
+
+#define NADA_LIMB_BITS 32
+
+typedef struct {
+    NadaLimb *limbs;
+    size_t len;  // Limbs in use
+    size_t cap;  // Limbs allocated
+} NadaBigInt;
+
+#define NADA_BIG_INIT {NULL, 0, 0}
+
+// Operand sizes in limbs from which multiplication switches from schoolbook
+// to Karatsuba and from Karatsuba to Toom-3. The defaults were measured with
+// benchmarks/bench_mul, which changes the variables to find the crossovers.
+#define NADA_BIG_KARATSUBA_THRESHOLD 64
+#define NADA_BIG_TOOM3_THRESHOLD 192
+extern size_t nada_big_karatsuba_threshold;
+extern size_t nada_big_toom3_threshold;
+
+// Divisor and quotient size in limbs from which division multiplies by a
+// Newton reciprocal instead of using schoolbook long division (see
+// benchmarks/bench_div)
+#define NADA_BIG_NEWTON_THRESHOLD 512
+extern size_t nada_big_newton_threshold;
+
+// Size in limbs from which decimal conversion splits numbers at cached
+// powers of ten instead of converting nine digits at a time (see
+// benchmarks/bench_radix)
+#define NADA_BIG_RADIX_THRESHOLD 16
+extern size_t nada_big_radix_threshold;
+
+// Lifecycle
+void nada_big_init(NadaBigInt *a);
+void nada_big_free(NadaBigInt *a);
+void nada_big_set(NadaBigInt *r, const NadaBigInt *a);
+void nada_big_set_u64(NadaBigInt *r, uint64_t value);
+void nada_big_swap(NadaBigInt *a, NadaBigInt *b);
+
+// Queries
+static inline bool nada_big_is_zero(const NadaBigInt *a) {
+    return a->len == 0;
+}
+static inline bool nada_big_is_one(const NadaBigInt *a) {
+    return a->len == 1 && a->limbs[0] == 1;
+}
+bool nada_big_to_u64(const NadaBigInt *a, uint64_t *out);
+size_t nada_big_bit_length(const NadaBigInt *a);
+int nada_big_cmp(const NadaBigInt *a, const NadaBigInt *b);
+
+// Arithmetic
+void nada_big_add(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b);
+void nada_big_sub(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b);  // Requires a >= b
+void nada_big_mul(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b);
+void nada_big_add_small(NadaBigInt *r, const NadaBigInt *a, NadaLimb b);
+void nada_big_mul_small(NadaBigInt *r, const NadaBigInt *a, NadaLimb b);
+void nada_big_shl(NadaBigInt *r, const NadaBigInt *a, size_t bits);
+void nada_big_shr(NadaBigInt *r, const NadaBigInt *a, size_t bits);
+
+// Division by a non-zero divisor; q or rem may be NULL when not needed
+void nada_big_divmod(NadaBigInt *q, NadaBigInt *rem, const NadaBigInt *a, const NadaBigInt *b);
+// Divide by a single non-zero limb and return the remainder
+NadaLimb nada_big_divmod_small(NadaBigInt *q, const NadaBigInt *a, NadaLimb d);
+
+void nada_big_gcd(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b);
+
+// Binary GCD of machine words: strip common factors of two, then subtract
+static inline uint64_t nada_big_gcd_u64(uint64_t a, uint64_t b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            uint64_t t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+// r = a^e
+void nada_big_pow(NadaBigInt *r, const NadaBigInt *a, uint64_t e);
+// r = base^exp mod mod for a non-zero modulus
+void nada_big_powmod(NadaBigInt *r, const NadaBigInt *base, const NadaBigInt *exp, const NadaBigInt *mod);
+// r = floor(a^(1/k)) for k >= 1
+void nada_big_root(NadaBigInt *r, const NadaBigInt *a, uint64_t k);
+
+// Conversion
+// Parse len decimal digits; returns false if a non-digit is found
+bool nada_big_from_decimal(NadaBigInt *r, const char *digits, size_t len);
+// Decimal digits without sign (caller must free)
+char *nada_big_to_decimal(const NadaBigInt *a);
+// Return m and set *exp so that a is approximately m * 2^exp
+double nada_big_to_double_exp(const NadaBigInt *a, long *exp);
+
+#endif  // NADA_BIGINT_H
@@ -17,6 +17,11 @@ NadaValue *builtin_modulo(NadaValue *args, NadaEnv *env);
 NadaValue *builtin_remainder(NadaValue *args, NadaEnv *env);
 // Exponentiation (expt)
 NadaValue *builtin_expt(NadaValue *args, NadaEnv *env);
+// Modular exponentiation (expt-mod)
+NadaValue *builtin_expt_mod(NadaValue *args, NadaEnv *env);
+// Integer roots (exact-integer-sqrt, exact-integer-root)
+NadaValue *builtin_exact_integer_sqrt(NadaValue *args, NadaEnv *env);
+NadaValue *builtin_exact_integer_root(NadaValue *args, NadaEnv *env);
 
 // Number component access functions
 // Return the numerator of a rational number
@@ -25,7 +30,15 @@ NadaValue *builtin_numerator(NadaValue *args, NadaEnv *env);
 NadaValue *builtin_denominator(NadaValue *args, NadaEnv *env);
 // Return the sign of a number (1 for positive, -1 for negative)
 NadaValue *builtin_sign(NadaValue *args, NadaEnv *env);
-// Return a list of prime factors of the numerator (if the number is an integer)
+// Return a list of prime factors of the numerator (if the number is an integer).
+// The search gives up on composite parts without a factor of up to about 25
+// digits (around 25 s for 60 digits) and lists such a part unfactored.
 NadaValue *builtin_factor(NadaValue *args, NadaEnv *env);
 
+// Exactness conversions
+// Convert a number to the nearest flonum (exact->inexact, inexact)
+NadaValue *builtin_exact_to_inexact(NadaValue *args, NadaEnv *env);
+// Convert a flonum to the rational with the same value (inexact->exact, exact)
+NadaValue *builtin_inexact_to_exact(NadaValue *args, NadaEnv *env);
+
 #endif  // __NADA_BUILTIN_MATH_H__
\ No newline at end of file
@@ -10,6 +10,10 @@ NadaValue *builtin_null(NadaValue *args, NadaEnv *env);
 NadaValue *builtin_integer_p(NadaValue *args, NadaEnv *env);
 // Number predicate (number?)
 NadaValue *builtin_number_p(NadaValue *args, NadaEnv *env);
+// Exact number predicate (exact?)
+NadaValue *builtin_exact_p(NadaValue *args, NadaEnv *env);
+// Inexact number predicate (inexact?)
+NadaValue *builtin_inexact_p(NadaValue *args, NadaEnv *env);
 // String predicate (string?)
 NadaValue *builtin_string_p(NadaValue *args, NadaEnv *env);
 // Symbol predicate (symbol?)
@@ -1,8 +1,11 @@
 #ifndef NADABUILTINSPECIALFORMS_H
 #define NADABUILTINSPECIALFORMS_H
 
+#include <stdbool.h>
+
 #include "NadaValue.h"
 #include "NadaEnv.h"
+#include "NadaAnalyze.h"
 
 // Built-in function: quote
 NadaValue *builtin_quote(NadaValue *args, NadaEnv *env);
@@ -26,6 +29,13 @@ NadaValue *builtin_set(NadaValue *args, NadaEnv *env);
 // Add this declaration
 NadaValue *builtin_apply(NadaValue *args, NadaEnv *env);
 
+// Bind name in env to a new closure over env, as (define (name . params) body...)
+// does; code may be NULL to analyze the body
+void nada_define_closure(NadaEnv *env, const char *name, NadaValue *params, NadaValue *body, NadaCode *code);
+// Release the environment of a let or named let after its body produced
+// result, breaking cycles through closures bound in it; returns the result
+NadaValue *nada_release_let_env(NadaEnv *let_env, NadaValue *result, bool named);
+
 // Built-in function: for-each
 NadaValue *builtin_for_each(NadaValue *args, NadaEnv *env);
 
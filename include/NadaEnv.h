@@ -1,29 +1,75 @@
 #ifndef NADA_ENV_H
 #define NADA_ENV_H
 
+#include <stdbool.h>
+
 #include "NadaValue.h"
 #include "NadaEnv.h"
 
 // Define the binding structure
 struct NadaBinding {
-    char *name;
+    const char *name;  // Interned symbol name (see NadaSymbol.h)
     NadaValue *value;
     struct NadaBinding *next;
 };
 
-// Environment structure definition
+// Layout of an array-backed frame: the interned names of its slots and the
+// layout of the frame it is nested in, NULL where that is not known. The
+// frames of one lambda or let share its layout.
+typedef struct NadaFrameLayout {
+    int ref_count;
+    int count;
+    const char **names;
+    struct NadaFrameLayout *parent;
+} NadaFrameLayout;
+
+// Frames with up to this many slots keep them inside the environment
+#define NADA_INLINE_SLOTS 8
+
+// Environment structure definition. Names known when the code is analyzed
+// (parameters, let variables, internal defines) live in slots, names bound
+// at run time by define or eval in the bindings list.
 struct NadaEnv {
     struct NadaBinding *bindings;
     struct NadaEnv *parent;
+    NadaFrameLayout *layout;  // NULL for an environment without slots
+    NadaValue **slots;        // layout->count values, NULL while unbound
+    NadaValue *inline_slots[NADA_INLINE_SLOTS];
     int ref_count;
     int id;  // Unique ID for debugging
+#ifdef NADA_ENABLE_GC
+    struct NadaEnv *gc_prev, *gc_next;  // List of live environments (see NadaGC.h)
+#endif
 };
 
 // Environment type
 typedef struct NadaEnv NadaEnv;
 
+// A variable reference resolved against the layouts known at analysis time:
+// the variable is slot index of the frame depth levels up, or, for index -1,
+// not in any of the depth known frames. layout is the innermost one.
+typedef struct {
+    const char *sym;
+    NadaFrameLayout *layout;
+    int depth;
+    int index;
+} NadaVarRef;
+
+// Frame layouts. nada_layout_add appends a slot (or finds the existing one)
+// and returns its index.
+NadaFrameLayout *nada_layout_create(NadaFrameLayout *parent);
+int nada_layout_add(NadaFrameLayout *layout, const char *sym);
+NadaFrameLayout *nada_layout_retain(NadaFrameLayout *layout);
+void nada_layout_release(NadaFrameLayout *layout);
+
+// Resolve sym in the frames described by layout and its parents
+void nada_resolve_var(NadaVarRef *ref, NadaFrameLayout *layout, const char *sym);
+
 // Environment lifecycle management functions
 NadaEnv *nada_env_create(NadaEnv *parent);
+// Environment with the slots of layout, all unbound; callers fill them with
+// references of their own
+NadaEnv *nada_env_create_frame(NadaEnv *parent, NadaFrameLayout *layout);
 void nada_env_free(NadaEnv *env);
 
 // Environment reference management functions
@@ -31,6 +77,11 @@ void nada_env_add_ref(NadaEnv *env);
 void nada_env_release(NadaEnv *env);
 void nada_cleanup_env(NadaEnv *global_env);
 void nada_env_remove(NadaEnv *env, const char *name);
+// Drop all bindings and the parent reference, leaving an empty environment
+void nada_env_clear(NadaEnv *env);
+// Point closures held by env that capture env itself at target, adding a
+// reference to target for each; true if there were any
+bool nada_env_redirect_closures(NadaEnv *env, NadaEnv *target);
 
 // Environment functions
 void nada_env_set(NadaEnv *env, const char *name, NadaValue *value);
@@ -38,4 +89,21 @@ NadaValue *nada_env_get(NadaEnv *env, const char *name, int silent);
 // Look up a symbol in the environment without printing error messages
 NadaValue *nada_env_lookup_symbol(NadaEnv *env, const char *name);
 
+// Same as nada_env_set / nada_env_get, for names that are already interned
+// (such as a NADA_SYMBOL's data.symbol); bindings are matched by pointer.
+void nada_env_set_symbol(NadaEnv *env, const char *sym, NadaValue *value);
+NadaValue *nada_env_get_symbol(NadaEnv *env, const char *sym, int silent);
+// New reference to the value bound to an interned name, NULL if unbound
+NadaValue *nada_env_find_symbol(NadaEnv *env, const char *sym);
+// The bound value itself, NULL if unbound; valid until the binding changes
+NadaValue *nada_env_peek_symbol(NadaEnv *env, const char *sym);
+// Rebind the innermost existing binding of sym (set!); false if there is none
+bool nada_env_assign_symbol(NadaEnv *env, const char *sym, NadaValue *value);
+
+// Same as nada_env_peek_symbol / nada_env_assign_symbol for a resolved
+// reference. The slot is used directly when the frames match the layouts it
+// was resolved against; otherwise the name is looked up.
+NadaValue *nada_env_peek_var(NadaEnv *env, const NadaVarRef *ref);
+bool nada_env_assign_var(NadaEnv *env, const NadaVarRef *ref, NadaValue *value);
+
 #endif  // NADA_ENV_H
@@ -14,6 +14,7 @@ typedef enum {
     NADA_ERROR_MEMORY,            // Memory allocation error
     NADA_ERROR_DIVISION_BY_ZERO,  // Division by zero
     NADA_ERROR_OUT_OF_MEMORY,     // Out of memory
+    NADA_ERROR_RECURSION_DEPTH,   // Too many nested calls
     // Add more error types as needed
 } NadaErrorType;
 
@@ -23,6 +23,24 @@ typedef struct {
     BuiltinFunc func;
 } BuiltinFuncInfo;
 
+// Special forms, as recorded in NadaSymbolDispatch.special_form
+typedef enum {
+    NADA_FORM_NONE,
+    NADA_FORM_QUOTE,
+    NADA_FORM_DEFINE,
+    NADA_FORM_LAMBDA,
+    NADA_FORM_COND,
+    NADA_FORM_LET,
+    NADA_FORM_IF,
+    NADA_FORM_BEGIN,
+    NADA_FORM_AND,
+    NADA_FORM_OR,
+    NADA_FORM_SET
+} NadaSpecialForm;
+
+// Record the special forms and builtins with their symbols (idempotent)
+void nada_init_dispatch(void);
+
 // Hack to check for validity of a symbol without printing an error
 void nada_set_silent_symbol_lookup(int silent);
 bool nada_is_global_silent_symbol_lookup();
@@ -36,6 +54,10 @@ NadaValue *nada_eval(NadaValue *expr, NadaEnv *env);
 // Function to create a built-in function
 NadaValue *nada_create_builtin_function(NadaValue *(*func)(NadaValue *, NadaEnv *));
 
+// Report that op (an operator expression evaluating to op_value) is not a
+// function; frees op_value and returns nil
+NadaValue *nada_not_a_function(NadaValue *op, NadaValue *op_value);
+
 // Apply a function to arguments
 NadaValue *apply_function(NadaValue *func, NadaValue *args, NadaEnv *env);
 NadaValue *builtin_eval(NadaValue *args, NadaEnv *env);
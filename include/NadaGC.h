@@ -0,0 +1,35 @@
+#ifndef NADA_GC_H
+#define NADA_GC_H
+
+#include <stddef.h>
+
+#include "NadaEnv.h"
+
+// Tracing collector for environment cycles (build option NADA_ENABLE_GC).
+//
+// Reference counting still frees acyclic data as soon as it is dropped, but
+// with the collector enabled environments and closures hold plain, exact
+// counts: closures stored in the environment they capture simply form a
+// cycle. The collector finds such cycles with mark-and-sweep over all live
+// environments and the pairs and closures reachable from their bindings.
+// Roots are the objects whose reference count is higher than the number of
+// references found inside that graph: the global environment's owner, and
+// every value or environment held by C code on the eval stack.
+//
+// Without NADA_ENABLE_GC these functions are no-ops and the circular
+// reference handling in NadaEnv.c and the let/define special forms is used.
+
+// Run a full collection, returns the number of environments reclaimed
+size_t nada_gc_collect(void);
+
+// Collect if enough environments were created since the last collection
+void nada_gc_maybe_collect(void);
+
+// Environment registry, maintained by NadaEnv.c
+void nada_gc_register_env(NadaEnv *env);
+void nada_gc_unregister_env(NadaEnv *env);
+
+// Number of environments currently alive
+size_t nada_gc_live_envs(void);
+
+#endif  // NADA_GC_H
@@ -4,13 +4,22 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
-// Forward declaration of the rational number type
+// Forward declaration of the number type: an exact rational or an inexact
+// IEEE double (flonum)
 typedef struct NadaNum NadaNum;
 
+// Big rationals whose operands total fewer limbs than this are left
+// unreduced by arithmetic and reduced when compared, printed or taken
+// apart; 0 reduces every result. Builds with NADA_LAZY_RATIONALS default
+// to NADA_NUM_LAZY_LIMBS, others to 0.
+#define NADA_NUM_LAZY_LIMBS 64
+extern size_t nada_num_lazy_limbs;
+
 // Creation functions
 NadaNum *nada_num_from_string(const char *str);
 NadaNum *nada_num_from_int(int value);
 NadaNum *nada_num_from_fraction(const char *numerator, const char *denominator);
+NadaNum *nada_num_from_double(double value);
 
 // Memory management
 NadaNum *nada_num_copy(const NadaNum *num);
@@ -20,11 +29,19 @@ void nada_num_free(NadaNum *num);
 NadaNum *nada_num_add(const NadaNum *a, const NadaNum *b);
 NadaNum *nada_num_subtract(const NadaNum *a, const NadaNum *b);
 NadaNum *nada_num_multiply(const NadaNum *a, const NadaNum *b);
+// Sum and product of count numbers, reduced once at the end rather than
+// after each operand; 0 and 1 for count == 0
+NadaNum *nada_num_sum(NadaNum *const *terms, size_t count);
+NadaNum *nada_num_product(NadaNum *const *factors, size_t count);
 NadaNum *nada_num_divide(const NadaNum *a, const NadaNum *b);
 NadaNum *nada_num_modulo(const NadaNum *a, const NadaNum *b);
 NadaNum *nada_num_remainder(const NadaNum *a, const NadaNum *b);
 NadaNum *nada_num_negate(const NadaNum *a);
 NadaNum *nada_num_int_expt(const NadaNum *base, int exponent);
+NadaNum *nada_num_expt_mod(const NadaNum *base, const NadaNum *exponent, const NadaNum *modulus);
+// Largest integer r with r^k <= n, for an exact integer n >= 0 and k >= 1;
+// NULL for other arguments
+NadaNum *nada_num_exact_integer_root(const NadaNum *n, int k);
 
 // Comparison operations
 bool nada_num_equal(const NadaNum *a, const NadaNum *b);
@@ -38,12 +55,16 @@ bool nada_num_is_integer(const NadaNum *num);
 bool nada_num_is_zero(const NadaNum *num);
 bool nada_num_is_positive(const NadaNum *num);
 bool nada_num_is_negative(const NadaNum *num);
+bool nada_num_fits_int(const NadaNum *num, int *out);
+bool nada_num_is_exact(const NadaNum *num);
 
 // Conversion functions
 char *nada_num_to_string(const NadaNum *num);
 char *nada_num_to_float_string(const NadaNum *num, int precision);
 int nada_num_to_int(const NadaNum *num);
-double nada_num_to_double(const NadaNum *num);
+double nada_num_to_double(const NadaNum *num);  // Correctly rounded
+NadaNum *nada_num_to_exact(const NadaNum *num);   // NULL for infinities and NaN
+NadaNum *nada_num_to_inexact(const NadaNum *num);
 
 // Parsing functions
 bool nada_is_valid_number_string(const char *str);
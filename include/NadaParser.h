@@ -8,11 +8,13 @@
 typedef struct {
     const char *input;
     size_t position;
-    char token[1024];
+    char *token;            // Current token, grown to fit long literals
+    size_t token_capacity;  // Bytes allocated for token
 } Tokenizer;
 
 // Tokenizer functions
 void tokenizer_init(Tokenizer *t, const char *input);
+void tokenizer_free(Tokenizer *t);
 int get_next_token(Tokenizer *t);
 int nada_validate_parentheses(const char *input, int *error_pos);
 
@@ -0,0 +1,39 @@
+#ifndef NADA_POOL_H
+#define NADA_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Fixed-size object pools for the interpreter's hot allocations.
+// Each class has its own free list, refilled from slabs of many objects, so
+// creating and freeing values, environments and bindings avoids malloc/free.
+// Build with -DNADA_USE_POOL=OFF to fall back to plain malloc/free.
+//
+// With NADA_USE_NURSERY, values are bump allocated in a young generation
+// instead (see NadaPool.c); nada_pool_alloc_old() bypasses it.
+
+typedef enum {
+    NADA_POOL_VALUE,    // struct NadaValue
+    NADA_POOL_ENV,      // struct NadaEnv
+    NADA_POOL_BINDING,  // struct NadaBinding
+    NADA_POOL_CLASS_COUNT
+} NadaPoolClass;
+
+// Allocate / release one object of the given class
+void *nada_pool_alloc(NadaPoolClass cls);
+void nada_pool_free(NadaPoolClass cls, void *ptr);
+
+// Allocate outside the nursery, for objects known to be long-lived
+void *nada_pool_alloc_old(NadaPoolClass cls);
+
+// True if ptr (an object from nada_pool_alloc) was allocated in the nursery
+bool nada_pool_is_young(const void *ptr);
+
+// Statistics: objects currently handed out, and slabs reserved (0 without pooling)
+size_t nada_pool_in_use(NadaPoolClass cls);
+size_t nada_pool_slabs(NadaPoolClass cls);
+
+// Return all slabs to the system. Only valid when nothing is in use.
+void nada_pool_trim(void);
+
+#endif  // NADA_POOL_H
@@ -0,0 +1,23 @@
+#ifndef NADA_PRIME_H
+#define NADA_PRIME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "NadaBigInt.h"
+
+// Primality and integer factorization on NadaBigInt magnitudes: trial
+// division by a cached sieve of small primes, Miller-Rabin, and Pollard-Brent
+// rho followed by the elliptic curve method for the remaining composites.
+
+// Miller-Rabin with fixed prime bases; exact for n < 3.3 * 10^24, a
+// probable-prime test above that
+bool nada_prime_is_probable(const NadaBigInt *n);
+
+// Prime factors of n in ascending order with multiplicity; NULL with
+// *count == 0 for n <= 1. The factor search is capped: a composite part
+// whose factors all have more than about 25 digits is returned unsplit.
+// The caller frees each factor and the array.
+NadaBigInt *nada_prime_factor(const NadaBigInt *n, size_t *count);
+
+#endif  // NADA_PRIME_H
@@ -0,0 +1,35 @@
+#ifndef NADA_SYMBOL_H
+#define NADA_SYMBOL_H
+
+#include <stdbool.h>
+
+#include "NadaValue.h"
+
+// Global symbol intern table.
+// Every symbol name is stored exactly once, so two symbols are the same
+// symbol if and only if their name pointers are equal. NADA_SYMBOL values
+// and environment bindings hold these canonical pointers.
+
+// Return the canonical copy of name, adding it to the table on first use
+const char *nada_intern(const char *name);
+
+// Return the shared (never freed) NADA_SYMBOL value for name
+NadaValue *nada_symbol_value(const char *name);
+
+// Number of distinct symbols interned so far
+size_t nada_symbol_count(void);
+
+// Evaluator data stored with each symbol, so nada_eval can dispatch on an
+// operator without searching the special form and builtin tables, and
+// globals are found without searching the global environment
+typedef struct {
+    int special_form;                                       // Special form id, 0 for none
+    NadaValue *(*builtin)(NadaValue *, struct NadaEnv *);  // Builtin of that name, or NULL
+    bool rebound;  // Some environment has bound the name to another value
+    struct NadaBinding *global;  // Value cell in the global environment (see NadaEnv.c), or NULL
+} NadaSymbolDispatch;
+
+// Dispatch data of an interned name (as returned by nada_intern)
+NadaSymbolDispatch *nada_symbol_dispatch(const char *sym);
+
+#endif  // NADA_SYMBOL_H
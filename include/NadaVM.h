@@ -0,0 +1,40 @@
+#ifndef NADA_VM_H
+#define NADA_VM_H
+
+#include "NadaValue.h"
+#include "NadaEnv.h"
+
+// Bytecode compiler and stack VM.
+//
+// Function bodies can run on one of two engines: the tree of analyzed nodes
+// (NadaAnalyze.h) or bytecode executed by a stack machine. The compiler
+// covers the special forms of nada_eval (quote, define, lambda, cond, let,
+// if, begin, and, or, set!) and calls; builtins keep their calling
+// convention. Top-level forms are evaluated by nada_eval with either engine,
+// the engine decides how the closures they call are run.
+//
+// The VM runs a closure called from compiled code in the same loop as the
+// caller, keeping the caller's place on a control stack on the heap, so
+// recursion between compiled functions does not use the C stack and is
+// limited by memory and the maximum call depth (nada_set_max_depth) only.
+// Calls through builtins such as map or apply still recurse in C.
+
+typedef enum {
+    NADA_ENGINE_TREE,  // Analyzed node tree (default)
+    NADA_ENGINE_VM     // Bytecode
+} NadaEngine;
+
+void nada_set_engine(NadaEngine engine);
+NadaEngine nada_get_engine(void);
+
+typedef struct NadaBytecode NadaBytecode;
+
+// Compile a body (list of expressions evaluated for the value of the last)
+// that runs in frames laid out as layout
+NadaBytecode *nada_compile(NadaValue *body, NadaFrameLayout *layout);
+void nada_bytecode_free(NadaBytecode *bc);
+
+// Run compiled code in env, returning the value of the body
+NadaValue *nada_vm_run(NadaBytecode *bc, NadaEnv *env);
+
+#endif  // NADA_VM_H
@@ -30,15 +30,28 @@ typedef struct {
 
 // Function structure
 typedef struct {
-    NadaValue *params;    // Parameter list
-    NadaValue *body;      // Function body
-    struct NadaEnv *env;  // Captured environment (closure)
+    NadaValue *params;       // Parameter list
+    NadaValue *body;         // Function body
+    struct NadaEnv *env;     // Captured environment (closure)
+    struct NadaCode *code;   // Analyzed body, shared by copies (see NadaAnalyze.h)
     NadaValue *(*builtin)(NadaValue *, struct NadaEnv *);
 } NadaFunc;
 
+// Reference count of immediate values (nil, #t, #f, small integers).
+// These are static singletons: retain and free leave them untouched.
+#define NADA_REF_IMMORTAL (-1)
+
+// Range of integers that are served from the preallocated singletons
+#define NADA_SMALL_INT_MIN (-128)
+#define NADA_SMALL_INT_MAX 1023
+
 // Main value structure (tagged union)
+// Values are reference counted and immutable once built, so lists, strings
+// and numbers are shared between holders instead of being copied.
 struct NadaValue {
     NadaValueType type;
+    int ref_count;  // Number of owners, the value is released when it drops to 0
+                    // (NADA_REF_IMMORTAL for shared singletons that are never freed)
     union {
         NadaNum *number;    // For NADA_NUM
         char *string;       // For NADA_STRING
@@ -73,8 +86,21 @@ NadaValue *nada_create_error(const char *message);
 int nada_is_error(const NadaValue *value);
 
 // Memory management
+// nada_free() drops one reference and releases the value when none are left
 void nada_free(NadaValue *val);
 
+// Take a new reference to a value (O(1), substructure is shared).
+// Without NADA_ENABLE_GC, user-defined functions are duplicated shallowly
+// (params/body shared) so that every holder owns its own reference to the
+// closure environment.
+// Always use the returned pointer.
+NadaValue *nada_retain(NadaValue *val);
+
+// Take a reference to a value for a long-lived place (e.g. a global binding).
+// Nursery-allocated parts of the value are copied into the old generation so
+// they don't pin nursery blocks; otherwise the same as nada_retain().
+NadaValue *nada_promote(NadaValue *val);
+
 // Deep copy a value
 NadaValue *nada_deep_copy(NadaValue *val);
 
@@ -0,0 +1,1463 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/resource.h>
+
+#include "NadaAnalyze.h"
+#include "NadaVM.h"
+#include "NadaEval.h"
+#include "NadaError.h"
+#include "NadaSymbol.h"
+#include "NadaBuiltinSpecialForms.h"
+#include "NadaBuiltinBoolOps.h"
+#include "NadaBuiltinMath.h"
+#include "NadaBuiltinCompare.h"
+#include "NadaBuiltinPredicates.h"
+#include "NadaBuiltinLists.h"
+#include "NadaBuiltinIO.h"
+#include "NadaString.h"
+
+typedef struct NadaNode NadaNode;
+typedef NadaValue *(*ExecFunc)(NadaNode *node, NadaEnv *env);
+
+typedef enum {
+    NODE_CONST,
+    NODE_REF,
+    NODE_IF,
+    NODE_COND,
+    NODE_DEFINE,
+    NODE_DEFINE_FUNC,
+    NODE_SET,
+    NODE_LAMBDA,
+    NODE_SEQ,
+    NODE_AND,
+    NODE_OR,
+    NODE_LET,
+    NODE_NAMED_LET,
+    NODE_CALL,
+    NODE_FORM
+} NodeKind;
+
+// An analyzed expression. Which fields are used depends on the kind:
+//   CONST        value
+//   REF          ref
+//   IF           kids[0] test, kids[1] consequent, kids[2] alternative or NULL
+//   COND         count clauses, kids[2i] test (NULL for else) and
+//                kids[2i + 1] body (NULL when empty)
+//   DEFINE       sym, kids[0] value
+//   SET          ref, kids[0] value
+//   DEFINE_FUNC  sym, params, body, code
+//   LAMBDA       params, body, code
+//   SEQ, AND, OR count expressions in kids
+//   LET          count bindings of the first slots of layout to kids[i],
+//                kids[count] body
+//   NAMED_LET    sym, params, body, code of the loop function, count
+//                bindings like LET, kids[count] the first pass of the body,
+//                which runs in the let's frame
+//   CALL         kids[0] operator, op its expression, args the count
+//                argument expressions (arg_nodes once they are evaluated
+//                here, in scope), strict if op names a strict builtin
+//   FORM         form applied to args: a special form the analyzer left alone
+struct NadaNode {
+    ExecFunc exec;
+    NodeKind kind;
+    int count;
+    const char *sym;
+    NadaVarRef ref;
+    NadaFrameLayout *layout;  // Owned by LET and NAMED_LET
+    NadaFrameLayout *scope;   // Frames the arguments of a CALL are analyzed in
+    NadaValue *value;
+    NadaValue *params;
+    NadaValue *body;
+    NadaValue *op;
+    NadaValue *args;
+    NadaCode *code;
+    BuiltinFunc form;
+    NadaNode **kids;
+    NadaNode **arg_nodes;
+    int strict;
+};
+
+struct NadaCode {
+    int ref_count;
+    int required;            // Number of fixed parameters
+    const char **params;     // Their interned names
+    const char *rest;        // Rest parameter, NULL if there is none
+    int bad_params;          // Parameter list is not a list of symbols
+    int repeated_params;     // Some name is used twice, bind by name
+    NadaFrameLayout *layout; // Parameters, rest parameter, internal defines
+    NadaValue *source;       // The body expressions
+    NadaNode *body;          // Built on the first run with the tree engine
+    NadaBytecode *bytecode;  // Built on the first run with the VM
+};
+
+// Arguments up to this count are evaluated into a stack array
+#define INLINE_ARGS 8
+
+static NadaNode *analyze(NadaValue *expr, NadaFrameLayout *scope);
+static NadaNode *analyze_seq(NadaValue *exprs, NadaFrameLayout *scope);
+static NadaValue *exec_body_checked(NadaNode *body, NadaEnv *env);
+
+static void *checked_malloc(size_t size) {
+    void *p = malloc(size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+static NadaNode *new_node(NodeKind kind, ExecFunc exec) {
+    NadaNode *node = calloc(1, sizeof(NadaNode));
+    if (node == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    node->kind = kind;
+    node->exec = exec;
+    return node;
+}
+
+static NadaNode **new_kids(int count) {
+    return checked_malloc((count > 0 ? count : 1) * sizeof(NadaNode *));
+}
+
+static void free_node(NadaNode *node) {
+    if (node == NULL) return;
+
+    int kids = 0;
+    switch (node->kind) {
+    case NODE_IF:
+        kids = 3;
+        break;
+    case NODE_COND:
+        kids = 2 * node->count;
+        break;
+    case NODE_DEFINE:
+    case NODE_SET:
+        kids = 1;
+        break;
+    case NODE_SEQ:
+    case NODE_AND:
+    case NODE_OR:
+        kids = node->count;
+        break;
+    case NODE_LET:
+    case NODE_NAMED_LET:
+        kids = node->count + 1;
+        break;
+    case NODE_CALL:
+        kids = 1;
+        break;
+    default:
+        break;
+    }
+    for (int i = 0; i < kids; i++) {
+        free_node(node->kids[i]);
+    }
+    if (node->arg_nodes != NULL) {
+        for (int i = 0; i < node->count; i++) {
+            free_node(node->arg_nodes[i]);
+        }
+    }
+
+    free(node->kids);
+    free(node->arg_nodes);
+    nada_layout_release(node->layout);
+    nada_free(node->value);
+    nada_free(node->params);
+    nada_free(node->body);
+    nada_free(node->op);
+    nada_free(node->args);
+    nada_code_release(node->code);
+    free(node);
+}
+
+int nada_list_length(NadaValue *list) {
+    int length = 0;
+    while (list->type == NADA_PAIR) {
+        length++;
+        list = list->data.pair.cdr;
+    }
+    return list->type == NADA_NIL ? length : -1;
+}
+
+static int is_false(NadaValue *val) {
+    return val->type == NADA_BOOL && val->data.boolean == 0;
+}
+
+// cond, and and or also treat nil as false
+static int is_false_or_nil(NadaValue *val) {
+    return is_false(val) || val->type == NADA_NIL;
+}
+
+// ----- Execution -----
+
+static NadaValue *exec_const(NadaNode *node, NadaEnv *env) {
+    (void)env;
+    return nada_retain(node->value);
+}
+
+static NadaValue *exec_ref(NadaNode *node, NadaEnv *env) {
+    NadaValue *val = nada_env_peek_var(env, &node->ref);
+    if (val != NULL) {
+        return nada_retain(val);
+    }
+    // Reports the unbound symbol
+    return nada_env_get_symbol(env, node->ref.sym, nada_is_global_silent_symbol_lookup());
+}
+
+static NadaValue *exec_if(NadaNode *node, NadaEnv *env) {
+    NadaValue *test = node->kids[0]->exec(node->kids[0], env);
+    int is_true = !is_false(test);
+    nada_free(test);
+
+    NadaNode *branch = is_true ? node->kids[1] : node->kids[2];
+    if (branch == NULL) {
+        return nada_create_nil();  // No else clause
+    }
+    return branch->exec(branch, env);
+}
+
+static NadaValue *exec_cond(NadaNode *node, NadaEnv *env) {
+    for (int i = 0; i < node->count; i++) {
+        NadaNode *test = node->kids[2 * i];
+        if (test != NULL) {
+            NadaValue *test_result = test->exec(test, env);
+            int is_true = !is_false_or_nil(test_result);
+            nada_free(test_result);
+            if (!is_true) continue;
+        }
+
+        // A clause without body yields true
+        NadaNode *body = node->kids[2 * i + 1];
+        if (body == NULL) {
+            return nada_create_bool(1);
+        }
+        return body->exec(body, env);
+    }
+
+    // No condition matched
+    return nada_create_nil();
+}
+
+static NadaValue *exec_define(NadaNode *node, NadaEnv *env) {
+    NadaValue *val = node->kids[0]->exec(node->kids[0], env);
+    nada_env_set_symbol(env, node->sym, val);
+    nada_free(val);
+    return nada_create_symbol(node->sym);
+}
+
+static NadaValue *exec_define_func(NadaNode *node, NadaEnv *env) {
+    nada_define_closure(env, node->sym, node->params, node->body, node->code);
+    return nada_create_symbol(node->sym);
+}
+
+static NadaValue *exec_set(NadaNode *node, NadaEnv *env) {
+    NadaValue *val = node->kids[0]->exec(node->kids[0], env);
+    if (!nada_env_assign_var(env, &node->ref, val)) {
+        nada_report_error(NADA_ERROR_UNDEFINED_SYMBOL, "set! variable '%s' not found", node->ref.sym);
+        nada_free(val);
+        return nada_create_nil();
+    }
+    return val;
+}
+
+static NadaValue *exec_lambda(NadaNode *node, NadaEnv *env) {
+    return nada_make_closure(node->params, node->body, node->code, env);
+}
+
+static NadaValue *exec_seq(NadaNode *node, NadaEnv *env) {
+    NadaValue *result = nada_create_nil();
+    for (int i = 0; i < node->count; i++) {
+        nada_free(result);
+        result = node->kids[i]->exec(node->kids[i], env);
+    }
+    return result;
+}
+
+static NadaValue *exec_and(NadaNode *node, NadaEnv *env) {
+    NadaValue *result = nada_create_bool(1);
+    for (int i = 0; i < node->count; i++) {
+        nada_free(result);
+        result = node->kids[i]->exec(node->kids[i], env);
+        if (is_false_or_nil(result)) break;
+    }
+    return result;
+}
+
+static NadaValue *exec_or(NadaNode *node, NadaEnv *env) {
+    NadaValue *result = nada_create_bool(0);
+    for (int i = 0; i < node->count; i++) {
+        nada_free(result);
+        result = node->kids[i]->exec(node->kids[i], env);
+        if (!is_false_or_nil(result)) break;
+    }
+    return result;
+}
+
+// Evaluate the bindings of a let in env into the first slots of let_env.
+// The values go to the slots as they are; an error value is returned.
+static NadaValue *exec_bindings(NadaNode *node, NadaEnv *let_env, NadaEnv *env) {
+    for (int i = 0; i < node->count; i++) {
+        NadaValue *val = node->kids[i]->exec(node->kids[i], env);
+        if (val->type == NADA_ERROR) {
+            return val;
+        }
+        let_env->slots[i] = val;
+    }
+    return NULL;
+}
+
+static NadaValue *exec_let(NadaNode *node, NadaEnv *env) {
+    NadaEnv *let_env = nada_env_create_frame(env, node->layout);
+
+    // Initial values are evaluated in the enclosing environment
+    NadaValue *error = exec_bindings(node, let_env, env);
+    if (error != NULL) {
+        nada_env_release(let_env);
+        return error;
+    }
+
+    NadaNode *body = node->kids[node->count];
+    NadaValue *result = body->exec(body, let_env);
+    return nada_leave_let(let_env, result, false);
+}
+
+static void mark_tail_calls(NadaNode *node);
+
+// Nodes of a function body, analyzed on first use
+static NadaNode *code_body(NadaCode *code) {
+    if (code->body == NULL) {
+        code->body = analyze_seq(code->source, code->layout);
+        mark_tail_calls(code->body);
+    }
+    return code->body;
+}
+
+static NadaValue *exec_named_let(NadaNode *node, NadaEnv *env) {
+    // The loop environment holds an extra reference, see builtin_let
+    NadaEnv *loop_env = nada_env_create_frame(env, node->layout);
+    nada_env_add_ref(loop_env);
+
+    NadaValue *error = exec_bindings(node, loop_env, env);
+    if (error != NULL) {
+        nada_env_release(loop_env);
+        nada_env_release(loop_env);
+        return error;
+    }
+
+    nada_define_closure(loop_env, node->sym, node->params, node->body, node->code);
+
+    NadaValue *result = exec_body_checked(node->kids[node->count], loop_env);
+    if (result->type == NADA_ERROR) {
+        nada_env_release(loop_env);
+        nada_env_release(loop_env);
+        return result;
+    }
+    return nada_leave_let(loop_env, result, true);
+}
+
+// A body that stops at the first expression producing an error value
+static NadaValue *exec_body_checked(NadaNode *body, NadaEnv *env) {
+    if (body->kind != NODE_SEQ) {
+        return body->exec(body, env);
+    }
+
+    NadaValue *result = nada_create_nil();
+    for (int i = 0; i < body->count; i++) {
+        nada_free(result);
+        result = body->kids[i]->exec(body->kids[i], env);
+        if (result->type == NADA_ERROR) break;
+    }
+    return result;
+}
+
+static NadaValue *exec_form(NadaNode *node, NadaEnv *env) {
+    return node->form(node->args, env);
+}
+
+static void analyze_args(NadaNode *node) {
+    if (node->arg_nodes != NULL) return;
+    node->arg_nodes = new_kids(node->count);
+    NadaValue *arg = node->args;
+    for (int i = 0; i < node->count; i++) {
+        node->arg_nodes[i] = analyze(arg->data.pair.car, node->scope);
+        arg = arg->data.pair.cdr;
+    }
+}
+
+static void exec_args(NadaNode *node, NadaEnv *env, NadaValue **argv) {
+    analyze_args(node);
+    for (int i = 0; i < node->count; i++) {
+        argv[i] = node->arg_nodes[i]->exec(node->arg_nodes[i], env);
+    }
+}
+
+static void free_args(NadaValue **argv, int argc) {
+    for (int i = 0; i < argc; i++) {
+        nada_free(argv[i]);
+    }
+}
+
+// Builtins that evaluate each of their arguments once, in order, in the
+// caller's environment, and keep no reference to the argument list
+static const BuiltinFunc strict_builtins[] = {
+    builtin_car, builtin_cdr, builtin_cadr, builtin_caddr, builtin_cons,
+    builtin_list, builtin_length, builtin_list_ref, builtin_sublist,
+    builtin_add, builtin_subtract, builtin_multiply, builtin_divide,
+    builtin_modulo, builtin_remainder, builtin_expt, builtin_expt_mod,
+    builtin_exact_integer_sqrt, builtin_exact_integer_root,
+    builtin_numerator, builtin_denominator, builtin_sign, builtin_factor,
+    builtin_exact_to_inexact, builtin_inexact_to_exact,
+    builtin_less_than, builtin_less_equal, builtin_greater_than,
+    builtin_greater_equal, builtin_numeric_equal, builtin_eq, builtin_equal,
+    builtin_null, builtin_integer_p, builtin_number_p, builtin_exact_p,
+    builtin_inexact_p, builtin_string_p, builtin_symbol_p, builtin_boolean_p,
+    builtin_pair_p, builtin_function_p, builtin_procedure_p, builtin_list_p,
+    builtin_atom_p, builtin_not,
+    builtin_string_length, builtin_substring, builtin_string_split,
+    builtin_string_join, builtin_string_upcase, builtin_string_downcase,
+    builtin_string_to_number, builtin_number_to_string,
+    builtin_write_to_string, builtin_display
+};
+
+int nada_builtin_is_strict(BuiltinFunc builtin) {
+    for (size_t i = 0; i < sizeof(strict_builtins) / sizeof(strict_builtins[0]); i++) {
+        if (strict_builtins[i] == builtin) return 1;
+    }
+    return 0;
+}
+
+static NadaValue *stack_pair(NadaValue *cell, NadaValue *car, NadaValue *cdr) {
+    cell->type = NADA_PAIR;
+    cell->ref_count = NADA_REF_IMMORTAL;
+    cell->data.pair.car = car;
+    cell->data.pair.cdr = cdr;
+    return cell;
+}
+
+// The builtin gets an argument list of cells owned by this call whose
+// elements evaluate to the values: self-evaluating values stand for
+// themselves, symbols and lists are quoted.
+NadaValue *nada_call_builtin_values(BuiltinFunc builtin, NadaValue **argv, int argc, NadaEnv *env) {
+    static NadaValue *quote_symbol = NULL;
+    if (quote_symbol == NULL) {
+        quote_symbol = nada_symbol_value(nada_intern("quote"));
+    }
+
+    NadaValue inline_cells[3 * INLINE_ARGS];
+    NadaValue *cells = argc > INLINE_ARGS ? checked_malloc(3 * argc * sizeof(NadaValue)) : inline_cells;
+
+    NadaValue *args = nada_create_nil();
+    for (int i = argc - 1; i >= 0; i--) {
+        NadaValue *arg = argv[i];
+        if (arg->type == NADA_SYMBOL || arg->type == NADA_PAIR) {
+            arg = stack_pair(&cells[3 * i + 1], quote_symbol,
+                             stack_pair(&cells[3 * i + 2], arg, nada_create_nil()));
+        }
+        args = stack_pair(&cells[3 * i], arg, args);
+    }
+
+    NadaValue *result = builtin(args, env);
+    if (cells != inline_cells) {
+        free(cells);
+    }
+    return result;
+}
+
+// Call a strict builtin with arguments evaluated by their nodes. Longer
+// argument lists are left to the builtin rather than copied to the heap.
+static NadaValue *call_strict(NadaNode *node, BuiltinFunc builtin, NadaEnv *env) {
+    if (node->count > INLINE_ARGS) {
+        return builtin(node->args, env);
+    }
+
+    NadaValue *argv[INLINE_ARGS];
+    exec_args(node, env, argv);
+
+    NadaValue *result = nada_call_builtin_values(builtin, argv, node->count, env);
+
+    free_args(argv, node->count);
+    return result;
+}
+
+// Call a closure, evaluating the arguments with their nodes. The closure is
+// not retained: its code and environment are, so the binding it came from
+// may change while the arguments are evaluated.
+static NadaValue *call_closure(NadaNode *node, NadaValue *func, NadaEnv *env) {
+    NadaCode *code = nada_code_retain(nada_closure_code(func));
+    NadaEnv *closure_env = func->data.function.env;
+    nada_env_add_ref(closure_env);
+
+    NadaValue *inline_argv[INLINE_ARGS];
+    NadaValue **argv = node->count > INLINE_ARGS ? checked_malloc(node->count * sizeof(NadaValue *))
+                                                 : inline_argv;
+    exec_args(node, env, argv);
+
+    NadaValue *result = nada_run_code(code, closure_env, argv, node->count);
+    if (argv != inline_argv) {
+        free(argv);
+    }
+    nada_env_release(closure_env);
+    nada_code_release(code);
+    return result;
+}
+
+// A call in tail position: the arguments are evaluated here and the call of
+// the closure is left to the trampoline (see nada_tail_call)
+static NadaValue *tail_call_closure(NadaNode *node, NadaValue *func, NadaEnv *env) {
+    NadaCode *code = nada_code_retain(nada_closure_code(func));
+    NadaEnv *closure_env = func->data.function.env;
+    nada_env_add_ref(closure_env);
+
+    NadaValue *inline_argv[INLINE_ARGS];
+    NadaValue **argv = node->count > INLINE_ARGS ? checked_malloc(node->count * sizeof(NadaValue *))
+                                                 : inline_argv;
+    exec_args(node, env, argv);
+
+    NadaValue *result = nada_tail_call(code, closure_env, argv, node->count);
+    if (argv != inline_argv) {
+        free(argv);
+    }
+    return result;
+}
+
+// Same resolution as nada_eval: a builtin's name calls the builtin unless
+// it was rebound, anything else is looked up. Closures called in tail
+// position return to the trampoline first.
+static inline NadaValue *call_node(NadaNode *node, NadaEnv *env, int tail) {
+    NadaNode *op = node->kids[0];
+
+    if (op->kind == NODE_REF) {
+        NadaSymbolDispatch *dispatch = nada_symbol_dispatch(op->ref.sym);
+        if (dispatch->builtin != NULL && !dispatch->rebound) {
+            return node->strict ? call_strict(node, dispatch->builtin, env)
+                                : dispatch->builtin(node->args, env);
+        }
+
+        NadaValue *func = nada_env_peek_var(env, &op->ref);
+        if (func == NULL) {
+            if (dispatch->builtin != NULL) {
+                return dispatch->builtin(node->args, env);
+            }
+            return nada_not_a_function(node->op, exec_ref(op, env));  // Reports the unbound symbol
+        }
+        if (func->type == NADA_FUNC && func->data.function.builtin == NULL) {
+            return tail ? tail_call_closure(node, func, env) : call_closure(node, func, env);
+        }
+    }
+
+    NadaValue *func = op->exec(op, env);
+    if (func->type != NADA_FUNC) {
+        return nada_not_a_function(node->op, func);
+    }
+
+    NadaValue *result;
+    if (func->data.function.builtin != NULL) {
+        result = func->data.function.builtin(node->args, env);
+    } else if (tail) {
+        result = tail_call_closure(node, func, env);
+    } else {
+        result = call_closure(node, func, env);
+    }
+    nada_free(func);
+    return result;
+}
+
+static NadaValue *exec_call(NadaNode *node, NadaEnv *env) {
+    return call_node(node, env, 0);
+}
+
+static NadaValue *exec_tail_call(NadaNode *node, NadaEnv *env) {
+    return call_node(node, env, 1);
+}
+
+// Calls whose value is the value of the body are made as tail calls
+static void mark_tail_calls(NadaNode *node) {
+    if (node == NULL) return;
+    switch (node->kind) {
+    case NODE_CALL:
+        node->exec = exec_tail_call;
+        break;
+    case NODE_IF:
+        mark_tail_calls(node->kids[1]);
+        mark_tail_calls(node->kids[2]);
+        break;
+    case NODE_COND:
+        for (int i = 0; i < node->count; i++) {
+            mark_tail_calls(node->kids[2 * i + 1]);
+        }
+        break;
+    case NODE_SEQ:
+    case NODE_AND:
+    case NODE_OR:
+        if (node->count > 0) {
+            mark_tail_calls(node->kids[node->count - 1]);
+        }
+        break;
+    case NODE_LET:
+    case NODE_NAMED_LET:
+        mark_tail_calls(node->kids[node->count]);
+        break;
+    default:
+        break;
+    }
+}
+
+// ----- Analysis -----
+
+static NadaNode *make_const(NadaValue *value) {
+    NadaNode *node = new_node(NODE_CONST, exec_const);
+    node->value = nada_retain(value);
+    return node;
+}
+
+static NadaNode *make_form(BuiltinFunc form, NadaValue *args) {
+    NadaNode *node = new_node(NODE_FORM, exec_form);
+    node->form = form;
+    node->args = nada_retain(args);
+    return node;
+}
+
+// Nodes for a list of expressions, count of them
+static NadaNode **analyze_list(NadaValue *exprs, int count, NadaFrameLayout *scope) {
+    NadaNode **kids = new_kids(count);
+    for (int i = 0; i < count; i++) {
+        kids[i] = analyze(exprs->data.pair.car, scope);
+        exprs = exprs->data.pair.cdr;
+    }
+    return kids;
+}
+
+// Expressions evaluated in order for the value of the last one
+static NadaNode *analyze_seq(NadaValue *exprs, NadaFrameLayout *scope) {
+    int count = 0;
+    for (NadaValue *e = exprs; e->type == NADA_PAIR; e = e->data.pair.cdr) {
+        count++;
+    }
+    if (count == 1) {
+        return analyze(exprs->data.pair.car, scope);
+    }
+    NadaNode *node = new_node(NODE_SEQ, exec_seq);
+    node->count = count;
+    node->kids = analyze_list(exprs, count, scope);
+    return node;
+}
+
+static NadaNode *analyze_if(NadaValue *args, NadaFrameLayout *scope) {
+    int count = nada_list_length(args);
+    if (count < 2) {
+        return make_form(builtin_if, args);
+    }
+    NadaNode *node = new_node(NODE_IF, exec_if);
+    node->kids = new_kids(3);
+    node->kids[0] = analyze(args->data.pair.car, scope);
+    args = args->data.pair.cdr;
+    node->kids[1] = analyze(args->data.pair.car, scope);
+    args = args->data.pair.cdr;
+    node->kids[2] = count > 2 ? analyze(args->data.pair.car, scope) : NULL;
+    return node;
+}
+
+static NadaNode *analyze_cond(NadaValue *args, NadaFrameLayout *scope) {
+    int count = nada_list_length(args);
+    if (count < 0) {
+        return make_form(builtin_cond, args);
+    }
+
+    // Clauses must be lists, else only in the last one
+    const char *sym_else = nada_intern("else");
+    int i = 0;
+    for (NadaValue *clause = args; clause->type == NADA_PAIR; clause = clause->data.pair.cdr, i++) {
+        NadaValue *c = clause->data.pair.car;
+        if (c->type != NADA_PAIR || nada_list_length(c) < 0) {
+            return make_form(builtin_cond, args);
+        }
+        NadaValue *test = c->data.pair.car;
+        if (test->type == NADA_SYMBOL && test->data.symbol == sym_else && i != count - 1) {
+            return make_form(builtin_cond, args);
+        }
+    }
+
+    NadaNode *node = new_node(NODE_COND, exec_cond);
+    node->count = count;
+    node->kids = new_kids(2 * count);
+    i = 0;
+    for (NadaValue *clause = args; clause->type == NADA_PAIR; clause = clause->data.pair.cdr, i++) {
+        NadaValue *test = clause->data.pair.car->data.pair.car;
+        NadaValue *body = clause->data.pair.car->data.pair.cdr;
+        int is_else = test->type == NADA_SYMBOL && test->data.symbol == sym_else;
+        node->kids[2 * i] = is_else ? NULL : analyze(test, scope);
+        node->kids[2 * i + 1] = nada_is_nil(body) ? NULL : analyze_seq(body, scope);
+    }
+    return node;
+}
+
+static NadaNode *analyze_define(NadaValue *args, NadaFrameLayout *scope) {
+    if (args->type != NADA_PAIR || args->data.pair.cdr->type != NADA_PAIR) {
+        return make_form(builtin_define, args);
+    }
+
+    NadaValue *first = args->data.pair.car;
+
+    // (define symbol expr)
+    if (first->type == NADA_SYMBOL) {
+        NadaNode *node = new_node(NODE_DEFINE, exec_define);
+        node->sym = first->data.symbol;
+        node->kids = new_kids(1);
+        node->kids[0] = analyze(args->data.pair.cdr->data.pair.car, scope);
+        return node;
+    }
+
+    // (define (name params...) body...)
+    if (first->type == NADA_PAIR && first->data.pair.car->type == NADA_SYMBOL &&
+        nada_list_length(args->data.pair.cdr) > 0) {
+        NadaNode *node = new_node(NODE_DEFINE_FUNC, exec_define_func);
+        node->sym = first->data.pair.car->data.symbol;
+        node->params = nada_retain(first->data.pair.cdr);
+        node->body = nada_retain(args->data.pair.cdr);
+        node->code = nada_analyze_lambda(node->params, node->body, scope);
+        return node;
+    }
+
+    return make_form(builtin_define, args);
+}
+
+int nada_valid_lambda_params(NadaValue *params) {
+    if (params->type == NADA_SYMBOL) return 1;
+    while (params->type == NADA_PAIR) {
+        if (params->data.pair.car->type != NADA_SYMBOL) return 0;
+        params = params->data.pair.cdr;
+    }
+    return params->type == NADA_NIL || params->type == NADA_SYMBOL;
+}
+
+static NadaNode *analyze_lambda(NadaValue *args, NadaFrameLayout *scope) {
+    if (args->type != NADA_PAIR || nada_list_length(args->data.pair.cdr) < 1 ||
+        !nada_valid_lambda_params(args->data.pair.car)) {
+        return make_form(builtin_lambda, args);
+    }
+
+    NadaNode *node = new_node(NODE_LAMBDA, exec_lambda);
+    node->params = nada_retain(args->data.pair.car);
+    node->body = nada_retain(args->data.pair.cdr);
+    node->code = nada_analyze_lambda(node->params, node->body, scope);
+    return node;
+}
+
+int nada_let_bindings(NadaValue *bindings) {
+    int count = nada_list_length(bindings);
+    for (NadaValue *b = bindings; count > 0 && b->type == NADA_PAIR; b = b->data.pair.cdr) {
+        NadaValue *binding = b->data.pair.car;
+        if (nada_list_length(binding) != 2 || binding->data.pair.car->type != NADA_SYMBOL) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+// Names of a body's own defines, (define name ...) or (define (name ...) ...)
+void nada_layout_add_defines(NadaFrameLayout *layout, NadaValue *body) {
+    for (; body->type == NADA_PAIR; body = body->data.pair.cdr) {
+        NadaValue *expr = body->data.pair.car;
+        if (expr->type != NADA_PAIR || expr->data.pair.car->type != NADA_SYMBOL ||
+            nada_symbol_dispatch(expr->data.pair.car->data.symbol)->special_form != NADA_FORM_DEFINE ||
+            expr->data.pair.cdr->type != NADA_PAIR) {
+            continue;
+        }
+        NadaValue *target = expr->data.pair.cdr->data.pair.car;
+        if (target->type == NADA_PAIR) {
+            target = target->data.pair.car;
+        }
+        if (target->type == NADA_SYMBOL) {
+            nada_layout_add(layout, target->data.symbol);
+        }
+    }
+}
+
+NadaFrameLayout *nada_let_layout(NadaValue *bindings, int count, const char *loop_name, NadaValue *body,
+                                 NadaFrameLayout *scope) {
+    NadaFrameLayout *layout = nada_layout_create(scope);
+    for (NadaValue *b = bindings; b->type == NADA_PAIR; b = b->data.pair.cdr) {
+        nada_layout_add(layout, b->data.pair.car->data.pair.car->data.symbol);
+    }
+    if (layout->count < count) {
+        nada_layout_release(layout);
+        return NULL;
+    }
+    if (loop_name != NULL) {
+        nada_layout_add(layout, loop_name);
+    }
+    nada_layout_add_defines(layout, body);
+    return layout;
+}
+
+static void analyze_bindings(NadaNode *node, NadaValue *bindings, int count, NadaFrameLayout *scope) {
+    node->count = count;
+    node->kids = new_kids(count + 1);
+    int i = 0;
+    for (NadaValue *b = bindings; b->type == NADA_PAIR; b = b->data.pair.cdr, i++) {
+        NadaValue *binding = b->data.pair.car;
+        node->kids[i] = analyze(binding->data.pair.cdr->data.pair.car, scope);
+    }
+    node->kids[count] = NULL;
+}
+
+static NadaNode *analyze_let(NadaValue *args, NadaFrameLayout *scope) {
+    if (args->type != NADA_PAIR || nada_list_length(args) < 0) {
+        return make_form(builtin_let, args);
+    }
+
+    NadaValue *first = args->data.pair.car;
+
+    // (let name ((var init)...) body...)
+    if (first->type == NADA_SYMBOL) {
+        NadaValue *rest = args->data.pair.cdr;
+        int count = rest->type == NADA_PAIR ? nada_let_bindings(rest->data.pair.car) : -1;
+        NadaFrameLayout *layout =
+            count >= 0 ? nada_let_layout(rest->data.pair.car, count, first->data.symbol,
+                                         rest->data.pair.cdr, scope)
+                       : NULL;
+        if (layout == NULL) {
+            return make_form(builtin_let, args);
+        }
+
+        NadaNode *node = new_node(NODE_NAMED_LET, exec_named_let);
+        node->sym = first->data.symbol;
+        node->layout = layout;
+        analyze_bindings(node, rest->data.pair.car, count, scope);
+        node->kids[count] = analyze_seq(rest->data.pair.cdr, layout);
+
+        // Parameters of the loop function
+        NadaValue *params = nada_create_nil();
+        for (int i = count - 1; i >= 0; i--) {
+            NadaValue *new_params = nada_cons(nada_symbol_value(layout->names[i]), params);
+            nada_free(params);
+            params = new_params;
+        }
+        node->params = params;
+        node->body = nada_retain(rest->data.pair.cdr);
+        node->code = nada_analyze_lambda(node->params, node->body, layout);
+        return node;
+    }
+
+    // (let ((var init)...) body...)
+    int count = nada_let_bindings(first);
+    NadaFrameLayout *layout = count >= 0 ? nada_let_layout(first, count, NULL, args->data.pair.cdr, scope)
+                                         : NULL;
+    if (layout == NULL) {
+        return make_form(builtin_let, args);
+    }
+    NadaNode *node = new_node(NODE_LET, exec_let);
+    node->layout = layout;
+    analyze_bindings(node, first, count, scope);
+    node->kids[count] = analyze_seq(args->data.pair.cdr, layout);
+    return node;
+}
+
+static NadaNode *analyze_pair(NadaValue *expr, NadaFrameLayout *scope) {
+    NadaValue *op = expr->data.pair.car;
+    NadaValue *args = expr->data.pair.cdr;
+
+    if (op->type == NADA_SYMBOL) {
+        int count;
+        NadaNode *node;
+        switch (nada_symbol_dispatch(op->data.symbol)->special_form) {
+        case NADA_FORM_QUOTE:
+            if (nada_list_length(args) != 1) {
+                return make_form(builtin_quote, args);
+            }
+            return make_const(args->data.pair.car);
+        case NADA_FORM_DEFINE:
+            return analyze_define(args, scope);
+        case NADA_FORM_LAMBDA:
+            return analyze_lambda(args, scope);
+        case NADA_FORM_COND:
+            return analyze_cond(args, scope);
+        case NADA_FORM_LET:
+            return analyze_let(args, scope);
+        case NADA_FORM_IF:
+            return analyze_if(args, scope);
+        case NADA_FORM_BEGIN:
+            if (nada_list_length(args) < 0) {
+                return make_form(builtin_begin, args);
+            }
+            return analyze_seq(args, scope);
+        case NADA_FORM_AND:
+            count = nada_list_length(args);
+            if (count < 0) {
+                return make_form(builtin_and, args);
+            }
+            node = new_node(NODE_AND, exec_and);
+            node->count = count;
+            node->kids = analyze_list(args, count, scope);
+            return node;
+        case NADA_FORM_OR:
+            count = nada_list_length(args);
+            if (count < 0) {
+                return make_form(builtin_or, args);
+            }
+            node = new_node(NODE_OR, exec_or);
+            node->count = count;
+            node->kids = analyze_list(args, count, scope);
+            return node;
+        case NADA_FORM_SET:
+            if (nada_list_length(args) != 2 || args->data.pair.car->type != NADA_SYMBOL) {
+                return make_form(builtin_set, args);
+            }
+            node = new_node(NODE_SET, exec_set);
+            nada_resolve_var(&node->ref, scope, args->data.pair.car->data.symbol);
+            node->kids = new_kids(1);
+            node->kids[0] = analyze(args->data.pair.cdr->data.pair.car, scope);
+            return node;
+        default:
+            break;
+        }
+    }
+
+    // Application; the arguments are analyzed when they are first evaluated here
+    NadaNode *node = new_node(NODE_CALL, exec_call);
+    node->kids = new_kids(1);
+    node->kids[0] = analyze(op, scope);
+    node->scope = scope;
+    node->op = nada_retain(op);
+    node->args = nada_retain(args);
+    for (NadaValue *arg = args; arg->type == NADA_PAIR; arg = arg->data.pair.cdr) {
+        node->count++;
+    }
+    if (op->type == NADA_SYMBOL) {
+        BuiltinFunc builtin = nada_symbol_dispatch(op->data.symbol)->builtin;
+        node->strict = builtin != NULL && nada_builtin_is_strict(builtin);
+    }
+    return node;
+}
+
+static NadaNode *analyze(NadaValue *expr, NadaFrameLayout *scope) {
+    switch (expr->type) {
+    case NADA_SYMBOL: {
+        NadaNode *node = new_node(NODE_REF, exec_ref);
+        nada_resolve_var(&node->ref, scope, expr->data.symbol);
+        return node;
+    }
+    case NADA_PAIR:
+        return analyze_pair(expr, scope);
+    default:
+        // Numbers, strings, booleans, nil, errors and functions evaluate to themselves
+        return make_const(expr);
+    }
+}
+
+NadaCode *nada_analyze_lambda(NadaValue *params, NadaValue *body, NadaFrameLayout *scope) {
+    nada_init_dispatch();
+
+    NadaCode *code = calloc(1, sizeof(NadaCode));
+    if (code == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    code->ref_count = 1;
+
+    // Fixed parameters, then an optional rest parameter
+    int required = 0;
+    NadaValue *p = params != NULL ? params : nada_create_nil();
+    for (; p->type == NADA_PAIR; p = p->data.pair.cdr) {
+        required++;
+    }
+    code->params = checked_malloc((required > 0 ? required : 1) * sizeof(const char *));
+    p = params != NULL ? params : nada_create_nil();
+    for (; p->type == NADA_PAIR; p = p->data.pair.cdr) {
+        NadaValue *param = p->data.pair.car;
+        if (param->type != NADA_SYMBOL) {
+            code->bad_params = 1;
+            break;
+        }
+        code->params[code->required++] = param->data.symbol;
+    }
+    if (p->type == NADA_SYMBOL) {
+        code->rest = p->data.symbol;
+    } else if (p->type != NADA_NIL) {
+        code->bad_params = 1;
+    }
+
+    // Frame slots: the parameters, then the rest parameter and the defines
+    code->source = nada_retain(body != NULL ? body : nada_create_nil());
+    code->layout = nada_layout_create(scope);
+    for (int i = 0; i < code->required; i++) {
+        nada_layout_add(code->layout, code->params[i]);
+    }
+    if (code->rest != NULL) {
+        nada_layout_add(code->layout, code->rest);
+    }
+    code->repeated_params = code->layout->count < code->required + (code->rest != NULL);
+    nada_layout_add_defines(code->layout, code->source);
+    return code;
+}
+
+NadaCode *nada_code_retain(NadaCode *code) {
+    if (code != NULL) {
+        code->ref_count++;
+    }
+    return code;
+}
+
+void nada_code_release(NadaCode *code) {
+    if (code == NULL || --code->ref_count > 0) return;
+    free_node(code->body);
+    nada_bytecode_free(code->bytecode);
+    nada_free(code->source);
+    nada_layout_release(code->layout);
+    free(code->params);
+    free(code);
+}
+
+// ----- Closures -----
+
+// Code for lambda expressions evaluated outside analyzed code, such as the
+// function argument of map, keyed by the body they were analyzed from.
+// An entry keeps its body alive, so the key cannot be reused by another list.
+#define LAMBDA_CACHE_SIZE 256
+
+typedef struct {
+    NadaValue *params;
+    NadaValue *body;
+    NadaCode *code;
+} LambdaCacheEntry;
+
+static LambdaCacheEntry lambda_cache[LAMBDA_CACHE_SIZE];
+
+// Parameter lists made of the same symbols
+static int same_params(NadaValue *a, NadaValue *b) {
+    while (a->type == NADA_PAIR && b->type == NADA_PAIR) {
+        if (a->data.pair.car != b->data.pair.car &&
+            !(a->data.pair.car->type == NADA_SYMBOL && b->data.pair.car->type == NADA_SYMBOL &&
+              a->data.pair.car->data.symbol == b->data.pair.car->data.symbol)) {
+            return 0;
+        }
+        a = a->data.pair.cdr;
+        b = b->data.pair.cdr;
+    }
+    if (a->type == NADA_SYMBOL && b->type == NADA_SYMBOL) {
+        return a->data.symbol == b->data.symbol;
+    }
+    return a->type == NADA_NIL && b->type == NADA_NIL;
+}
+
+static NadaCode *cached_code(NadaValue *params, NadaValue *body) {
+    LambdaCacheEntry *entry = &lambda_cache[((uintptr_t)body >> 4) % LAMBDA_CACHE_SIZE];
+    if (entry->body == body && same_params(entry->params, params)) {
+        return nada_code_retain(entry->code);
+    }
+
+    nada_free(entry->params);
+    nada_free(entry->body);
+    nada_code_release(entry->code);
+    entry->params = nada_retain(params);
+    entry->body = nada_retain(body);
+    entry->code = nada_analyze_lambda(params, body, NULL);
+    return nada_code_retain(entry->code);
+}
+
+void nada_clear_lambda_cache(void) {
+    for (int i = 0; i < LAMBDA_CACHE_SIZE; i++) {
+        LambdaCacheEntry *entry = &lambda_cache[i];
+        nada_free(entry->params);
+        nada_free(entry->body);
+        nada_code_release(entry->code);
+        entry->params = entry->body = NULL;
+        entry->code = NULL;
+    }
+}
+
+NadaValue *nada_make_closure(NadaValue *params, NadaValue *body, NadaCode *code, NadaEnv *env) {
+    NadaValue *func = nada_create_function(nada_retain(params), nada_retain(body), env);
+    func->data.function.code = code != NULL ? nada_code_retain(code) : cached_code(params, body);
+    return func;
+}
+
+NadaCode *nada_closure_code(NadaValue *func) {
+    if (func->data.function.code == NULL) {
+        func->data.function.code =
+            nada_analyze_lambda(func->data.function.params, func->data.function.body, NULL);
+    }
+    return func->data.function.code;
+}
+
+// ----- Call depth -----
+
+// Closure calls in progress, on the C stack or the VM's control stack. Past
+// max_depth, or close to the end of the C stack, a call returns an error
+// instead of running; the calls still in progress then end at once with the
+// same error, so it reaches the innermost error? or the top level unchanged.
+// The errors builtins report about it on the way are dropped, and at the
+// top level the depth error is reported once the outermost call has ended.
+static int max_depth = NADA_DEFAULT_MAX_DEPTH;
+static int call_depth = 0;
+static bool unwinding = false;
+static int catch_depth = -1;  // Of the innermost error?, -1 for none
+static char depth_error[96];
+static NadaErrorHandler saved_handler;
+static void *saved_user_data;
+
+// Address of a local of the outermost call, and how far below it the C
+// stack may grow
+static uintptr_t stack_base;
+static size_t stack_room = 0;
+
+void nada_set_max_depth(int depth) {
+    max_depth = depth > 0 ? depth : NADA_DEFAULT_MAX_DEPTH;
+}
+
+int nada_get_max_depth(void) {
+    return max_depth;
+}
+
+// Leave a quarter of the stack to the builtins and nested forms that run
+// between two calls
+static size_t usable_stack(void) {
+    size_t size = 8 << 20;
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+        size = limit.rlim_cur;
+    }
+    return size - size / 4;
+}
+
+static void ignore_error(NadaErrorType type, const char *message, void *user_data) {
+}
+
+// The call would go too deep, or others already did: the depth error
+static NadaValue *call_too_deep(void) {
+    if (!unwinding) {
+        if (call_depth >= max_depth) {
+            snprintf(depth_error, sizeof(depth_error), "maximum recursion depth %d exceeded", max_depth);
+        } else {
+            snprintf(depth_error, sizeof(depth_error), "recursion too deep for the C stack at depth %d",
+                     call_depth);
+        }
+        saved_handler = nada_get_error_handler();
+        saved_user_data = nada_get_user_data();
+        nada_set_error_handler(ignore_error, NULL);
+        unwinding = true;
+    }
+    return nada_create_error(depth_error);
+}
+
+static inline NadaValue *enter_call(void) {
+    char here;
+    if (call_depth == 0) {
+        stack_base = (uintptr_t)&here;
+        unwinding = false;
+        if (stack_room == 0) stack_room = usable_stack();
+    }
+    if (unwinding || call_depth >= max_depth || stack_base - (uintptr_t)&here >= stack_room) {
+        return call_too_deep();
+    }
+    call_depth++;
+    return NULL;
+}
+
+// A call ended while unwinding
+static NadaValue *call_unwound(NadaValue *result) {
+    if (call_depth == 0 && catch_depth != 0) {
+        nada_set_error_handler(saved_handler, saved_user_data);
+        nada_report_error(NADA_ERROR_RECURSION_DEPTH, "%s", depth_error);
+    }
+    nada_free(result);
+    return nada_create_error(depth_error);
+}
+
+static inline NadaValue *leave_call(NadaValue *result) {
+    call_depth--;
+    return unwinding ? call_unwound(result) : result;
+}
+
+int nada_catch_begin(void) {
+    int outer = catch_depth;
+    // A depth error already unwinding belongs to an outer catch
+    catch_depth = unwinding ? -1 : call_depth;
+    return outer;
+}
+
+bool nada_catch_end(int outer) {
+    bool caught = unwinding && call_depth == catch_depth;
+    if (caught) {
+        unwinding = false;
+        nada_set_error_handler(saved_handler, saved_user_data);
+    }
+    catch_depth = outer;
+    return caught;
+}
+
+// ----- Tail calls -----
+
+// A call made in tail position that has not run yet. The caller's body
+// returns tail_call_marker as its value, and the nada_run_code running that
+// body makes the call in its place, so tail recursion runs in constant
+// stack. Nothing is evaluated between leaving the call and making it.
+static struct {
+    NadaCode *code;
+    NadaEnv *env;
+    NadaValue **argv;
+    int argc;
+    int argv_capacity;
+    int let_base;  // deferred_count when the call was left
+} tail_call;
+
+static NadaValue tail_call_marker = {.type = NADA_NIL, .ref_count = NADA_REF_IMMORTAL};
+
+// Frames of lets that pending calls may still use, released when the call
+// that was running when they were left returns; the latest ones are on top
+typedef struct {
+    NadaEnv *env;
+    bool named;
+} LetFrame;
+
+static LetFrame *deferred_lets = NULL;
+static int deferred_count = 0;
+static int deferred_capacity = 0;
+
+NadaValue *nada_tail_call(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc) {
+    if (argc > tail_call.argv_capacity) {
+        free(tail_call.argv);
+        tail_call.argv = checked_malloc(argc * sizeof(NadaValue *));
+        tail_call.argv_capacity = argc;
+    }
+    for (int i = 0; i < argc; i++) {
+        tail_call.argv[i] = argv[i];
+    }
+    tail_call.code = code;
+    tail_call.env = env;
+    tail_call.argc = argc;
+    tail_call.let_base = deferred_count;
+    return &tail_call_marker;
+}
+
+bool nada_is_tail_call(NadaValue *value) {
+    return value == &tail_call_marker;
+}
+
+#ifndef NADA_ENABLE_GC
+// A let frame is released at once (nada_release_let_env), which is only
+// safe once nothing but the let and the closures bound in it refer to it
+static bool let_in_use(NadaEnv *let_env, bool named) {
+    int own = named ? 2 : 1;
+    int slot_count = let_env->layout != NULL ? let_env->layout->count : 0;
+    for (int i = 0; i < slot_count; i++) {
+        NadaValue *value = let_env->slots[i];
+        if (value != NULL && value->type == NADA_FUNC && value->data.function.env == let_env) {
+            own++;
+        }
+    }
+    for (struct NadaBinding *b = let_env->bindings; b != NULL; b = b->next) {
+        if (b->value != NULL && b->value->type == NADA_FUNC && b->value->data.function.env == let_env) {
+            own++;
+        }
+    }
+    return let_env->ref_count > own;
+}
+#endif
+
+NadaValue *nada_leave_let(NadaEnv *let_env, NadaValue *result, bool named) {
+    if (result != &tail_call_marker) {
+        return nada_release_let_env(let_env, result, named);
+    }
+
+#ifndef NADA_ENABLE_GC
+    // The pending call refers to the frame, through the closure it calls or
+    // its arguments: keep the frame until the call returns
+    if (let_in_use(let_env, named)) {
+        if (deferred_count == deferred_capacity) {
+            deferred_capacity = deferred_capacity ? 2 * deferred_capacity : 4;
+            deferred_lets = realloc(deferred_lets, deferred_capacity * sizeof(LetFrame));
+            if (deferred_lets == NULL) {
+                fprintf(stderr, "Error: Out of memory\n");
+                exit(1);
+            }
+        }
+        deferred_lets[deferred_count++] = (LetFrame){let_env, named};
+        return result;
+    }
+#endif
+    nada_free(nada_release_let_env(let_env, nada_create_nil(), named));
+    return result;
+}
+
+int nada_deferred_let_count(void) {
+    return deferred_count;
+}
+
+static NadaValue *release_deferred_lets(int count, NadaValue *result) {
+    while (deferred_count > count) {
+        deferred_count--;
+        result = nada_release_let_env(deferred_lets[deferred_count].env, result,
+                                      deferred_lets[deferred_count].named);
+    }
+    return result;
+}
+
+// ----- Running code -----
+
+// New frame below env with the parameters of code bound to the arguments,
+// whose references move into the frame (argv itself stays owned by the
+// caller); NULL after reporting a parameter mismatch
+static NadaEnv *bind_params(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc) {
+    const char *mismatch = NULL;
+    if (code->bad_params) {
+        mismatch = "invalid parameter list";
+    } else if (argc < code->required) {
+        mismatch = "too few arguments";
+    } else if (argc > code->required && code->rest == NULL) {
+        mismatch = "too many arguments";
+    }
+    if (mismatch != NULL) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "%s", mismatch);
+        free_args(argv, argc);
+        return NULL;
+    }
+
+    NadaEnv *func_env = nada_env_create_frame(env, code->layout);
+    NadaValue *rest = NULL;
+    if (code->rest != NULL) {
+        // Built once, from the end, out of the extra arguments
+        rest = nada_create_nil();
+        for (int i = argc - 1; i >= code->required; i--) {
+            NadaValue *new_rest = nada_cons(argv[i], rest);
+            nada_free(argv[i]);
+            nada_free(rest);
+            rest = new_rest;
+        }
+    }
+    if (!code->repeated_params) {
+        for (int i = 0; i < code->required; i++) {
+            func_env->slots[i] = argv[i];
+        }
+        if (rest != NULL) {
+            func_env->slots[code->required] = rest;
+        }
+    } else {
+        // Later parameters of the same name win
+        for (int i = 0; i < code->required; i++) {
+            nada_env_set_symbol(func_env, code->params[i], argv[i]);
+            nada_free(argv[i]);
+        }
+        if (rest != NULL) {
+            nada_env_set_symbol(func_env, code->rest, rest);
+            nada_free(rest);
+        }
+    }
+    return func_env;
+}
+
+NadaEnv *nada_take_tail_call(NadaCode **code) {
+    // The lets were left innermost first, turn them so they are released
+    // innermost first
+    for (int i = tail_call.let_base, j = deferred_count - 1; i < j; i++, j--) {
+        LetFrame let = deferred_lets[i];
+        deferred_lets[i] = deferred_lets[j];
+        deferred_lets[j] = let;
+    }
+
+    *code = tail_call.code;
+    NadaEnv *func_env = NULL;
+    if (!unwinding) {
+        func_env = bind_params(tail_call.code, tail_call.env, tail_call.argv, tail_call.argc);
+    } else {
+        free_args(tail_call.argv, tail_call.argc);
+    }
+    nada_env_release(tail_call.env);
+    return func_env;
+}
+
+NadaBytecode *nada_code_bytecode(NadaCode *code) {
+    if (code->bytecode == NULL) {
+        code->bytecode = nada_compile(code->source, code->layout);
+    }
+    return code->bytecode;
+}
+
+static NadaValue *run_body(NadaCode *code, NadaEnv *func_env) {
+    if (nada_get_engine() == NADA_ENGINE_VM) {
+        return nada_vm_run(nada_code_bytecode(code), func_env);
+    }
+    NadaNode *body = code_body(code);
+    return body->exec(body, func_env);
+}
+
+// Make pending tail calls until one returns a value, then release the let
+// frames deferred for them, those above the first lets
+static NadaValue *run_tail_calls(int lets) {
+    NadaValue *result;
+    do {
+        NadaCode *code;
+        NadaEnv *func_env = nada_take_tail_call(&code);
+        if (func_env == NULL) {
+            result = nada_create_nil();
+        } else {
+            result = run_body(code, func_env);
+            nada_env_release(func_env);
+        }
+        nada_code_release(code);
+    } while (result == &tail_call_marker);
+
+    return release_deferred_lets(lets, result);
+}
+
+static inline NadaEnv *start_call(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc, NadaValue **result) {
+    *result = enter_call();
+    if (*result != NULL) {
+        free_args(argv, argc);
+        return NULL;
+    }
+
+    NadaEnv *func_env = bind_params(code, env, argv, argc);
+    if (func_env == NULL) {
+        *result = leave_call(nada_create_nil());
+    }
+    return func_env;
+}
+
+static inline NadaValue *end_call(int lets, NadaValue *result) {
+    if (deferred_count > lets) {
+        result = release_deferred_lets(lets, result);
+    }
+    return leave_call(result);
+}
+
+NadaEnv *nada_start_call(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc, NadaValue **result) {
+    return start_call(code, env, argv, argc, result);
+}
+
+NadaValue *nada_end_call(int lets, NadaValue *result) {
+    return end_call(lets, result);
+}
+
+NadaValue *nada_run_code(NadaCode *code, NadaEnv *env, NadaValue **argv, int argc) {
+    int lets = deferred_count;
+    NadaValue *result;
+    NadaEnv *func_env = start_call(code, env, argv, argc, &result);
+    if (func_env == NULL) {
+        return result;
+    }
+
+    result = run_body(code, func_env);
+    nada_env_release(func_env);
+    if (result == &tail_call_marker) {
+        result = run_tail_calls(lets);
+    }
+    return end_call(lets, result);
+}
+
+NadaValue *nada_apply_closure(NadaValue *func, NadaValue **argv, int argc) {
+    NadaValue *inline_argv[INLINE_ARGS];
+    NadaValue **owned = argc > INLINE_ARGS ? checked_malloc(argc * sizeof(NadaValue *)) : inline_argv;
+    for (int i = 0; i < argc; i++) {
+        owned[i] = nada_retain(argv[i]);
+    }
+
+    NadaValue *result = nada_run_code(nada_closure_code(func), func->data.function.env, owned, argc);
+    if (owned != inline_argv) {
+        free(owned);
+    }
+    return result;
+}
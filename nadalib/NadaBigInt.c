@@ -0,0 +1,1139 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "NadaBigInt.h"
+
+// Largest power of ten that fits in a limb, used for decimal conversion
+#define DECIMAL_CHUNK 1000000000u
+#define DECIMAL_CHUNK_DIGITS 9
+
+static void *big_xrealloc(void *ptr, size_t size) {
+    void *p = realloc(ptr, size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+// Make room for at least cap limbs, keeping the current contents
+static void big_reserve(NadaBigInt *a, size_t cap) {
+    if (a->cap >= cap) return;
+    size_t new_cap = a->cap ? a->cap * 2 : 4;
+    if (new_cap < cap) new_cap = cap;
+    a->limbs = big_xrealloc(a->limbs, new_cap * sizeof(NadaLimb));
+    a->cap = new_cap;
+}
+
+// Drop leading zero limbs
+static void big_trim(NadaBigInt *a) {
+    while (a->len > 0 && a->limbs[a->len - 1] == 0) {
+        a->len--;
+    }
+}
+
+// Replace the storage of r with a freshly computed limb buffer
+static void big_adopt(NadaBigInt *r, NadaLimb *limbs, size_t len) {
+    free(r->limbs);
+    r->limbs = limbs;
+    r->len = len;
+    r->cap = len;
+    big_trim(r);
+}
+
+void nada_big_init(NadaBigInt *a) {
+    a->limbs = NULL;
+    a->len = 0;
+    a->cap = 0;
+}
+
+void nada_big_free(NadaBigInt *a) {
+    free(a->limbs);
+    nada_big_init(a);
+}
+
+void nada_big_set(NadaBigInt *r, const NadaBigInt *a) {
+    if (r == a) return;
+    big_reserve(r, a->len);
+    if (a->len) memcpy(r->limbs, a->limbs, a->len * sizeof(NadaLimb));
+    r->len = a->len;
+}
+
+void nada_big_set_u64(NadaBigInt *r, uint64_t value) {
+    big_reserve(r, 2);
+    r->limbs[0] = (NadaLimb)value;
+    r->limbs[1] = (NadaLimb)(value >> NADA_LIMB_BITS);
+    r->len = 2;
+    big_trim(r);
+}
+
+void nada_big_swap(NadaBigInt *a, NadaBigInt *b) {
+    NadaBigInt tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+bool nada_big_to_u64(const NadaBigInt *a, uint64_t *out) {
+    if (a->len > 2) return false;
+    uint64_t value = 0;
+    if (a->len > 1) value = (uint64_t)a->limbs[1] << NADA_LIMB_BITS;
+    if (a->len > 0) value |= a->limbs[0];
+    if (out) *out = value;
+    return true;
+}
+
+size_t nada_big_bit_length(const NadaBigInt *a) {
+    if (a->len == 0) return 0;
+    size_t bits = (a->len - 1) * NADA_LIMB_BITS;
+    for (NadaLimb top = a->limbs[a->len - 1]; top; top >>= 1) {
+        bits++;
+    }
+    return bits;
+}
+
+int nada_big_cmp(const NadaBigInt *a, const NadaBigInt *b) {
+    if (a->len != b->len) return a->len < b->len ? -1 : 1;
+    for (size_t i = a->len; i-- > 0;) {
+        if (a->limbs[i] != b->limbs[i]) return a->limbs[i] < b->limbs[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+void nada_big_add(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    if (a->len < b->len) {
+        const NadaBigInt *t = a;
+        a = b;
+        b = t;
+    }
+    size_t alen = a->len, blen = b->len;
+    big_reserve(r, alen + 1);  // May move a or b if they are r
+
+    NadaDLimb carry = 0;
+    for (size_t i = 0; i < alen; i++) {
+        carry += (NadaDLimb)a->limbs[i] + (i < blen ? b->limbs[i] : 0);
+        r->limbs[i] = (NadaLimb)carry;
+        carry >>= NADA_LIMB_BITS;
+    }
+    r->limbs[alen] = (NadaLimb)carry;
+    r->len = alen + 1;
+    big_trim(r);
+}
+
+void nada_big_sub(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    size_t alen = a->len, blen = b->len;
+    big_reserve(r, alen);
+
+    NadaLimb borrow = 0;
+    for (size_t i = 0; i < alen; i++) {
+        NadaLimb bi = i < blen ? b->limbs[i] : 0;
+        NadaLimb ai = a->limbs[i];
+        r->limbs[i] = ai - bi - borrow;
+        borrow = (ai < bi) || (ai - bi < borrow);
+    }
+    r->len = alen;
+    big_trim(r);
+}
+
+void nada_big_add_small(NadaBigInt *r, const NadaBigInt *a, NadaLimb b) {
+    size_t alen = a->len;
+    big_reserve(r, alen + 1);
+
+    NadaDLimb carry = b;
+    for (size_t i = 0; i < alen; i++) {
+        carry += a->limbs[i];
+        r->limbs[i] = (NadaLimb)carry;
+        carry >>= NADA_LIMB_BITS;
+    }
+    r->limbs[alen] = (NadaLimb)carry;
+    r->len = alen + 1;
+    big_trim(r);
+}
+
+void nada_big_mul_small(NadaBigInt *r, const NadaBigInt *a, NadaLimb b) {
+    size_t alen = a->len;
+    big_reserve(r, alen + 1);
+
+    NadaDLimb carry = 0;
+    for (size_t i = 0; i < alen; i++) {
+        carry += (NadaDLimb)a->limbs[i] * b;
+        r->limbs[i] = (NadaLimb)carry;
+        carry >>= NADA_LIMB_BITS;
+    }
+    r->limbs[alen] = (NadaLimb)carry;
+    r->len = alen + 1;
+    big_trim(r);
+}
+
+void nada_big_shl(NadaBigInt *r, const NadaBigInt *a, size_t bits) {
+    if (a->len == 0) {
+        r->len = 0;
+        return;
+    }
+    size_t limb_shift = bits / NADA_LIMB_BITS;
+    unsigned bit_shift = bits % NADA_LIMB_BITS;
+    size_t alen = a->len;
+    big_reserve(r, alen + limb_shift + 1);
+
+    // Work from the top down so that r may alias a
+    r->limbs[alen + limb_shift] = 0;
+    for (size_t i = alen; i-- > 0;) {
+        NadaDLimb v = (NadaDLimb)a->limbs[i] << bit_shift;
+        r->limbs[i + limb_shift + 1] |= (NadaLimb)(v >> NADA_LIMB_BITS);
+        r->limbs[i + limb_shift] = (NadaLimb)v;
+    }
+    for (size_t i = 0; i < limb_shift; i++) {
+        r->limbs[i] = 0;
+    }
+    r->len = alen + limb_shift + 1;
+    big_trim(r);
+}
+
+void nada_big_shr(NadaBigInt *r, const NadaBigInt *a, size_t bits) {
+    size_t limb_shift = bits / NADA_LIMB_BITS;
+    unsigned bit_shift = bits % NADA_LIMB_BITS;
+    if (limb_shift >= a->len) {
+        r->len = 0;
+        return;
+    }
+    size_t len = a->len - limb_shift;
+    big_reserve(r, len);
+
+    // Work from the bottom up so that r may alias a
+    for (size_t i = 0; i < len; i++) {
+        NadaDLimb v = a->limbs[i + limb_shift];
+        if (i + limb_shift + 1 < a->len) {
+            v |= (NadaDLimb)a->limbs[i + limb_shift + 1] << NADA_LIMB_BITS;
+        }
+        r->limbs[i] = (NadaLimb)(v >> bit_shift);
+    }
+    r->len = len;
+    big_trim(r);
+}
+
+// Multiplication: schoolbook for small operands, Karatsuba above
+// nada_big_karatsuba_threshold limbs and Toom-3 above
+// nada_big_toom3_threshold. The Karatsuba and Toom-3 steps split their
+// operands into read-only slices and recurse through mul_into().
+
+size_t nada_big_karatsuba_threshold = NADA_BIG_KARATSUBA_THRESHOLD;
+size_t nada_big_toom3_threshold = NADA_BIG_TOOM3_THRESHOLD;
+
+// Signed intermediate for the Toom-3 evaluation and interpolation
+typedef struct {
+    NadaBigInt mag;
+    int sign;
+} SignedBig;
+
+static void mul_into(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b);
+
+// Read-only view of len limbs of a, starting at limb start
+static NadaBigInt big_slice(const NadaBigInt *a, size_t start, size_t len) {
+    NadaBigInt slice = NADA_BIG_INIT;
+    if (start >= a->len) return slice;
+    slice.limbs = a->limbs + start;
+    slice.len = len < a->len - start ? len : a->len - start;
+    big_trim(&slice);
+    return slice;
+}
+
+// r += a * 2^(NADA_LIMB_BITS * offset); r must not alias a
+static void add_shifted(NadaBigInt *r, const NadaBigInt *a, size_t offset) {
+    if (a->len == 0) return;
+    size_t len = (r->len > a->len + offset ? r->len : a->len + offset) + 1;
+    big_reserve(r, len);
+    memset(r->limbs + r->len, 0, (len - r->len) * sizeof(NadaLimb));
+
+    NadaDLimb carry = 0;
+    size_t i = 0;
+    for (; i < a->len; i++) {
+        carry += (NadaDLimb)r->limbs[i + offset] + a->limbs[i];
+        r->limbs[i + offset] = (NadaLimb)carry;
+        carry >>= NADA_LIMB_BITS;
+    }
+    for (i += offset; carry; i++) {
+        carry += r->limbs[i];
+        r->limbs[i] = (NadaLimb)carry;
+        carry >>= NADA_LIMB_BITS;
+    }
+    r->len = len;
+    big_trim(r);
+}
+
+// r = a_sign * a + b_sign * b
+static void signed_add(SignedBig *r, const NadaBigInt *a, int a_sign, const NadaBigInt *b, int b_sign) {
+    if (a_sign == b_sign) {
+        nada_big_add(&r->mag, a, b);
+        r->sign = a_sign;
+    } else if (nada_big_cmp(a, b) >= 0) {
+        nada_big_sub(&r->mag, a, b);
+        r->sign = a_sign;
+    } else {
+        nada_big_sub(&r->mag, b, a);
+        r->sign = b_sign;
+    }
+}
+
+static void mul_basecase(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    size_t len = a->len + b->len;
+    NadaLimb *out = calloc(len, sizeof(NadaLimb));
+    if (out == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < a->len; i++) {
+        NadaDLimb carry = 0;
+        NadaDLimb ai = a->limbs[i];
+        for (size_t j = 0; j < b->len; j++) {
+            carry += ai * b->limbs[j] + out[i + j];
+            out[i + j] = (NadaLimb)carry;
+            carry >>= NADA_LIMB_BITS;
+        }
+        out[i + b->len] = (NadaLimb)carry;
+    }
+    big_adopt(r, out, len);
+}
+
+// Karatsuba: with a = a1*B + a0 and b = b1*B + b0,
+// a*b = a1*b1*B^2 + ((a0 + a1)(b0 + b1) - a0*b0 - a1*b1)*B + a0*b0
+static void mul_karatsuba(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    size_t m = (a->len + 1) / 2;
+    NadaBigInt a0 = big_slice(a, 0, m), a1 = big_slice(a, m, a->len);
+
+    if (b->len <= m) {
+        // Unbalanced: a*b = a1*b*B + a0*b
+        NadaBigInt high = NADA_BIG_INIT;
+        mul_into(r, &a0, b);
+        mul_into(&high, &a1, b);
+        add_shifted(r, &high, m);
+        nada_big_free(&high);
+        return;
+    }
+
+    NadaBigInt b0 = big_slice(b, 0, m), b1 = big_slice(b, m, b->len);
+    NadaBigInt z0 = NADA_BIG_INIT, z1 = NADA_BIG_INIT, z2 = NADA_BIG_INIT;
+    NadaBigInt sum_a = NADA_BIG_INIT, sum_b = NADA_BIG_INIT;
+
+    mul_into(&z0, &a0, &b0);
+    mul_into(&z2, &a1, &b1);
+    nada_big_add(&sum_a, &a0, &a1);
+    nada_big_add(&sum_b, &b0, &b1);
+    mul_into(&z1, &sum_a, &sum_b);
+    nada_big_sub(&z1, &z1, &z0);
+    nada_big_sub(&z1, &z1, &z2);
+
+    nada_big_swap(r, &z0);
+    add_shifted(r, &z1, m);
+    add_shifted(r, &z2, 2 * m);
+
+    nada_big_free(&z0);
+    nada_big_free(&z1);
+    nada_big_free(&z2);
+    nada_big_free(&sum_a);
+    nada_big_free(&sum_b);
+}
+
+// Values of x0 + x1*t + x2*t^2 at t = 1, -1 and -2
+static void toom3_evaluate(const NadaBigInt *x0, const NadaBigInt *x1, const NadaBigInt *x2,
+                           NadaBigInt *p1, SignedBig *pm1, SignedBig *pm2) {
+    NadaBigInt even = NADA_BIG_INIT;
+    nada_big_add(&even, x0, x2);
+    nada_big_add(p1, &even, x1);
+    signed_add(pm1, &even, 1, x1, -1);
+    nada_big_free(&even);
+
+    // p(-2) = 2*(p(-1) + x2) - x0
+    signed_add(pm2, &pm1->mag, pm1->sign, x2, 1);
+    nada_big_shl(&pm2->mag, &pm2->mag, 1);
+    signed_add(pm2, &pm2->mag, pm2->sign, x0, -1);
+}
+
+// Toom-3: split both operands in three, multiply the polynomials at
+// 0, 1, -1, -2 and infinity and interpolate (Bodrato's sequence)
+static void mul_toom3(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    size_t k = (a->len + 2) / 3;
+    NadaBigInt a0 = big_slice(a, 0, k), a1 = big_slice(a, k, k), a2 = big_slice(a, 2 * k, a->len);
+    NadaBigInt b0 = big_slice(b, 0, k), b1 = big_slice(b, k, k), b2 = big_slice(b, 2 * k, b->len);
+
+    NadaBigInt pa1 = NADA_BIG_INIT, pb1 = NADA_BIG_INIT;
+    SignedBig pam1 = {NADA_BIG_INIT, 1}, pam2 = {NADA_BIG_INIT, 1};
+    SignedBig pbm1 = {NADA_BIG_INIT, 1}, pbm2 = {NADA_BIG_INIT, 1};
+    toom3_evaluate(&a0, &a1, &a2, &pa1, &pam1, &pam2);
+    toom3_evaluate(&b0, &b1, &b2, &pb1, &pbm1, &pbm2);
+
+    NadaBigInt r0 = NADA_BIG_INIT, r1 = NADA_BIG_INIT, rinf = NADA_BIG_INIT, t = NADA_BIG_INIT;
+    SignedBig rm1 = {NADA_BIG_INIT, pam1.sign * pbm1.sign};
+    SignedBig rm2 = {NADA_BIG_INIT, pam2.sign * pbm2.sign};
+    mul_into(&r0, &a0, &b0);
+    mul_into(&r1, &pa1, &pb1);
+    mul_into(&rm1.mag, &pam1.mag, &pbm1.mag);
+    mul_into(&rm2.mag, &pam2.mag, &pbm2.mag);
+    mul_into(&rinf, &a2, &b2);
+
+    // Interpolate the middle coefficients; the divisions are exact
+    SignedBig c1 = {NADA_BIG_INIT, 1}, c2 = {NADA_BIG_INIT, 1}, c3 = {NADA_BIG_INIT, 1};
+    signed_add(&c3, &rm2.mag, rm2.sign, &r1, -1);  // c3 = (r(-2) - r(1)) / 3
+    nada_big_divmod_small(&c3.mag, &c3.mag, 3);
+    signed_add(&c1, &r1, 1, &rm1.mag, -rm1.sign);  // c1 = (r(1) - r(-1)) / 2
+    nada_big_shr(&c1.mag, &c1.mag, 1);
+    signed_add(&c2, &rm1.mag, rm1.sign, &r0, -1);  // c2 = r(-1) - r(0)
+    signed_add(&c3, &c2.mag, c2.sign, &c3.mag, -c3.sign);  // c3 = (c2 - c3) / 2 + 2 r(inf)
+    nada_big_shr(&c3.mag, &c3.mag, 1);
+    nada_big_shl(&t, &rinf, 1);
+    signed_add(&c3, &c3.mag, c3.sign, &t, 1);
+    signed_add(&c2, &c2.mag, c2.sign, &c1.mag, c1.sign);  // c2 = c2 + c1 - r(inf)
+    signed_add(&c2, &c2.mag, c2.sign, &rinf, -1);
+    signed_add(&c1, &c1.mag, c1.sign, &c3.mag, -c3.sign);  // c1 = c1 - c3
+
+    // The coefficients of a product of natural numbers are non-negative
+    nada_big_swap(r, &r0);
+    add_shifted(r, &c1.mag, k);
+    add_shifted(r, &c2.mag, 2 * k);
+    add_shifted(r, &c3.mag, 3 * k);
+    add_shifted(r, &rinf, 4 * k);
+
+    NadaBigInt *temps[] = {&pa1, &pb1, &pam1.mag, &pam2.mag, &pbm1.mag, &pbm2.mag, &r0, &r1,
+                           &rinf, &t, &rm1.mag, &rm2.mag, &c1.mag, &c2.mag, &c3.mag};
+    for (size_t i = 0; i < sizeof(temps) / sizeof(temps[0]); i++) {
+        nada_big_free(temps[i]);
+    }
+}
+
+// r = a * b; r must not alias a or b
+static void mul_into(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    if (a->len < b->len) {
+        const NadaBigInt *t = a;
+        a = b;
+        b = t;
+    }
+    if (b->len == 0) {
+        r->len = 0;
+    } else if (b->len < nada_big_karatsuba_threshold) {
+        mul_basecase(r, a, b);
+    } else if (b->len >= nada_big_toom3_threshold && b->len > 2 * ((a->len + 2) / 3)) {
+        mul_toom3(r, a, b);  // Needs all three parts of b
+    } else {
+        mul_karatsuba(r, a, b);
+    }
+}
+
+void nada_big_mul(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    // Multiply into a fresh value, so r may alias a or b
+    NadaBigInt product = NADA_BIG_INIT;
+    mul_into(&product, a, b);
+    nada_big_swap(r, &product);
+    nada_big_free(&product);
+}
+
+// Division: Knuth's Algorithm D (TAOCP 4.3.1) for multi-limb divisors, and
+// division by a Newton reciprocal once both the divisor and the quotient
+// reach nada_big_newton_threshold limbs, where the fast multiplications pay
+// for the extra work.
+
+size_t nada_big_newton_threshold = NADA_BIG_NEWTON_THRESHOLD;
+
+// Guard bits carried by the Newton reciprocal beyond the bits it must get right
+#define NEWTON_GUARD_BITS 64
+
+static void div_schoolbook(NadaBigInt *q, NadaBigInt *rem, const NadaBigInt *a, const NadaBigInt *b);
+
+static NadaLimb *big_alloc_limbs(size_t count) {
+    NadaLimb *limbs = malloc((count ? count : 1) * sizeof(NadaLimb));
+    if (limbs == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    return limbs;
+}
+
+// Algorithm D; requires b->len >= 2 and a >= b. The operands are copied
+// before q and rem are written, so those may alias a or b.
+static void div_knuth(NadaBigInt *q, NadaBigInt *rem, const NadaBigInt *a, const NadaBigInt *b) {
+    size_t n = b->len, m = a->len - n;
+    NadaLimb *u = big_alloc_limbs(a->len + 1);
+    NadaLimb *v = big_alloc_limbs(n);
+    NadaLimb *quot = big_alloc_limbs(m + 1);
+
+    // D1: normalize so that the top bit of the divisor is set
+    unsigned shift = (unsigned)__builtin_clz(b->limbs[n - 1]);
+    for (size_t i = n; i-- > 0;) {
+        NadaLimb low = i > 0 && shift ? b->limbs[i - 1] >> (NADA_LIMB_BITS - shift) : 0;
+        v[i] = (b->limbs[i] << shift) | low;
+    }
+    u[a->len] = shift ? a->limbs[a->len - 1] >> (NADA_LIMB_BITS - shift) : 0;
+    for (size_t i = a->len; i-- > 0;) {
+        NadaLimb low = i > 0 && shift ? a->limbs[i - 1] >> (NADA_LIMB_BITS - shift) : 0;
+        u[i] = (a->limbs[i] << shift) | low;
+    }
+
+    const NadaDLimb base = (NadaDLimb)1 << NADA_LIMB_BITS;
+    for (size_t j = m + 1; j-- > 0;) {
+        // D3: estimate the quotient limb from the top two limbs, then
+        // correct it with the third so it is at most one too large
+        NadaDLimb top = ((NadaDLimb)u[j + n] << NADA_LIMB_BITS) | u[j + n - 1];
+        NadaDLimb qhat = top / v[n - 1];
+        NadaDLimb rhat = top % v[n - 1];
+        while (qhat >= base || qhat * v[n - 2] > ((rhat << NADA_LIMB_BITS) | u[j + n - 2])) {
+            qhat--;
+            rhat += v[n - 1];
+            if (rhat >= base) break;
+        }
+
+        // D4: subtract qhat * v from the current window of u
+        int64_t borrow = 0, t;
+        for (size_t i = 0; i < n; i++) {
+            NadaDLimb p = qhat * v[i];
+            t = (int64_t)u[i + j] - borrow - (int64_t)(NadaLimb)p;
+            u[i + j] = (NadaLimb)t;
+            borrow = (int64_t)(p >> NADA_LIMB_BITS) - (t >> NADA_LIMB_BITS);
+        }
+        t = (int64_t)u[j + n] - borrow;
+        u[j + n] = (NadaLimb)t;
+
+        // D5/D6: if that went negative, qhat was one too large; add v back
+        if (t < 0) {
+            qhat--;
+            NadaDLimb carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                carry += (NadaDLimb)u[i + j] + v[i];
+                u[i + j] = (NadaLimb)carry;
+                carry >>= NADA_LIMB_BITS;
+            }
+            u[j + n] += (NadaLimb)carry;
+        }
+        quot[j] = (NadaLimb)qhat;
+    }
+
+    // D8: the remainder is the low n limbs of u, shifted back
+    if (rem) {
+        for (size_t i = 0; i < n; i++) {
+            NadaLimb high = shift ? u[i + 1] << (NADA_LIMB_BITS - shift) : 0;
+            u[i] = (u[i] >> shift) | high;
+        }
+        big_adopt(rem, u, n);
+    } else {
+        free(u);
+    }
+    if (q) {
+        big_adopt(q, quot, m + 1);
+    } else {
+        free(quot);
+    }
+    free(v);
+}
+
+// r = 2^bits
+static void big_power_of_two(NadaBigInt *r, size_t bits) {
+    nada_big_set_u64(r, 1);
+    nada_big_shl(r, r, bits);
+}
+
+// r ~ 2^e / b, never more than a few units off. Newton's iteration
+// x' = x + x * (2^e - b*x) / 2^e doubles the correct bits, so the
+// reciprocal is built from one of half the precision.
+static void newton_reciprocal(NadaBigInt *r, const NadaBigInt *b, size_t e) {
+    size_t b_bits = nada_big_bit_length(b);
+    size_t bits = e - b_bits;  // The result has bits + 1 bits
+
+    // Bits of b below the precision of the result do not matter
+    if (b_bits > bits + 2 * NEWTON_GUARD_BITS) {
+        size_t drop = b_bits - (bits + 2 * NEWTON_GUARD_BITS);
+        NadaBigInt top = NADA_BIG_INIT;
+        nada_big_shr(&top, b, drop);
+        newton_reciprocal(r, &top, e - drop);
+        nada_big_free(&top);
+        return;
+    }
+
+    NadaBigInt power = NADA_BIG_INIT;
+    big_power_of_two(&power, e);
+    if (bits < nada_big_newton_threshold * NADA_LIMB_BITS || bits <= 4 * NEWTON_GUARD_BITS) {
+        div_schoolbook(r, NULL, &power, b);  // Short quotient
+        nada_big_free(&power);
+        return;
+    }
+
+    // Half-precision start, scaled up to 2^e / b
+    size_t half = bits / 2 + NEWTON_GUARD_BITS;
+    NadaBigInt x = NADA_BIG_INIT, t = NADA_BIG_INIT;
+    newton_reciprocal(&x, b, b_bits + half);
+    nada_big_shl(&x, &x, bits - half);
+
+    // One Newton step at full precision
+    nada_big_mul(&t, b, &x);
+    bool below = nada_big_cmp(&t, &power) <= 0;
+    if (below) {
+        nada_big_sub(&t, &power, &t);
+    } else {
+        nada_big_sub(&t, &t, &power);
+    }
+    // The correction has about bits - half bits, so the low bits of its
+    // factors do not matter
+    size_t keep = bits - half + 2 * NEWTON_GUARD_BITS;
+    size_t t_drop = nada_big_bit_length(&t) > keep ? nada_big_bit_length(&t) - keep : 0;
+    size_t x_drop = nada_big_bit_length(&x) > keep ? nada_big_bit_length(&x) - keep : 0;
+    NadaBigInt x_top = NADA_BIG_INIT;
+    nada_big_shr(&x_top, &x, x_drop);
+    nada_big_shr(&t, &t, t_drop);
+    nada_big_mul(&t, &t, &x_top);
+    nada_big_shr(&t, &t, e - t_drop - x_drop);
+    nada_big_free(&x_top);
+    if (below) {
+        nada_big_add(r, &x, &t);
+    } else {
+        nada_big_add_small(&t, &t, 1);
+        if (nada_big_cmp(&x, &t) > 0) {
+            nada_big_sub(r, &x, &t);
+        } else {
+            r->len = 0;
+        }
+    }
+
+    nada_big_free(&power);
+    nada_big_free(&x);
+    nada_big_free(&t);
+}
+
+// Quotient from the reciprocal of b, then corrected with the exact
+// remainder. q and rem may alias a or b.
+static void div_newton(NadaBigInt *q, NadaBigInt *rem, const NadaBigInt *a, const NadaBigInt *b) {
+    size_t a_bits = nada_big_bit_length(a);
+    size_t b_bits = nada_big_bit_length(b);
+    NadaBigInt recip = NADA_BIG_INIT, quot = NADA_BIG_INIT, r = NADA_BIG_INIT, t = NADA_BIG_INIT;
+
+    // quot = a * (2^a_bits / b) / 2^a_bits, using only the top bits of a
+    size_t drop = b_bits > 2 * NEWTON_GUARD_BITS ? b_bits - 2 * NEWTON_GUARD_BITS : 0;
+    newton_reciprocal(&recip, b, a_bits);
+    nada_big_shr(&t, a, drop);
+    nada_big_mul(&quot, &t, &recip);
+    nada_big_shr(&quot, &quot, a_bits - drop);
+
+    // The estimate is off by a few units at most; fix it with a short division
+    nada_big_mul(&t, &quot, b);
+    if (nada_big_cmp(&t, a) <= 0) {
+        nada_big_sub(&r, a, &t);
+        if (nada_big_cmp(&r, b) >= 0) {
+            div_schoolbook(&t, &r, &r, b);
+            nada_big_add(&quot, &quot, &t);
+        }
+    } else {
+        // Too large: step back by ceil((quot * b - a) / b)
+        nada_big_sub(&t, &t, a);
+        div_schoolbook(&t, &r, &t, b);
+        if (!nada_big_is_zero(&r)) {
+            nada_big_add_small(&t, &t, 1);
+            nada_big_sub(&r, b, &r);
+        }
+        nada_big_sub(&quot, &quot, &t);
+    }
+
+    if (q) nada_big_swap(q, &quot);
+    if (rem) nada_big_swap(rem, &r);
+    nada_big_free(&recip);
+    nada_big_free(&quot);
+    nada_big_free(&r);
+    nada_big_free(&t);
+}
+
+NadaLimb nada_big_divmod_small(NadaBigInt *q, const NadaBigInt *a, NadaLimb d) {
+    size_t alen = a->len;
+    if (q) big_reserve(q, alen);
+
+    NadaDLimb rem = 0;
+    for (size_t i = alen; i-- > 0;) {
+        rem = (rem << NADA_LIMB_BITS) | a->limbs[i];
+        if (q) q->limbs[i] = (NadaLimb)(rem / d);
+        rem %= d;
+    }
+    if (q) {
+        q->len = alen;
+        big_trim(q);
+    }
+    return (NadaLimb)rem;
+}
+
+// Division without the Newton reciprocal; q and rem may alias a or b
+static void div_schoolbook(NadaBigInt *q, NadaBigInt *rem, const NadaBigInt *a, const NadaBigInt *b) {
+    if (nada_big_cmp(a, b) < 0) {
+        if (rem) nada_big_set(rem, a);
+        if (q) q->len = 0;
+        return;
+    }
+
+    if (b->len == 1) {
+        NadaLimb r = nada_big_divmod_small(q, a, b->limbs[0]);
+        if (rem) nada_big_set_u64(rem, r);
+        return;
+    }
+
+    div_knuth(q, rem, a, b);
+}
+
+void nada_big_divmod(NadaBigInt *q, NadaBigInt *rem, const NadaBigInt *a, const NadaBigInt *b) {
+    // Newton only pays off when both the divisor and the quotient are long
+    if (b->len >= nada_big_newton_threshold && a->len > b->len + nada_big_newton_threshold) {
+        div_newton(q, rem, a, b);
+    } else {
+        div_schoolbook(q, rem, a, b);
+    }
+}
+
+// The 64 bits of a starting at bit shift
+static uint64_t big_bits_at(const NadaBigInt *a, size_t shift) {
+    size_t limb = shift / NADA_LIMB_BITS;
+    unsigned bit = shift % NADA_LIMB_BITS;
+    uint64_t bits = 0;
+    for (size_t i = 0; i < 3 && limb + i < a->len; i++) {
+        NadaDLimb v = a->limbs[limb + i];
+        if (i == 0) {
+            bits |= v >> bit;
+        } else {
+            bits |= v << (i * NADA_LIMB_BITS - bit);
+        }
+    }
+    return bits;
+}
+
+// r = cu * u - cv * v for cofactors below 2^30, where the result is known
+// to be non-negative; r must not alias u or v
+static void lehmer_combine(NadaBigInt *r, const NadaBigInt *u, uint64_t cu, const NadaBigInt *v, uint64_t cv) {
+    size_t len = u->len > v->len ? u->len : v->len;
+    big_reserve(r, len);
+    int64_t carry = 0;
+    for (size_t i = 0; i < len; i++) {
+        int64_t t = carry;
+        if (i < u->len) t += (int64_t)(cu * u->limbs[i]);
+        if (i < v->len) t -= (int64_t)(cv * v->limbs[i]);
+        r->limbs[i] = (NadaLimb)t;
+        carry = t >> NADA_LIMB_BITS;  // Arithmetic shift keeps the borrow
+    }
+    r->len = len;
+    big_trim(r);
+}
+
+// Lehmer's algorithm: run Euclid on the leading 60 bits of x and y with
+// single-word cofactors, and apply the accumulated steps to the full
+// numbers at once. Each pass removes about 30 bits at the cost of two
+// linear combinations instead of one long division per quotient.
+void nada_big_gcd(NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    NadaBigInt x = NADA_BIG_INIT, y = NADA_BIG_INIT, t = NADA_BIG_INIT, u = NADA_BIG_INIT;
+    nada_big_set(&x, a);
+    nada_big_set(&y, b);
+    if (nada_big_cmp(&x, &y) < 0) nada_big_swap(&x, &y);
+
+    while (!nada_big_is_zero(&y)) {
+        uint64_t xw, yw;
+        if (nada_big_to_u64(&x, &xw)) {
+            nada_big_to_u64(&y, &yw);
+            nada_big_set_u64(&x, nada_big_gcd_u64(xw, yw));
+            break;
+        }
+
+        // Leading 60 bits of x and the bits of y at the same position
+        size_t shift = nada_big_bit_length(&x) - 60;
+        xw = big_bits_at(&x, shift);
+        yw = big_bits_at(&y, shift);
+
+        // Simulate Euclid while the quotients are certain (Jebelean's
+        // condition keeps every cofactor below 2^30)
+        int64_t xs = (int64_t)xw, ys = (int64_t)yw;
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        int steps = 0;
+        while (ys != C) {
+            int64_t q = (xs + (A - 1)) / (ys - C);
+            int64_t s = B + q * D;
+            int64_t w = xs - q * ys;
+            if (s > w) break;
+            xs = ys;
+            ys = w;
+            w = A + q * C;
+            A = D;
+            B = C;
+            C = s;
+            D = w;
+            steps++;
+        }
+
+        if (steps == 0) {
+            // No progress on the leading bits: take one full Euclid step
+            nada_big_divmod(NULL, &t, &x, &y);
+            nada_big_swap(&x, &y);
+            nada_big_swap(&y, &t);
+            continue;
+        }
+
+        // x, y = A*y - B*x, D*x - C*y after an odd number of steps,
+        //        A*x - B*y, D*y - C*x after an even number
+        if (steps & 1) {
+            lehmer_combine(&t, &y, (uint64_t)A, &x, (uint64_t)B);
+            lehmer_combine(&u, &x, (uint64_t)D, &y, (uint64_t)C);
+        } else {
+            lehmer_combine(&t, &x, (uint64_t)A, &y, (uint64_t)B);
+            lehmer_combine(&u, &y, (uint64_t)D, &x, (uint64_t)C);
+        }
+        nada_big_swap(&x, &t);
+        nada_big_swap(&y, &u);
+    }
+
+    nada_big_swap(r, &x);
+    nada_big_free(&x);
+    nada_big_free(&y);
+    nada_big_free(&t);
+    nada_big_free(&u);
+}
+
+// Powers: left-to-right square-and-multiply, so the squarings use the fast
+// multiplication and the multiplies by the base stay unbalanced and cheap
+
+void nada_big_pow(NadaBigInt *r, const NadaBigInt *a, uint64_t e) {
+    if (e == 0) {
+        nada_big_set_u64(r, 1);
+        return;
+    }
+    if (a->len == 0) {
+        r->len = 0;
+        return;
+    }
+
+    // (2^k * b)^e = b^e * 2^(k*e): factors of two become a single shift
+    size_t zeros = 0;
+    while (a->limbs[zeros / NADA_LIMB_BITS] == 0) {
+        zeros += NADA_LIMB_BITS;
+    }
+    zeros += (size_t)__builtin_ctz(a->limbs[zeros / NADA_LIMB_BITS]);
+
+    NadaBigInt base = NADA_BIG_INIT, result = NADA_BIG_INIT;
+    nada_big_shr(&base, a, zeros);
+    nada_big_set(&result, &base);
+    for (int bit = 62 - __builtin_clzll(e); bit >= 0; bit--) {
+        nada_big_mul(&result, &result, &result);
+        if ((e >> bit) & 1) {
+            nada_big_mul(&result, &result, &base);
+        }
+    }
+    nada_big_shl(&result, &result, zeros * e);
+
+    nada_big_swap(r, &result);
+    nada_big_free(&base);
+    nada_big_free(&result);
+}
+
+// Modular exponentiation. Odd moduli use Montgomery multiplication, which
+// replaces the division after each product by limb-wise multiples of the
+// modulus; even moduli reduce each product with nada_big_divmod.
+
+typedef struct {
+    const NadaBigInt *mod;
+    bool montgomery;
+    NadaLimb inverse;    // -mod^-1 mod 2^NADA_LIMB_BITS
+    NadaLimb *scratch;   // mod->len + 2 limbs
+} ModContext;
+
+// r = a * b * 2^(-NADA_LIMB_BITS * n) mod m for a, b < m (CIOS method)
+static void montgomery_mul(ModContext *ctx, NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    const NadaLimb *m = ctx->mod->limbs;
+    size_t n = ctx->mod->len;
+    NadaLimb *t = ctx->scratch;
+    memset(t, 0, (n + 2) * sizeof(NadaLimb));
+
+    for (size_t i = 0; i < n; i++) {
+        // t += a * b[i]
+        NadaDLimb bi = i < b->len ? b->limbs[i] : 0;
+        NadaDLimb carry = 0;
+        for (size_t j = 0; j < n; j++) {
+            carry += (NadaDLimb)t[j] + (j < a->len ? a->limbs[j] * bi : 0);
+            t[j] = (NadaLimb)carry;
+            carry >>= NADA_LIMB_BITS;
+        }
+        carry += t[n];
+        t[n] = (NadaLimb)carry;
+        t[n + 1] = (NadaLimb)(carry >> NADA_LIMB_BITS);
+
+        // t = (t + q * m) / 2^NADA_LIMB_BITS, with q chosen to clear the low limb
+        NadaDLimb q = (NadaLimb)(t[0] * ctx->inverse);
+        carry = ((NadaDLimb)t[0] + q * m[0]) >> NADA_LIMB_BITS;
+        for (size_t j = 1; j < n; j++) {
+            carry += (NadaDLimb)t[j] + q * m[j];
+            t[j - 1] = (NadaLimb)carry;
+            carry >>= NADA_LIMB_BITS;
+        }
+        carry += t[n];
+        t[n - 1] = (NadaLimb)carry;
+        t[n] = t[n + 1] + (NadaLimb)(carry >> NADA_LIMB_BITS);
+    }
+
+    NadaBigInt result = {t, n + 1, n + 2};
+    big_trim(&result);
+    if (nada_big_cmp(&result, ctx->mod) >= 0) {
+        nada_big_sub(r, &result, ctx->mod);
+    } else {
+        nada_big_set(r, &result);
+    }
+}
+
+static void mod_mul(ModContext *ctx, NadaBigInt *r, const NadaBigInt *a, const NadaBigInt *b) {
+    if (ctx->montgomery) {
+        montgomery_mul(ctx, r, a, b);
+    } else {
+        nada_big_mul(r, a, b);
+        nada_big_divmod(NULL, r, r, ctx->mod);
+    }
+}
+
+// r = a mapped into the representation of ctx (a < mod)
+static void mod_enter(ModContext *ctx, NadaBigInt *r, const NadaBigInt *a) {
+    if (ctx->montgomery) {
+        nada_big_shl(r, a, ctx->mod->len * NADA_LIMB_BITS);
+        nada_big_divmod(NULL, r, r, ctx->mod);
+    } else {
+        nada_big_set(r, a);
+    }
+}
+
+void nada_big_powmod(NadaBigInt *r, const NadaBigInt *base, const NadaBigInt *exp, const NadaBigInt *mod) {
+    if (nada_big_is_one(mod)) {
+        r->len = 0;
+        return;
+    }
+
+    ModContext ctx = {mod, (mod->limbs[0] & 1) != 0, 0, NULL};
+    if (ctx.montgomery) {
+        // Newton's iteration for the inverse of an odd limb: each step
+        // doubles the number of correct low bits, starting from 3
+        NadaLimb inverse = mod->limbs[0];
+        for (int i = 0; i < 4; i++) {
+            inverse *= 2 - mod->limbs[0] * inverse;
+        }
+        ctx.inverse = -inverse;
+        ctx.scratch = big_alloc_limbs(mod->len + 2);
+    }
+
+    // Fixed-window exponentiation: table[i] = base^i, then per window of
+    // bits square `window` times and multiply by the table entry
+    size_t bits = nada_big_bit_length(exp);
+    int window = bits > 512 ? 5 : bits > 128 ? 4 : bits > 32 ? 3 : 1;
+    size_t table_size = (size_t)1 << window;
+    NadaBigInt table[32];
+    NadaBigInt acc = NADA_BIG_INIT, one = NADA_BIG_INIT;
+
+    nada_big_set_u64(&one, 1);
+    for (size_t i = 0; i < table_size; i++) {
+        nada_big_init(&table[i]);
+    }
+    mod_enter(&ctx, &table[0], &one);
+    nada_big_divmod(NULL, &acc, base, mod);
+    mod_enter(&ctx, &table[1], &acc);
+    for (size_t i = 2; i < table_size; i++) {
+        mod_mul(&ctx, &table[i], &table[i - 1], &table[1]);
+    }
+
+    nada_big_set(&acc, &table[0]);
+    size_t windows = (bits + window - 1) / window;
+    for (size_t w = windows; w-- > 0;) {
+        size_t digit = 0;
+        for (int k = window - 1; k >= 0; k--) {
+            size_t bit = w * window + k;
+            mod_mul(&ctx, &acc, &acc, &acc);
+            digit <<= 1;
+            if (bit < bits) digit |= (exp->limbs[bit / NADA_LIMB_BITS] >> (bit % NADA_LIMB_BITS)) & 1;
+        }
+        if (digit) mod_mul(&ctx, &acc, &acc, &table[digit]);
+    }
+
+    // Leave the Montgomery representation by multiplying with 1
+    if (ctx.montgomery) montgomery_mul(&ctx, &acc, &acc, &one);
+    nada_big_swap(r, &acc);
+
+    for (size_t i = 0; i < table_size; i++) {
+        nada_big_free(&table[i]);
+    }
+    nada_big_free(&acc);
+    nada_big_free(&one);
+    free(ctx.scratch);
+}
+
+// Roots: Newton's iteration x -> ((k - 1) x + a / x^(k - 1)) / k decreases
+// monotonically from any overestimate and stops at the floor of the root
+
+void nada_big_root(NadaBigInt *r, const NadaBigInt *a, uint64_t k) {
+    size_t bits = nada_big_bit_length(a);
+    if (k == 1 || bits <= 1) {
+        nada_big_set(r, a);
+        return;
+    }
+    if (k >= bits) {
+        // 2 <= a < 2^k, so 1 <= root < 2
+        nada_big_set_u64(r, 1);
+        return;
+    }
+
+    NadaBigInt x = NADA_BIG_INIT, y = NADA_BIG_INIT, t = NADA_BIG_INIT;
+    NadaBigInt km1 = NADA_BIG_INIT, kb = NADA_BIG_INIT;
+    nada_big_set_u64(&km1, k - 1);
+    nada_big_set_u64(&kb, k);
+
+    // 2^ceil(bits / k) exceeds the root
+    nada_big_set_u64(&x, 1);
+    nada_big_shl(&x, &x, (bits + k - 1) / k);
+    for (;;) {
+        nada_big_pow(&t, &x, k - 1);
+        nada_big_divmod(&t, NULL, a, &t);
+        nada_big_mul(&y, &x, &km1);
+        nada_big_add(&y, &y, &t);
+        nada_big_divmod(&y, NULL, &y, &kb);
+        if (nada_big_cmp(&y, &x) >= 0) break;
+        nada_big_swap(&x, &y);
+    }
+
+    nada_big_swap(r, &x);
+    nada_big_free(&x);
+    nada_big_free(&y);
+    nada_big_free(&t);
+    nada_big_free(&km1);
+    nada_big_free(&kb);
+}
+
+size_t nada_big_radix_threshold = NADA_BIG_RADIX_THRESHOLD;
+
+// Cache of 10^(9 * 2^k) for k < decimal_power_count, each the square of the
+// one before. The table only grows and lives as long as the process.
+#define DECIMAL_POWER_MAX 48
+static NadaBigInt decimal_powers[DECIMAL_POWER_MAX];
+static size_t decimal_power_count = 0;
+
+// 10^(9 * 2^k)
+static const NadaBigInt *decimal_power(size_t k) {
+    if (decimal_power_count == 0) {
+        nada_big_set_u64(&decimal_powers[0], DECIMAL_CHUNK);
+        decimal_power_count = 1;
+    }
+    while (decimal_power_count <= k) {
+        nada_big_mul(&decimal_powers[decimal_power_count], &decimal_powers[decimal_power_count - 1],
+                     &decimal_powers[decimal_power_count - 1]);
+        decimal_power_count++;
+    }
+    return &decimal_powers[k];
+}
+
+// Parse digits one limb-sized chunk at a time; quadratic in len
+static bool from_decimal_basecase(NadaBigInt *r, const char *digits, size_t len) {
+    r->len = 0;
+
+    // Consume the digits in chunks of nine; the first chunk takes the rest
+    size_t pos = 0;
+    size_t chunk = len % DECIMAL_CHUNK_DIGITS;
+    if (chunk == 0) chunk = DECIMAL_CHUNK_DIGITS;
+    while (pos < len) {
+        NadaLimb value = 0, scale = 1;
+        for (size_t i = 0; i < chunk; i++) {
+            char c = digits[pos + i];
+            if (c < '0' || c > '9') {
+                r->len = 0;
+                return false;
+            }
+            value = value * 10 + (NadaLimb)(c - '0');
+            scale *= 10;
+        }
+        nada_big_mul_small(r, r, scale);
+        nada_big_add_small(r, r, value);
+        pos += chunk;
+        chunk = DECIMAL_CHUNK_DIGITS;
+    }
+    return true;
+}
+
+bool nada_big_from_decimal(NadaBigInt *r, const char *digits, size_t len) {
+    if (len <= nada_big_radix_threshold * DECIMAL_CHUNK_DIGITS) {
+        return from_decimal_basecase(r, digits, len);
+    }
+
+    // Split off the low 9 * 2^k digits, the largest such block shorter than
+    // len, so high * 10^(9 * 2^k) + low needs one big multiplication
+    size_t k = 0;
+    while ((size_t)DECIMAL_CHUNK_DIGITS << (k + 1) < len) k++;
+    size_t low_len = (size_t)DECIMAL_CHUNK_DIGITS << k;
+
+    NadaBigInt high = NADA_BIG_INIT, low = NADA_BIG_INIT;
+    bool ok = nada_big_from_decimal(&high, digits, len - low_len) &&
+              nada_big_from_decimal(&low, digits + len - low_len, low_len);
+    if (ok) {
+        nada_big_mul(&high, &high, decimal_power(k));
+        nada_big_add(r, &high, &low);
+    } else {
+        r->len = 0;
+    }
+    nada_big_free(&high);
+    nada_big_free(&low);
+    return ok;
+}
+
+// Write a as exactly width digits, zero padded on the left; a must have
+// fewer digits. Quadratic in the length of a.
+static void to_decimal_basecase(const NadaBigInt *a, char *out, size_t width) {
+    NadaBigInt t = NADA_BIG_INIT;
+    nada_big_set(&t, a);
+    char *p = out + width;
+    while (t.len > 0) {
+        NadaLimb chunk = nada_big_divmod_small(&t, &t, DECIMAL_CHUNK);
+        for (int i = 0; i < DECIMAL_CHUNK_DIGITS && p > out; i++) {
+            *--p = (char)('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+    memset(out, '0', (size_t)(p - out));
+    nada_big_free(&t);
+}
+
+// Write a < 10^(9 * 2^k) as exactly 9 * 2^k digits by splitting it at
+// 10^(9 * 2^(k-1)) into halves that are converted independently
+static void to_decimal_split(const NadaBigInt *a, char *out, size_t k) {
+    size_t width = (size_t)DECIMAL_CHUNK_DIGITS << k;
+    if (k == 0 || a->len <= nada_big_radix_threshold) {
+        to_decimal_basecase(a, out, width);
+        return;
+    }
+
+    const NadaBigInt *power = decimal_power(k - 1);
+    if (nada_big_cmp(a, power) < 0) {
+        memset(out, '0', width / 2);
+        to_decimal_split(a, out + width / 2, k - 1);
+        return;
+    }
+
+    NadaBigInt high = NADA_BIG_INIT, low = NADA_BIG_INIT;
+    nada_big_divmod(&high, &low, a, power);
+    to_decimal_split(&high, out, k - 1);
+    to_decimal_split(&low, out + width / 2, k - 1);
+    nada_big_free(&high);
+    nada_big_free(&low);
+}
+
+char *nada_big_to_decimal(const NadaBigInt *a) {
+    if (a->len == 0) return strdup("0");
+
+    // Smallest block of 9 * 2^k digits that holds a (log10(2) < 0.30103)
+    size_t digits = (size_t)((double)nada_big_bit_length(a) * 0.30103) + 1;
+    size_t k = 0;
+    while ((size_t)DECIMAL_CHUNK_DIGITS << k < digits) k++;
+
+    size_t width = (size_t)DECIMAL_CHUNK_DIGITS << k;
+    char *result = malloc(width + 1);
+    if (!result) return NULL;
+    to_decimal_split(a, result, k);
+    result[width] = '\0';
+
+    // Drop the zero padding
+    size_t skip = strspn(result, "0");
+    memmove(result, result + skip, width - skip + 1);
+    return result;
+}
+
+double nada_big_to_double_exp(const NadaBigInt *a, long *exp) {
+    // The top three limbs hold more bits than a double's mantissa
+    size_t skip = a->len > 3 ? a->len - 3 : 0;
+    double m = 0.0;
+    for (size_t i = a->len; i-- > skip;) {
+        m = m * 4294967296.0 + a->limbs[i];
+    }
+    *exp = (long)(skip * NADA_LIMB_BITS);
+    return m;
+}
@@ -42,9 +42,7 @@ NadaValue *builtin_or(NadaValue *args, NadaEnv *env) {
         // If truthy (anything except #f or nil), short-circuit and return it
         if (!(result->type == NADA_BOOL && result->data.boolean == 0) &&
             !(result->type == NADA_NIL)) {
-            NadaValue *result_copy = nada_deep_copy(result);
-            nada_free(result);
-            return result_copy;
+            return result;
         }
 
         // Otherwise, move to next argument
@@ -52,9 +50,7 @@ NadaValue *builtin_or(NadaValue *args, NadaEnv *env) {
     }
 
     // All arguments were falsy, return the last result (which is falsy)
-    NadaValue *result_copy = nada_deep_copy(result);
-    nada_free(result);
-    return result_copy;
+    return result;
 }
 
 // Built-in special form: and
@@ -78,9 +74,7 @@ NadaValue *builtin_and(NadaValue *args, NadaEnv *env) {
         // If falsy (#f or nil), short-circuit and return it
         if ((result->type == NADA_BOOL && result->data.boolean == 0) ||
             (result->type == NADA_NIL)) {
-            NadaValue *result_copy = nada_deep_copy(result);
-            nada_free(result);
-            return result_copy;
+            return result;
         }
 
         // Otherwise, move to next argument
@@ -88,7 +82,5 @@ NadaValue *builtin_and(NadaValue *args, NadaEnv *env) {
     }
 
     // All arguments were truthy, return the last result (which is truthy)
-    NadaValue *result_copy = nada_deep_copy(result);
-    nada_free(result);
-    return result_copy;
+    return result;
 }
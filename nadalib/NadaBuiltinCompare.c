@@ -179,8 +179,9 @@ NadaValue *builtin_eq(NadaValue *args, NadaEnv *env) {
     if (first->type == second->type) {
         switch (first->type) {
         case NADA_NUM:
-            // For rational numbers, compare using nada_num_equal
-            result = nada_num_equal(first->data.number, second->data.number);
+            // Numbers are eq? when they are equal and equally exact
+            result = nada_num_is_exact(first->data.number) == nada_num_is_exact(second->data.number) &&
+                     nada_num_equal(first->data.number, second->data.number);
             break;
         case NADA_BOOL:
             result = (first->data.boolean == second->data.boolean);
@@ -190,8 +191,8 @@ NadaValue *builtin_eq(NadaValue *args, NadaEnv *env) {
             result = (strcmp(first->data.string, second->data.string) == 0);
             break;
         case NADA_SYMBOL:
-            // Symbols with the same name are eq?
-            result = (strcmp(first->data.symbol, second->data.symbol) == 0);
+            // Symbols are interned: same name, same pointer
+            result = (first->data.symbol == second->data.symbol);
             break;
         case NADA_NIL:
             // All empty lists are eq?
@@ -222,13 +223,14 @@ int values_equal(NadaValue *a, NadaValue *b) {
 
     switch (a->type) {
     case NADA_NUM:
-        return nada_num_equal(a->data.number, b->data.number);
+        return nada_num_is_exact(a->data.number) == nada_num_is_exact(b->data.number) &&
+               nada_num_equal(a->data.number, b->data.number);
     case NADA_BOOL:
         return a->data.boolean == b->data.boolean;
     case NADA_STRING:
         return strcmp(a->data.string, b->data.string) == 0;
     case NADA_SYMBOL:
-        return strcmp(a->data.symbol, b->data.symbol) == 0;
+        return a->data.symbol == b->data.symbol;  // Interned
     case NADA_NIL:
         return 1;
     case NADA_PAIR:
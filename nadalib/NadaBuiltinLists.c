@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -5,6 +6,7 @@
 #include "NadaValue.h"
 #include "NadaEval.h"
 #include "NadaBuiltinLists.h"
+#include "NadaAnalyze.h"
 
 // Simple, straightforward car implementation
 NadaValue *builtin_car(NadaValue *args, NadaEnv *env) {
@@ -24,7 +26,7 @@ NadaValue *builtin_car(NadaValue *args, NadaEnv *env) {
     }
 
     // Return a copy of the car value
-    NadaValue *result = nada_deep_copy(arg->data.pair.car);
+    NadaValue *result = nada_retain(arg->data.pair.car);
     nada_free(arg);
     return result;
 }
@@ -44,7 +46,7 @@ NadaValue *builtin_cdr(NadaValue *args, NadaEnv *env) {
     }
 
     // Get the cdr and make a deep copy of it
-    NadaValue *result = nada_deep_copy(nada_cdr(arg));
+    NadaValue *result = nada_retain(nada_cdr(arg));
 
     // Free the evaluated argument
     nada_free(arg);
@@ -80,7 +82,7 @@ NadaValue *builtin_cadr(NadaValue *args, NadaEnv *env) {
     }
 
     // Get the car of cdr (second element)
-    NadaValue *result = nada_deep_copy(nada_car(cdr_val));
+    NadaValue *result = nada_retain(nada_car(cdr_val));
 
     // Clean up
     nada_free(list_arg);
@@ -126,7 +128,7 @@ NadaValue *builtin_caddr(NadaValue *args, NadaEnv *env) {
     }
 
     // Get the car of cdr of cdr (third element)
-    NadaValue *result = nada_deep_copy(nada_car(cddr_val));
+    NadaValue *result = nada_retain(nada_car(cddr_val));
 
     // Clean up
     nada_free(list_arg);
@@ -201,7 +203,7 @@ NadaValue *builtin_sublist(NadaValue *args, NadaEnv *env) {
     // Collect elements from start to end
     while (pos < end && !nada_is_nil(current) && current->type == NADA_PAIR) {
         // Get the current element and make a deep copy
-        NadaValue *element = nada_deep_copy(nada_car(current));
+        NadaValue *element = nada_retain(nada_car(current));
 
         // Create a new list with this element
         NadaValue *new_items = nada_cons(element, items);
@@ -276,7 +278,7 @@ NadaValue *builtin_list_ref(NadaValue *args, NadaEnv *env) {
     }
 
     // Return a copy of the element
-    NadaValue *result = nada_deep_copy(nada_car(current));
+    NadaValue *result = nada_retain(nada_car(current));
 
     // Clean up
     nada_free(list_arg);
@@ -300,7 +302,7 @@ NadaValue *map_car(NadaValue *args, NadaEnv *env) {
         return nada_create_nil();
     }
 
-    return nada_deep_copy(arg->data.pair.car);
+    return nada_retain(arg->data.pair.car);
 }
 
 NadaValue *map_cdr(NadaValue *args, NadaEnv *env) {
@@ -316,7 +318,7 @@ NadaValue *map_cdr(NadaValue *args, NadaEnv *env) {
         return nada_create_nil();
     }
 
-    return nada_deep_copy(arg->data.pair.cdr);
+    return nada_retain(arg->data.pair.cdr);
 }
 
 NadaValue *map_cadr(NadaValue *args, NadaEnv *env) {
@@ -340,7 +342,7 @@ NadaValue *map_cadr(NadaValue *args, NadaEnv *env) {
         return nada_create_nil();
     }
 
-    return nada_deep_copy(nada_car(cdr_val));
+    return nada_retain(nada_car(cdr_val));
 }
 
 NadaValue *map_caddr(NadaValue *args, NadaEnv *env) {
@@ -370,7 +372,7 @@ NadaValue *map_caddr(NadaValue *args, NadaEnv *env) {
         return nada_create_nil();
     }
 
-    return nada_deep_copy(nada_car(cddr_val));
+    return nada_retain(nada_car(cddr_val));
 }
 
 // Fixed map implementation that handles multiple lists correctly
@@ -454,14 +456,14 @@ NadaValue *builtin_map(NadaValue *args, NadaEnv *env) {
 
             if (func->data.function.builtin == builtin_car) {
                 if (element->type == NADA_PAIR) {
-                    mapped_result = nada_deep_copy(element->data.pair.car);
+                    mapped_result = nada_retain(element->data.pair.car);
                 } else {
                     nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "car called on non-pair");
                     mapped_result = nada_create_nil();
                 }
             } else if (func->data.function.builtin == builtin_cdr) {
                 if (element->type == NADA_PAIR) {
-                    mapped_result = nada_deep_copy(element->data.pair.cdr);
+                    mapped_result = nada_retain(element->data.pair.cdr);
                 } else {
                     nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "cdr called on non-pair");
                     mapped_result = nada_create_nil();
@@ -470,7 +472,7 @@ NadaValue *builtin_map(NadaValue *args, NadaEnv *env) {
                 if (element->type == NADA_PAIR) {
                     NadaValue *cdr_val = nada_cdr(element);
                     if (cdr_val->type == NADA_PAIR) {
-                        mapped_result = nada_deep_copy(nada_car(cdr_val));
+                        mapped_result = nada_retain(nada_car(cdr_val));
                     } else {
                         mapped_result = nada_create_nil();
                     }
@@ -483,7 +485,7 @@ NadaValue *builtin_map(NadaValue *args, NadaEnv *env) {
                     if (cdr_val->type == NADA_PAIR) {
                         NadaValue *cddr_val = nada_cdr(cdr_val);
                         if (cddr_val->type == NADA_PAIR) {
-                            mapped_result = nada_deep_copy(nada_car(cddr_val));
+                            mapped_result = nada_retain(nada_car(cddr_val));
                         } else {
                             mapped_result = nada_create_nil();
                         }
@@ -507,9 +509,6 @@ NadaValue *builtin_map(NadaValue *args, NadaEnv *env) {
     } else {
         // Regular case - for each position in the lists
         for (int i = 0; i < count; i++) {
-            // Create a custom environment for this function call
-            NadaEnv *call_env = nada_env_create(env);
-
             // For each list, get the ith element
             NadaValue *func_args = nada_create_nil();
             int all_lists_valid = 1;
@@ -523,7 +522,7 @@ NadaValue *builtin_map(NadaValue *args, NadaEnv *env) {
 
                 if (list_j->type == NADA_PAIR) {
                     // Extract the element at this position and add it to our args
-                    NadaValue *element = nada_deep_copy(nada_car(list_j));
+                    NadaValue *element = nada_retain(nada_car(list_j));
                     NadaValue *new_args = nada_cons(element, func_args);
                     nada_free(element);
                     nada_free(func_args);
@@ -536,47 +535,27 @@ NadaValue *builtin_map(NadaValue *args, NadaEnv *env) {
 
             if (!all_lists_valid) {
                 nada_free(func_args);
-                nada_env_release(call_env);
                 break;
             }
 
-            // If we have a lambda function, bind parameters directly
             NadaValue *mapped_result = NULL;
 
             if (func->data.function.builtin == NULL) {
-                // For user-defined lambda, bind parameters directly
-                NadaValue *params = func->data.function.params;
-                NadaValue *body = func->data.function.body;
-                NadaValue *current_param = params;
-                NadaValue *current_arg = func_args;
-
-                // Bind each parameter without re-evaluating
-                while (!nada_is_nil(current_param) && !nada_is_nil(current_arg)) {
-                    if (current_param->type != NADA_PAIR ||
-                        current_param->data.pair.car->type != NADA_SYMBOL) {
-                        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "invalid parameter list");
-                        mapped_result = nada_create_nil();
-                        break;
-                    }
-
-                    // Bind parameter directly to argument without evaluation
-                    nada_env_set(call_env,
-                                 current_param->data.pair.car->data.symbol,
-                                 nada_car(current_arg));
-
-                    // Move to next param and arg
-                    current_param = nada_cdr(current_param);
-                    current_arg = nada_cdr(current_arg);
+                // Closures run their analyzed body with the elements as arguments
+                NadaValue *inline_argv[8];
+                NadaValue **argv = list_count > 8 ? malloc(list_count * sizeof(NadaValue *))
+                                                  : inline_argv;
+                if (!argv) {
+                    fprintf(stderr, "Error: Out of memory\n");
+                    exit(1);
                 }
-
-                // Evaluate body expressions
-                mapped_result = nada_create_nil();
-                NadaValue *current_expr = body;
-
-                while (!nada_is_nil(current_expr)) {
-                    nada_free(mapped_result);
-                    mapped_result = nada_eval(nada_car(current_expr), call_env);
-                    current_expr = nada_cdr(current_expr);
+                int argc = 0;
+                for (NadaValue *a = func_args; a->type == NADA_PAIR; a = a->data.pair.cdr) {
+                    argv[argc++] = a->data.pair.car;
+                }
+                mapped_result = nada_apply_closure(func, argv, argc);
+                if (argv != inline_argv) {
+                    free(argv);
                 }
             } else {
                 // For built-in functions, use the builtin function directly
@@ -591,7 +570,6 @@ NadaValue *builtin_map(NadaValue *args, NadaEnv *env) {
 
             // Clean up
             nada_free(func_args);
-            nada_env_release(call_env);
         }
     }
 
@@ -1,59 +1,79 @@
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include "NadaEval.h"
 // #include "NadaNum.h"
 #include "NadaError.h"
 #include "NadaBuiltinMath.h"
 
-// Addition (+)
-NadaValue *builtin_add(NadaValue *args, NadaEnv *env) {
-    if (nada_is_nil(args)) {
-        return nada_create_num_from_int(0);
-    }
+// Evaluated arguments of an n-ary arithmetic builtin. Calls with up to
+// ARG_NUMBERS_INLINE arguments keep them in the struct and do not allocate.
+#define ARG_NUMBERS_INLINE 8
 
-    // Start with first argument
-    NadaValue *first_arg = nada_eval(nada_car(args), env);
-    if (first_arg->type != NADA_NUM) {
-        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "'+' requires number arguments");
-        nada_free(first_arg);
-        return nada_create_num_from_int(0);
-    }
+typedef struct {
+    size_t count;
+    NadaValue **values;
+    NadaNum **numbers;
+    NadaValue *inline_values[ARG_NUMBERS_INLINE];
+    NadaNum *inline_numbers[ARG_NUMBERS_INLINE];
+} ArgNumbers;
 
-    char *num_str = nada_num_to_string(first_arg->data.number);
-    free(num_str);
+static void free_arg_numbers(ArgNumbers *an) {
+    for (size_t i = 0; i < an->count; i++) {
+        nada_free(an->values[i]);
+    }
+    if (an->values != an->inline_values) {
+        free(an->values);
+        free(an->numbers);
+    }
+}
 
-    NadaNum *result = nada_num_copy(first_arg->data.number);
-    nada_free(first_arg);
+// Evaluate every argument; false after reporting an error if one is not a
+// number
+static bool eval_arg_numbers(ArgNumbers *an, NadaValue *args, NadaEnv *env, const char *op) {
+    size_t length = 0;
+    for (NadaValue *current = args; !nada_is_nil(current); current = nada_cdr(current)) {
+        length++;
+    }
+
+    an->count = 0;
+    an->values = an->inline_values;
+    an->numbers = an->inline_numbers;
+    if (length > ARG_NUMBERS_INLINE) {
+        an->values = malloc(length * sizeof(NadaValue *));
+        an->numbers = malloc(length * sizeof(NadaNum *));
+        if (!an->values || !an->numbers) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+    }
 
-    // Add the rest of the arguments
-    NadaValue *current = nada_cdr(args);
-    while (!nada_is_nil(current)) {
+    for (NadaValue *current = args; !nada_is_nil(current); current = nada_cdr(current)) {
         NadaValue *arg = nada_eval(nada_car(current), env);
+        an->values[an->count++] = arg;
         if (arg->type != NADA_NUM) {
-            nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "'+' requires number arguments");
-            nada_num_free(result);
-            nada_free(arg);
-            return nada_create_num_from_int(0);
+            nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "'%s' requires number arguments", op);
+            free_arg_numbers(an);
+            return false;
         }
+        an->numbers[an->count - 1] = arg->data.number;
+    }
+    return true;
+}
 
-        char *arg_str = nada_num_to_string(arg->data.number);
-        free(arg_str);
-
-        NadaNum *temp = nada_num_add(result, arg->data.number);
-
-        char *temp_str = nada_num_to_string(temp);
-        free(temp_str);
-
-        nada_num_free(result);
-        result = temp;
-
-        nada_free(arg);
-        current = nada_cdr(current);
+// Addition (+): all terms are summed in one accumulator
+NadaValue *builtin_add(NadaValue *args, NadaEnv *env) {
+    ArgNumbers an;
+    if (!eval_arg_numbers(&an, args, env, "+")) {
+        return nada_create_num_from_int(0);
     }
 
-    NadaValue *val = nada_create_num(result);
-    nada_num_free(result);
+    NadaNum *sum = nada_num_sum(an.numbers, an.count);
+    free_arg_numbers(&an);
+
+    NadaValue *val = nada_create_num(sum);
+    nada_num_free(sum);
     return val;
 }
 
@@ -107,45 +127,18 @@ NadaValue *builtin_subtract(NadaValue *args, NadaEnv *env) {
     return val;
 }
 
-// Multiplication (*)
+// Multiplication (*): all factors are multiplied in one accumulator
 NadaValue *builtin_multiply(NadaValue *args, NadaEnv *env) {
-    if (nada_is_nil(args)) {
-        // Multiplication with no args is 1
-        return nada_create_num_from_int(1);
-    }
-
-    // Start with first argument
-    NadaValue *first_arg = nada_eval(nada_car(args), env);
-    if (first_arg->type != NADA_NUM) {
-        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "'*' requires number arguments");
-        nada_free(first_arg);
+    ArgNumbers an;
+    if (!eval_arg_numbers(&an, args, env, "*")) {
         return nada_create_num_from_int(0);
     }
 
-    NadaNum *result = nada_num_copy(first_arg->data.number);
-    nada_free(first_arg);
+    NadaNum *product = nada_num_product(an.numbers, an.count);
+    free_arg_numbers(&an);
 
-    // Multiply by the rest of the arguments
-    NadaValue *current = nada_cdr(args);
-    while (!nada_is_nil(current)) {
-        NadaValue *arg = nada_eval(nada_car(current), env);
-        if (arg->type != NADA_NUM) {
-            nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "'*' requires number arguments");
-            nada_num_free(result);
-            nada_free(arg);
-            return nada_create_num_from_int(0);
-        }
-
-        NadaNum *temp = nada_num_multiply(result, arg->data.number);
-        nada_num_free(result);
-        result = temp;
-
-        nada_free(arg);
-        current = nada_cdr(current);
-    }
-
-    NadaValue *val = nada_create_num(result);
-    nada_num_free(result);
+    NadaValue *val = nada_create_num(product);
+    nada_num_free(product);
     return val;
 }
 
@@ -169,8 +162,8 @@ NadaValue *builtin_divide(NadaValue *args, NadaEnv *env) {
 
     NadaValue *rest = nada_cdr(args);
     if (nada_is_nil(rest)) {
-        // Unary division (1/x)
-        if (nada_num_is_zero(result)) {
+        // Unary division (1/x); an inexact zero gives an infinity
+        if (nada_num_is_zero(result) && nada_num_is_exact(result)) {
             nada_report_error(NADA_ERROR_DIVISION_BY_ZERO, "division by zero");
             nada_num_free(result);
             return nada_create_num_from_int(0);
@@ -196,7 +189,7 @@ NadaValue *builtin_divide(NadaValue *args, NadaEnv *env) {
             return nada_create_num_from_int(0);
         }
 
-        if (nada_num_is_zero(arg->data.number)) {
+        if (nada_num_is_zero(arg->data.number) && nada_num_is_exact(arg->data.number)) {
             nada_report_error(NADA_ERROR_DIVISION_BY_ZERO, "division by zero");
             nada_num_free(result);
             nada_free(arg);
@@ -318,6 +311,17 @@ NadaValue *builtin_expt(NadaValue *args, NadaEnv *env) {
         return nada_create_nil();
     }
 
+    // An inexact operand makes the result inexact, so any real exponent works
+    if (!nada_num_is_exact(base->data.number) || !nada_num_is_exact(exponent->data.number)) {
+        NadaNum *power = nada_num_from_double(
+            pow(nada_num_to_double(base->data.number), nada_num_to_double(exponent->data.number)));
+        NadaValue *result = nada_create_num(power);
+        nada_num_free(power);
+        nada_free(base);
+        nada_free(exponent);
+        return result;
+    }
+
     // Use encapsulated functions instead of direct structure access
     if (!nada_num_is_integer(exponent->data.number)) {
         nada_report_error(NADA_ERROR_INVALID_ARGUMENT,
@@ -330,8 +334,14 @@ NadaValue *builtin_expt(NadaValue *args, NadaEnv *env) {
     // Perform exponentiation - letting NadaNum handle all internal checks
     NadaNum *result_num = NULL;
 
-    // Convert to integer using nada_num API
-    int exp_int = nada_num_to_int(exponent->data.number);
+    // Exponents beyond int would not fit in memory for any other base
+    int exp_int;
+    if (!nada_num_fits_int(exponent->data.number, &exp_int)) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "expt: exponent too large");
+        nada_free(base);
+        nada_free(exponent);
+        return nada_create_nil();
+    }
 
     // Call exponentiation function which should handle all error cases internally
     result_num = nada_num_int_expt(base->data.number, exp_int);
@@ -357,6 +367,106 @@ NadaValue *builtin_expt(NadaValue *args, NadaEnv *env) {
     return result;
 }
 
+// Built-in function: expt-mod (modular exponentiation)
+NadaValue *builtin_expt_mod(NadaValue *args, NadaEnv *env) {
+    if (nada_is_nil(args) || nada_is_nil(nada_cdr(args)) || nada_is_nil(nada_cdr(nada_cdr(args))) ||
+        !nada_is_nil(nada_cdr(nada_cdr(nada_cdr(args))))) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "expt-mod requires exactly 3 arguments");
+        return nada_create_nil();
+    }
+
+    NadaValue *base = nada_eval(nada_car(args), env);
+    NadaValue *exponent = nada_eval(nada_car(nada_cdr(args)), env);
+    NadaValue *modulus = nada_eval(nada_car(nada_cdr(nada_cdr(args))), env);
+
+    if (base->type != NADA_NUM || exponent->type != NADA_NUM || modulus->type != NADA_NUM) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "expt-mod arguments must be numbers");
+        nada_free(base);
+        nada_free(exponent);
+        nada_free(modulus);
+        return nada_create_nil();
+    }
+
+    // Reduces after every product, so the full power is never formed
+    NadaNum *result_num = nada_num_expt_mod(base->data.number, exponent->data.number, modulus->data.number);
+
+    nada_free(base);
+    nada_free(exponent);
+    nada_free(modulus);
+
+    if (result_num == NULL) {
+        // Error already reported by nada_num_expt_mod
+        return nada_create_nil();
+    }
+
+    NadaValue *result = nada_create_num(result_num);
+    nada_num_free(result_num);
+    return result;
+}
+
+// Integer root of n for the builtin name, or nil after reporting why
+// there is none
+static NadaValue *exact_integer_root_value(const char *name, const NadaNum *n, int k) {
+    if (!nada_num_is_exact(n) || !nada_num_is_integer(n) || nada_num_is_negative(n)) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "%s requires a non-negative exact integer", name);
+        return nada_create_nil();
+    }
+    if (k < 1) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "%s requires a positive root index", name);
+        return nada_create_nil();
+    }
+
+    NadaNum *root = nada_num_exact_integer_root(n, k);
+    NadaValue *result = nada_create_num(root);
+    nada_num_free(root);
+    return result;
+}
+
+// Built-in function: exact-integer-sqrt
+NadaValue *builtin_exact_integer_sqrt(NadaValue *args, NadaEnv *env) {
+    if (nada_is_nil(args) || !nada_is_nil(nada_cdr(args))) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "exact-integer-sqrt requires exactly one argument");
+        return nada_create_nil();
+    }
+
+    NadaValue *arg = nada_eval(nada_car(args), env);
+    if (arg->type != NADA_NUM) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "exact-integer-sqrt argument must be a number");
+        nada_free(arg);
+        return nada_create_nil();
+    }
+
+    NadaValue *result = exact_integer_root_value("exact-integer-sqrt", arg->data.number, 2);
+    nada_free(arg);
+    return result;
+}
+
+// Built-in function: exact-integer-root
+NadaValue *builtin_exact_integer_root(NadaValue *args, NadaEnv *env) {
+    if (nada_is_nil(args) || nada_is_nil(nada_cdr(args)) || !nada_is_nil(nada_cdr(nada_cdr(args)))) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "exact-integer-root requires exactly 2 arguments");
+        return nada_create_nil();
+    }
+
+    NadaValue *n = nada_eval(nada_car(args), env);
+    NadaValue *k = nada_eval(nada_car(nada_cdr(args)), env);
+    int k_int;
+    if (n->type != NADA_NUM || k->type != NADA_NUM) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "exact-integer-root arguments must be numbers");
+        nada_free(n);
+        nada_free(k);
+        return nada_create_nil();
+    }
+    if (!nada_num_fits_int(k->data.number, &k_int)) {
+        k_int = 0;  // Reported as an invalid root index
+    }
+
+    NadaValue *result = exact_integer_root_value("exact-integer-root", n->data.number, k_int);
+    nada_free(n);
+    nada_free(k);
+    return result;
+}
+
 // Return the numerator of a rational number
 NadaValue *builtin_numerator(NadaValue *args, NadaEnv *env) {
     // Check argument count
@@ -432,7 +542,7 @@ NadaValue *builtin_denominator(NadaValue *args, NadaEnv *env) {
     }
 
     // Create a new number with the denominator
-    NadaNum *num = nada_num_from_int(atoi(denom_str));
+    NadaNum *num = nada_num_from_fraction(denom_str, "1");
     free(denom_str);
     nada_free(arg);
 
@@ -567,3 +677,40 @@ NadaValue *builtin_factor(NadaValue *args, NadaEnv *env) {
     nada_free(arg);
     return result;
 }
+
+// Convert the single numeric argument with convert, reporting as name
+static NadaValue *convert_exactness(NadaValue *args, NadaEnv *env, const char *name,
+                                    NadaNum *(*convert)(const NadaNum *)) {
+    if (nada_is_nil(args) || !nada_is_nil(nada_cdr(args))) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "%s requires exactly one argument", name);
+        return nada_create_nil();
+    }
+
+    NadaValue *arg = nada_eval(nada_car(args), env);
+    if (arg->type != NADA_NUM) {
+        nada_report_error(NADA_ERROR_TYPE_ERROR, "%s requires a number argument", name);
+        nada_free(arg);
+        return nada_create_nil();
+    }
+
+    NadaNum *num = convert(arg->data.number);
+    nada_free(arg);
+    if (!num) {
+        // Error already reported by the conversion
+        return nada_create_nil();
+    }
+
+    NadaValue *result = nada_create_num(num);
+    nada_num_free(num);
+    return result;
+}
+
+// Convert a number to the nearest flonum (exact->inexact, inexact)
+NadaValue *builtin_exact_to_inexact(NadaValue *args, NadaEnv *env) {
+    return convert_exactness(args, env, "exact->inexact", nada_num_to_inexact);
+}
+
+// Convert a flonum to the rational with the same value (inexact->exact, exact)
+NadaValue *builtin_inexact_to_exact(NadaValue *args, NadaEnv *env) {
+    return convert_exactness(args, env, "inexact->exact", nada_num_to_exact);
+}
@@ -1,6 +1,7 @@
 #include "NadaEval.h"
 #include "NadaError.h"
 #include "NadaBuiltinPredicates.h"
+#include "NadaAnalyze.h"
 
 // Empty list test (null?)
 NadaValue *builtin_null(NadaValue *args, NadaEnv *env) {
@@ -43,6 +44,32 @@ NadaValue *builtin_number_p(NadaValue *args, NadaEnv *env) {
     return nada_create_bool(result);
 }
 
+// Exact number predicate (exact?)
+NadaValue *builtin_exact_p(NadaValue *args, NadaEnv *env) {
+    if (nada_is_nil(args) || !nada_is_nil(nada_cdr(args))) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "exact? requires exactly 1 argument");
+        return nada_create_bool(0);
+    }
+
+    NadaValue *val = nada_eval(nada_car(args), env);
+    int result = (val->type == NADA_NUM && nada_num_is_exact(val->data.number));
+    nada_free(val);
+    return nada_create_bool(result);
+}
+
+// Inexact number predicate (inexact?)
+NadaValue *builtin_inexact_p(NadaValue *args, NadaEnv *env) {
+    if (nada_is_nil(args) || !nada_is_nil(nada_cdr(args))) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "inexact? requires exactly 1 argument");
+        return nada_create_bool(0);
+    }
+
+    NadaValue *val = nada_eval(nada_car(args), env);
+    int result = (val->type == NADA_NUM && !nada_num_is_exact(val->data.number));
+    nada_free(val);
+    return nada_create_bool(result);
+}
+
 // String predicate (string?)
 NadaValue *builtin_string_p(NadaValue *args, NadaEnv *env) {
     if (nada_is_nil(args) || !nada_is_nil(nada_cdr(args))) {
@@ -89,7 +116,7 @@ NadaValue *builtin_defined_p(NadaValue *args, NadaEnv *env) {
     nada_set_silent_symbol_lookup(1);
 
     // Try to get the symbol
-    NadaValue *val = nada_env_get(env, symbol->data.symbol, 1);
+    NadaValue *val = nada_env_get_symbol(env, symbol->data.symbol, 1);
 
     // Restore original silent setting
     nada_set_silent_symbol_lookup(was_silent);
@@ -188,8 +215,11 @@ NadaValue *builtin_error_p(NadaValue *args, NadaEnv *env) {
         return nada_create_bool(0);
     }
 
+    // A recursion depth error in the argument stops unwinding here
+    int outer = nada_catch_begin();
     NadaValue *val = nada_eval(nada_car(args), env);
-    int result = (val->type == NADA_ERROR);
+    bool caught = nada_catch_end(outer);
+    int result = caught || val->type == NADA_ERROR;
     nada_free(val);
     return nada_create_bool(result);
 }
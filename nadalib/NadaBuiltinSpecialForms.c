@@ -3,6 +3,8 @@
 
 #include "NadaEval.h"
 #include "NadaError.h"
+#include "NadaSymbol.h"
+#include "NadaAnalyze.h"
 #include "NadaBuiltinSpecialForms.h"
 
 // Recursively check for and fix references to a specific environment
@@ -38,8 +40,20 @@ NadaValue *builtin_quote(NadaValue *args, NadaEnv *env) {
         return nada_create_nil();
     }
 
-    // Return unevaluated argument (make a deep copy to prevent modification)
-    return nada_deep_copy(nada_car(args));
+    // Return unevaluated argument (shared, values are immutable)
+    return nada_retain(nada_car(args));
+}
+
+// Bind name in env to a new closure over env
+void nada_define_closure(NadaEnv *env, const char *name, NadaValue *params, NadaValue *body, NadaCode *code) {
+    NadaValue *func = nada_make_closure(params, body, code, env);
+    nada_env_set_symbol(env, name, func);
+
+    // Free the original function value *after* it's been copied and stored.
+    // The copy in the binding holds its own reference to env, so once the
+    // frame's other holders are gone the closure is its last reference and
+    // nada_env_release breaks the cycle.
+    nada_free(func);
 }
 
 // Built-in special form: define
@@ -57,7 +71,7 @@ NadaValue *builtin_define(NadaValue *args, NadaEnv *env) {
         // This is the existing implementation
         NadaValue *val_expr = nada_car(nada_cdr(args));
         NadaValue *val = nada_eval(val_expr, env);
-        nada_env_set(env, first->data.symbol, val);
+        nada_env_set_symbol(env, first->data.symbol, val);
         nada_free(val);  // Free the value after it's been stored
         return nada_create_symbol(first->data.symbol);
     }
@@ -73,23 +87,8 @@ NadaValue *builtin_define(NadaValue *args, NadaEnv *env) {
         // Extract body (rest of the args)
         NadaValue *body = nada_cdr(args);
 
-        // Create a function value
-        NadaValue *func = nada_create_function(
-            nada_deep_copy(params),
-            nada_deep_copy(body),
-            env);
-
-        // Bind function to name
-        nada_env_set(env, func_name->data.symbol, func);
-
-        // Free the original function value *after* it's been copied and stored.
-        // Temporarily NULL the env pointer to prevent premature release of the
-        // environment, which is now correctly referenced by the copy in the binding.
-        if (func->type == NADA_FUNC) {  // Safety check
-            // We don't need to save/restore, just prevent release during this free
-            func->data.function.env = NULL;
-        }
-        nada_free(func);  // Free the original func value
+        // Create the function and bind it to its name
+        nada_define_closure(env, func_name->data.symbol, params, body, NULL);
 
         // Return the function name
         return nada_create_symbol(func_name->data.symbol);
@@ -182,12 +181,8 @@ NadaValue *builtin_lambda(NadaValue *args, NadaEnv *env) {
     // The rest is the function body
     NadaValue *body = nada_cdr(args);
 
-    // Create and return a new function value
-    return nada_create_function(
-        nada_deep_copy(params),
-        nada_deep_copy(body),
-        env  // Capture the current environment
-    );
+    // Create and return a new function value, capturing the current environment
+    return nada_make_closure(params, body, NULL, env);
 }
 
 NadaValue *builtin_if(NadaValue *args, NadaEnv *env) {
@@ -206,11 +201,9 @@ NadaValue *builtin_if(NadaValue *args, NadaEnv *env) {
     nada_free(condition);
 
     if (is_true) {
-        // Evaluate and return a deep copy of the then-expression
+        // Evaluate and return the then-expression
         NadaValue *then_result = nada_eval(nada_car(nada_cdr(args)), env);
-        NadaValue *result_copy = nada_deep_copy(then_result);
-        nada_free(then_result);
-        return result_copy;
+        return then_result;
     } else {
         // Check if we have an else expression
         NadaValue *else_part = nada_cdr(nada_cdr(args));
@@ -219,9 +212,7 @@ NadaValue *builtin_if(NadaValue *args, NadaEnv *env) {
         }
         // Evaluate the else-expression
         NadaValue *else_result = nada_eval(nada_car(else_part), env);
-        NadaValue *result_copy = nada_deep_copy(else_result);
-        nada_free(else_result);
-        return result_copy;
+        return else_result;
     }
 }
 
@@ -251,7 +242,7 @@ NadaValue *builtin_cond(NadaValue *args, NadaEnv *env) {
 
         // Handle 'else' keyword (must be the last clause)
         int is_else = (condition->type == NADA_SYMBOL &&
-                       strcmp(condition->data.symbol, "else") == 0);
+                       condition->data.symbol == nada_intern("else"));
 
         if (is_else) {
             // Verify this is the last clause
@@ -274,13 +265,10 @@ NadaValue *builtin_cond(NadaValue *args, NadaEnv *env) {
             while (!nada_is_nil(body)) {
                 nada_free(result);
 
-                // Get a deep copy of the evaluated expression
                 result = nada_eval(nada_car(body), env);
                 if (nada_is_nil(nada_cdr(body))) {
-                    // If this is the last body expression, return a deep copy
-                    NadaValue *result_copy = nada_deep_copy(result);
-                    nada_free(result);
-                    return result_copy;
+                    // If this is the last body expression, return its value
+                    return result;
                 }
                 body = nada_cdr(body);
             }
@@ -313,13 +301,10 @@ NadaValue *builtin_cond(NadaValue *args, NadaEnv *env) {
             while (!nada_is_nil(body)) {
                 nada_free(result);
 
-                // Get a deep copy of the evaluated expression
                 result = nada_eval(nada_car(body), env);
                 if (nada_is_nil(nada_cdr(body))) {
-                    // If this is the last body expression, return a deep copy
-                    NadaValue *result_copy = nada_deep_copy(result);
-                    nada_free(result);
-                    return result_copy;
+                    // If this is the last body expression, return its value
+                    return result;
                 }
                 body = nada_cdr(body);
             }
@@ -335,6 +320,45 @@ NadaValue *builtin_cond(NadaValue *args, NadaEnv *env) {
     return nada_create_nil();
 }
 
+// Release the environment of a let once its body has produced result.
+// Closures bound in it or returned from it are pointed at its parent, so no
+// cycle keeps it alive. A named let holds one extra reference on let_env.
+NadaValue *nada_release_let_env(NadaEnv *let_env, NadaValue *result, bool named) {
+#ifdef NADA_ENABLE_GC
+    // Closures that captured let_env keep it alive on their own, cycles
+    // through the loop function are left to the collector
+    nada_env_release(let_env);
+    if (named) {
+        nada_env_release(let_env);
+    }
+    return result;
+#else
+    (void)named;
+
+    // Make a copy of the result to return
+    NadaValue *result_copy = nada_retain(result);
+    nada_free(result);
+
+    // Before releasing let_env, find and fix circular references
+    nada_env_redirect_closures(let_env, let_env->parent);
+
+    // Also check if the result directly contains a function that references let_env
+    if (result_copy->type == NADA_FUNC && result_copy->data.function.env == let_env) {
+        // Replace with parent environment
+        result_copy->data.function.env = let_env->parent;
+        if (let_env->parent) {
+            nada_env_add_ref(let_env->parent);
+        }
+    }
+
+    // Drop every reference at once, including the extra one of a named let
+    let_env->ref_count = 1;
+    nada_env_release(let_env);
+
+    return result_copy;
+#endif
+}
+
 // Built-in special form: let (with support for named let)
 NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
     // Check for at least one argument
@@ -378,7 +402,7 @@ NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
             const char *var_name = nada_car(binding)->data.symbol;
             NadaValue *val_expr = nada_car(nada_cdr(binding));
             NadaValue *val = nada_eval(val_expr, env);
-            nada_env_set(loop_env, var_name, val);
+            nada_env_set_symbol(loop_env, var_name, val);
             if (val->type == NADA_ERROR) {   // Check for eval errors
                 nada_env_release(loop_env);  // Release extra scope ref
                 nada_env_release(loop_env);  // Release initial ref
@@ -392,45 +416,18 @@ NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
         NadaValue *params = nada_create_nil();
         current_binding = bindings;  // Reset to start of bindings
         while (!nada_is_nil(current_binding)) {
-            NadaValue *binding = nada_car(current_binding);
-            NadaValue *param_symbol = nada_car(binding);
-            // Need deep copy here as original symbols are part of bindings list
-            NadaValue *param_symbol_copy = nada_deep_copy(param_symbol);
-            NadaValue *new_params = nada_cons(param_symbol_copy, params);
-            nada_free(param_symbol_copy);  // Cons creates its own copy
-            nada_free(params);             // Free the old list head
-            params = new_params;           // Update params to point to the new list
+            NadaValue *new_params = nada_cons(nada_car(nada_car(current_binding)), params);
+            nada_free(params);
+            params = new_params;
             current_binding = nada_cdr(current_binding);
         }
-        // params is now the reversed list of parameter symbols
-
         NadaValue *reversed_params = nada_reverse(params);  // Reverse to get correct order
-        // Free the original reversed list (now pointed to by 'params')
-        // before assigning the newly created correct-order list.
         nada_free(params);
-        params = reversed_params;  // 'params' now holds the correct list
-
-        // Create the loop function capturing the loop environment
-        // Pass ownership of params and body copy to the function
-        NadaValue *loop_func = nada_create_function(
-            params,  // Pass params directly
-            nada_deep_copy(body),
-            loop_env  // Capture the current environment (adds ref)
-        );
-        // params list is now owned by loop_func, don't free here
-
-        // Bind the loop function to its name *within* the loop environment
-        // nada_env_set handles the self-reference ref count adjustment
-        nada_env_set(loop_env, func_name, loop_func);
-
-        // Free the original loop_func value created above, *after* it's been copied.
-        // Temporarily NULL the env pointer to prevent premature release of the
-        // environment, which is now correctly referenced by the copy in the binding.
-        if (loop_func->type == NADA_FUNC) {  // Safety check
-            // We don't need to save/restore, just prevent release during this free
-            loop_func->data.function.env = NULL;
-        }
-        nada_free(loop_func);  // Free the original loop_func value
+        params = reversed_params;
+
+        // Bind the loop function, capturing the loop environment, to its name
+        nada_define_closure(loop_env, func_name, params, body, NULL);
+        nada_free(params);
 
         // Evaluate body
         NadaValue *result = nada_create_nil();
@@ -439,8 +436,6 @@ NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
             nada_free(result);  // Free previous result
             result = nada_eval(nada_car(current_expr), loop_env);
             if (result->type == NADA_ERROR) {  // Check for eval errors in body
-                                               // Error occurred, result holds the error value.
-                                               // Need to release env before returning.
                 nada_env_release(loop_env);    // Release our scope reference
                 nada_env_release(loop_env);    // Release the 'extra' scope
                 return result;                 // Propagate error
@@ -448,44 +443,7 @@ NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
             current_expr = nada_cdr(current_expr);
         }
 
-        // Make a copy of the result to return
-        NadaValue *result_copy = nada_deep_copy(result);
-        nada_free(result);
-
-        // Before releasing loop_env, find and fix circular references
-        struct NadaBinding *binding = loop_env->bindings;
-        while (binding != NULL) {
-            if (binding->value && binding->value->type == NADA_FUNC &&
-                binding->value->data.function.env == loop_env) {
-                // printf("Breaking circular reference in let-bound function: %s\n", binding->name);
-
-                // Set function's env pointer to parent env and increment parent's ref count
-                binding->value->data.function.env = loop_env->parent;
-                if (loop_env->parent) {
-                    nada_env_add_ref(loop_env->parent);
-                }
-            }
-            binding = binding->next;
-        }
-
-        // Also check if the result directly contains a function that references loop_env
-        if (result_copy->type == NADA_FUNC && result_copy->data.function.env == loop_env) {
-            // Replace with parent environment
-            result_copy->data.function.env = loop_env->parent;
-            if (loop_env->parent) {
-                nada_env_add_ref(loop_env->parent);
-            }
-        }
-
-        loop_env->ref_count = 1;
-
-        // fix_env_references(result_copy, loop_env, loop_env->parent);
-
-        // Release loop_env correctly - both references
-        // nada_env_release(loop_env);  // Release initial reference
-        nada_env_release(loop_env);  // Release extra reference added earlier
-
-        return result_copy;
+        return nada_release_let_env(loop_env, result, true);
     } else {
         // Regular let
         NadaValue *bindings = first_arg;
@@ -496,8 +454,6 @@ NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
 
         // Create a new environment
         NadaEnv *let_env = nada_env_create(env);
-
-        // IMPORTANT: Define the body - this was missing!
         NadaValue *body = nada_cdr(args);
 
         // Evaluate binding expressions in the original env
@@ -517,7 +473,7 @@ NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
             NadaValue *val_expr = nada_car(nada_cdr(binding));
             NadaValue *val = nada_eval(val_expr, env);
 
-            nada_env_set(let_env, var_name, val);
+            nada_env_set_symbol(let_env, var_name, val);
             if (val->type == NADA_ERROR) {
                 nada_env_release(let_env);  // Release env before returning
                 return val;                 // Propagate error
@@ -542,43 +498,7 @@ NadaValue *builtin_let(NadaValue *args, NadaEnv *env) {
             body_expr = nada_cdr(body_expr);
         }
 
-        // Make a copy of the result to return
-        NadaValue *result_copy = nada_deep_copy(result);
-        nada_free(result);
-
-        // Before releasing let_env, find and fix circular references
-        struct NadaBinding *binding = let_env->bindings;
-        while (binding != NULL) {
-            if (binding->value && binding->value->type == NADA_FUNC &&
-                binding->value->data.function.env == let_env) {
-                // printf("Breaking circular reference in let-bound function: %s\n", binding->name);
-
-                // Set function's env pointer to parent env and increment parent's ref count
-                binding->value->data.function.env = let_env->parent;
-                if (let_env->parent) {
-                    nada_env_add_ref(let_env->parent);
-                }
-            }
-            binding = binding->next;
-        }
-
-        // Also check if the result directly contains a function that references let_env
-        if (result_copy->type == NADA_FUNC && result_copy->data.function.env == let_env) {
-            // Replace with parent environment
-            result_copy->data.function.env = let_env->parent;
-            if (let_env->parent) {
-                nada_env_add_ref(let_env->parent);
-            }
-        }
-
-        let_env->ref_count = 1;
-
-        // fix_env_references(result_copy, let_env, let_env->parent);
-
-        // Release let_env correctly - don't manually set ref_count
-        nada_env_release(let_env);
-
-        return result_copy;
+        return nada_release_let_env(let_env, result, false);
     }
 }
 
@@ -624,27 +544,8 @@ NadaValue *builtin_set(NadaValue *args, NadaEnv *env) {
     // Evaluate the value expression
     NadaValue *val = nada_eval(nada_car(nada_cdr(args)), env);
 
-    // Find the binding in the environment (could be in parent environments)
-    NadaEnv *current_env = env;
-    int found = 0;
-
-    while (current_env != NULL) {
-        // Check if the variable exists in this environment
-        struct NadaBinding *binding = current_env->bindings;
-        while (binding != NULL) {
-            if (strcmp(binding->name, var->data.symbol) == 0) {
-                // Found the binding, update it
-                nada_free(binding->value);
-                binding->value = nada_deep_copy(val);
-                found = 1;
-                break;
-            }
-            binding = binding->next;
-        }
-
-        if (found) break;
-        current_env = current_env->parent;
-    }
+    // Update the binding in the environment (could be in parent environments)
+    int found = nada_env_assign_symbol(env, var->data.symbol, val);
 
     if (!found) {
         nada_report_error(NADA_ERROR_UNDEFINED_SYMBOL, "set! variable '%s' not found", var->data.symbol);
@@ -697,7 +598,7 @@ NadaValue *builtin_apply(NadaValue *args, NadaEnv *env) {
         } else {
             // Try environment lookup
             nada_free(eval_func_val);
-            true_func = nada_env_get(env, symbol_name, 0);
+            true_func = nada_env_get_symbol(env, symbol_name, 0);
         }
     } else {
         // Not a function or symbol - clean up and report error
@@ -790,10 +691,14 @@ NadaValue *builtin_for_each(NadaValue *args, NadaEnv *env) {
         current_arg_ptr = nada_cdr(current_arg_ptr);
     }
 
-    // Create pointers to track current position in each list
+    // Create pointers to track current position in each list, and the
+    // elements at that position
     NadaValue **current_positions = malloc(list_count * sizeof(NadaValue *));
-    if (!current_positions) {
+    NadaValue **elements = malloc(list_count * sizeof(NadaValue *));
+    if (!current_positions || !elements) {
         nada_report_error(NADA_ERROR_OUT_OF_MEMORY, "Out of memory in for-each");
+        free(current_positions);
+        free(elements);
         nada_free(func);
         for (int i = 0; i < list_count; i++) {
             nada_free(list_args[i]);
@@ -828,6 +733,7 @@ NadaValue *builtin_for_each(NadaValue *args, NadaEnv *env) {
         // Create arguments list (in reverse order)
         for (int i = list_count - 1; i >= 0; i--) {
             NadaValue *element = nada_car(current_positions[i]);
+            elements[i] = element;
             NadaValue *new_args = nada_cons(element, call_args);
             nada_free(call_args);
             call_args = new_args;
@@ -838,40 +744,8 @@ NadaValue *builtin_for_each(NadaValue *args, NadaEnv *env) {
 
         // Use appropriate method to call function depending on type
         if (func->data.function.builtin == NULL) {
-            // For user-defined functions, create environment & bind args
-            NadaEnv *call_env = nada_env_create(func->data.function.env);
-
-            // Bind parameters to arguments
-            NadaValue *params = func->data.function.params;
-            NadaValue *current_param = params;
-            NadaValue *current_arg = call_args;
-
-            while (!nada_is_nil(current_param) && !nada_is_nil(current_arg)) {
-                if (current_param->type != NADA_PAIR ||
-                    current_param->data.pair.car->type != NADA_SYMBOL) {
-                    break;
-                }
-
-                nada_env_set(call_env,
-                             current_param->data.pair.car->data.symbol,
-                             nada_car(current_arg));
-
-                current_param = nada_cdr(current_param);
-                current_arg = nada_cdr(current_arg);
-            }
-
-            // Evaluate function body
-            result = nada_create_nil();
-            NadaValue *body = func->data.function.body;
-            NadaValue *current_expr = body;
-
-            while (!nada_is_nil(current_expr)) {
-                nada_free(result);
-                result = nada_eval(nada_car(current_expr), call_env);
-                current_expr = nada_cdr(current_expr);
-            }
-
-            nada_env_release(call_env);
+            // Closures run their analyzed body with the elements as arguments
+            result = nada_apply_closure(func, elements, list_count);
         } else {
             // For built-in functions, call directly
             result = func->data.function.builtin(call_args, env);
@@ -889,6 +763,7 @@ NadaValue *builtin_for_each(NadaValue *args, NadaEnv *env) {
 
     // Clean up
     free(current_positions);
+    free(elements);
     for (int i = 0; i < list_count; i++) {
         nada_free(list_args[i]);
     }
@@ -1,16 +1,41 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 #include "NadaEnv.h"
 #include "NadaEval.h"
 #include "NadaError.h"
+#include "NadaPool.h"
+#include "NadaSymbol.h"
+#include "NadaGC.h"
+#include "NadaAnalyze.h"
 
 static int env_id_counter = 0;
 
 // Set this to true to see detailed environment operations
 static bool show_env_debug = false;
 
+// The global environment: the top-level environment created last. Each of
+// its bindings is also the value cell of its name (NadaSymbolDispatch.global),
+// so globals are found without searching its bindings. Other top-level
+// environments are searched like any frame.
+static NadaEnv *global_cells_env = NULL;
+
+static struct NadaBinding **global_cell(const char *sym) {
+    return &nada_symbol_dispatch(sym)->global;
+}
+
+// Make env the global environment, taking the cells from the previous one
+static void claim_global_cells(NadaEnv *env) {
+    if (global_cells_env != NULL) {
+        for (struct NadaBinding *b = global_cells_env->bindings; b != NULL; b = b->next) {
+            *global_cell(b->name) = NULL;
+        }
+    }
+    global_cells_env = env;
+}
+
 // Increment the reference count for an environment
 void nada_env_add_ref(NadaEnv *env) {
     if (!env) return;
@@ -34,31 +59,14 @@ void nada_env_release(NadaEnv *env) {
         if (show_env_debug) printf(")\n");
 
         nada_env_free(env);
-    } else if (env->ref_count == 1) {
+    }
+#ifndef NADA_ENABLE_GC
+    else if (env->ref_count == 1) {
         // If down to the last reference, check for potential circular references
         if (show_env_debug) printf("ENV FINAL REF CHECK #%d\n", env->id);
 
-        // Check for any circular references in bindings
-        int found_circular = 0;
-        struct NadaBinding *binding = env->bindings;
-        while (binding != NULL) {
-            if (binding->value && binding->value->type == NADA_FUNC &&
-                binding->value->data.function.env == env) {
-                if (show_env_debug) printf("Breaking circular reference in env #%d function: %s\n",
-                                           env->id, binding->name);
-
-                // Break the circular reference
-                binding->value->data.function.env = env->parent;
-
-                // Add reference to parent if it exists
-                if (env->parent) {
-                    nada_env_add_ref(env->parent);
-                }
-
-                found_circular = 1;
-            }
-            binding = binding->next;
-        }
+        // Break circular references through closures over this environment
+        bool found_circular = nada_env_redirect_closures(env, env->parent);
 
         // If we found and broke a circular reference, force cleanup
         if (found_circular) {
@@ -68,15 +76,24 @@ void nada_env_release(NadaEnv *env) {
             nada_env_free(env);
         }
     }
+#endif
 }
 
 // Create a new environment
 NadaEnv *nada_env_create(NadaEnv *parent) {
-    NadaEnv *env = malloc(sizeof(NadaEnv));
+    // Cycles are only reclaimed by the collector, give it a chance to run
+    nada_gc_maybe_collect();
+
+    NadaEnv *env = nada_pool_alloc(NADA_POOL_ENV);
     env->bindings = NULL;
     env->parent = parent;
+    env->layout = NULL;
+    env->slots = NULL;
     env->ref_count = 1;          // Start with ref count of 1
     env->id = ++env_id_counter;  // Assign unique ID
+    if (parent == NULL) {
+        claim_global_cells(env);
+    }
 
     if (show_env_debug) printf("ENV CREATE #%d (parent: %s) ref=%d\n",
                                env->id,
@@ -88,6 +105,89 @@ NadaEnv *nada_env_create(NadaEnv *parent) {
         nada_env_add_ref(parent);
     }
 
+    nada_gc_register_env(env);
+    return env;
+}
+
+NadaFrameLayout *nada_layout_create(NadaFrameLayout *parent) {
+    NadaFrameLayout *layout = malloc(sizeof(NadaFrameLayout));
+    if (layout == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    layout->ref_count = 1;
+    layout->count = 0;
+    layout->names = NULL;
+    layout->parent = nada_layout_retain(parent);
+    return layout;
+}
+
+static void note_binding(const char *sym, NadaValue *value);
+
+int nada_layout_add(NadaFrameLayout *layout, const char *sym) {
+    for (int i = 0; i < layout->count; i++) {
+        if (layout->names[i] == sym) return i;
+    }
+    // Frames give the name a meaning of its own, as binding it would
+    note_binding(sym, NULL);
+
+    const char **names = realloc(layout->names, (layout->count + 1) * sizeof(const char *));
+    if (names == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    layout->names = names;
+    layout->names[layout->count] = sym;
+    return layout->count++;
+}
+
+NadaFrameLayout *nada_layout_retain(NadaFrameLayout *layout) {
+    if (layout != NULL) {
+        layout->ref_count++;
+    }
+    return layout;
+}
+
+void nada_layout_release(NadaFrameLayout *layout) {
+    while (layout != NULL && --layout->ref_count == 0) {
+        NadaFrameLayout *parent = layout->parent;
+        free(layout->names);
+        free(layout);
+        layout = parent;
+    }
+}
+
+void nada_resolve_var(NadaVarRef *ref, NadaFrameLayout *layout, const char *sym) {
+    ref->sym = sym;
+    ref->layout = layout;
+    ref->depth = 0;
+    ref->index = -1;
+    for (; layout != NULL; layout = layout->parent, ref->depth++) {
+        for (int i = 0; i < layout->count; i++) {
+            if (layout->names[i] == sym) {
+                ref->index = i;
+                return;
+            }
+        }
+    }
+}
+
+// Create an environment with unbound slots for layout
+NadaEnv *nada_env_create_frame(NadaEnv *parent, NadaFrameLayout *layout) {
+    NadaEnv *env = nada_env_create(parent);
+    env->layout = nada_layout_retain(layout);
+    if (layout->count <= NADA_INLINE_SLOTS) {
+        env->slots = env->inline_slots;
+    } else {
+        env->slots = malloc(layout->count * sizeof(NadaValue *));
+        if (env->slots == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < layout->count; i++) {
+        env->slots[i] = NULL;
+    }
     return env;
 }
 
@@ -105,151 +205,327 @@ void nada_env_free(NadaEnv *env) {
         printf(")\n");
     }
 
+#ifndef NADA_ENABLE_GC
     // First pass: break circular references in functions
-    struct NadaBinding *binding = env->bindings;
-    while (binding) {
-        if (binding->value && binding->value->type == NADA_FUNC) {
-            // Break the circular reference by nulling out the env pointer
-            binding->value->data.function.env = NULL;
+    nada_env_redirect_closures(env, NULL);
+#endif
+
+    // Second pass: now free the values
+    nada_env_clear(env);
+    if (env == global_cells_env) {
+        global_cells_env = NULL;
+    }
+
+    nada_gc_unregister_env(env);
+    nada_pool_free(NADA_POOL_ENV, env);
+}
+
+// Drop all bindings and the parent reference
+void nada_env_clear(NadaEnv *env) {
+    if (env->layout != NULL) {
+        for (int i = 0; i < env->layout->count; i++) {
+            nada_free(env->slots[i]);
         }
-        binding = binding->next;
+        if (env->slots != env->inline_slots) {
+            free(env->slots);
+        }
+        nada_layout_release(env->layout);
+        env->layout = NULL;
+        env->slots = NULL;
     }
 
-    // Second pass: now free the values
-    binding = env->bindings;
+    struct NadaBinding *binding = env->bindings;
+    env->bindings = NULL;
     while (binding) {
         struct NadaBinding *next = binding->next;
-        free(binding->name);
+        if (env == global_cells_env) {
+            *global_cell(binding->name) = NULL;
+        }
         if (binding->value) {
             nada_free(binding->value);
             binding->value = NULL;
         }
-        free(binding);
+        nada_pool_free(NADA_POOL_BINDING, binding);
         binding = next;
     }
 
     // Release parent environment
     if (env->parent) {
-        nada_env_release(env->parent);
+        NadaEnv *parent = env->parent;
         env->parent = NULL;
+        nada_env_release(parent);
     }
+}
 
-    free(env);
+bool nada_env_redirect_closures(NadaEnv *env, NadaEnv *target) {
+    bool found = false;
+    int slot_count = env->layout != NULL ? env->layout->count : 0;
+    for (int i = 0; i < slot_count; i++) {
+        NadaValue *value = env->slots[i];
+        if (value && value->type == NADA_FUNC && value->data.function.env == env) {
+            if (show_env_debug) printf("Redirecting closure in env #%d: %s\n", env->id, env->layout->names[i]);
+            value->data.function.env = target;
+            nada_env_add_ref(target);
+            found = true;
+        }
+    }
+    for (struct NadaBinding *binding = env->bindings; binding != NULL; binding = binding->next) {
+        if (binding->value && binding->value->type == NADA_FUNC &&
+            binding->value->data.function.env == env) {
+            if (show_env_debug) printf("Redirecting closure in env #%d: %s\n", env->id, binding->name);
+            binding->value->data.function.env = target;
+            nada_env_add_ref(target);
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Reference held by a binding. Top-level bindings live long, so their
+// values are moved out of the nursery.
+static NadaValue *bind_value(NadaEnv *env, NadaValue *value) {
+    return env->parent == NULL ? nada_promote(value) : nada_retain(value);
+}
+
+// Builtins are dispatched by name until some environment gives the name
+// another meaning; from then on calls look it up (see nada_eval)
+static void note_binding(const char *sym, NadaValue *value) {
+    NadaSymbolDispatch *dispatch = nada_symbol_dispatch(sym);
+    if (dispatch->rebound) return;
+    if (dispatch->builtin == NULL || value == NULL || value->type != NADA_FUNC ||
+        value->data.function.builtin != dispatch->builtin) {
+        dispatch->rebound = true;
+    }
 }
 
 // Add a binding to the environment
 void nada_env_set(NadaEnv *env, const char *name, NadaValue *value) {
-    // Check if symbol already exists
-    struct NadaBinding *current = env->bindings;
-    while (current != NULL) {
-        if (strcmp(current->name, name) == 0) {
-            // Free the old value before replacing it
-
-            // Break circular references if the old value is a function
-            // that refers to this environment
-            if (current->value && current->value->type == NADA_FUNC &&
-                current->value->data.function.env == env) {
-                current->value->data.function.env = NULL;  // Break cycle before freeing
-            }
+    nada_env_set_symbol(env, nada_intern(name), value);
+}
 
-            nada_free(current->value);
+// Slot of env for sym, NULL if it has none
+static NadaValue **find_slot(NadaEnv *env, const char *sym) {
+    if (env->layout == NULL) return NULL;
+    for (int i = 0; i < env->layout->count; i++) {
+        if (env->layout->names[i] == sym) {
+            return &env->slots[i];
+        }
+    }
+    return NULL;
+}
 
-            // Store a copy of the value (so caller can free original)
-            current->value = nada_deep_copy(value);
+// Value held by env itself for sym: its slot or its binding
+static NadaValue **find_local(NadaEnv *env, const char *sym) {
+    NadaValue **slot = find_slot(env, sym);
+    if (slot != NULL) return slot;
+    if (env == global_cells_env) {
+        struct NadaBinding *cell = *global_cell(sym);
+        return cell != NULL ? &cell->value : NULL;
+    }
+    for (struct NadaBinding *current = env->bindings; current != NULL; current = current->next) {
+        if (current->name == sym) {
+            return &current->value;
+        }
+    }
+    return NULL;
+}
 
-            // Special case for functions defined in this environment:
-            // If we're storing a function that references this same environment,
-            // decrement the reference count to avoid cycles
-            if (current->value->type == NADA_FUNC &&
-                current->value->data.function.env == env) {
-                env->ref_count--;  // Cancel out the extra reference
-            }
+// Add a binding for an interned name
+void nada_env_set_symbol(NadaEnv *env, const char *sym, NadaValue *value) {
+    note_binding(sym, value);
 
-            return;
+    // Check if symbol already exists; an unbound slot is bound like a new name
+    NadaValue **place = find_local(env, sym);
+    if (place != NULL && *place == NULL) {
+        *place = bind_value(env, value);
+        return;
+    }
+    if (place != NULL) {
+        // Free the old value before replacing it
+        NadaValue *old_value = *place;
+
+#ifndef NADA_ENABLE_GC
+        // Break circular references if the old value is a function
+        // that refers to this environment
+        if (old_value && old_value->type == NADA_FUNC &&
+            old_value->data.function.env == env) {
+            old_value->data.function.env = NULL;  // Break cycle before freeing
+        }
+#endif
+
+        // Take a reference to the value (so caller can free original)
+        *place = bind_value(env, value);
+        nada_free(old_value);
+
+#ifndef NADA_ENABLE_GC
+        // Special case for functions defined in this environment:
+        // If we're storing a function that references this same environment,
+        // decrement the reference count to avoid cycles
+        if ((*place)->type == NADA_FUNC && (*place)->data.function.env == env) {
+            env->ref_count--;  // Cancel out the extra reference
         }
-        current = current->next;
+#endif
+
+        return;
     }
 
     // Add new binding
-    struct NadaBinding *new_binding = malloc(sizeof(struct NadaBinding));
-    new_binding->name = strdup(name);
-    new_binding->value = nada_deep_copy(value);
+    struct NadaBinding *new_binding = nada_pool_alloc(NADA_POOL_BINDING);
+    new_binding->name = sym;
+    new_binding->value = bind_value(env, value);
     new_binding->next = env->bindings;  // Add to front of list
     env->bindings = new_binding;
+    if (env == global_cells_env) {
+        *global_cell(sym) = new_binding;
+    }
 }
 
-// Look up a binding in the environment
-NadaValue *nada_env_get(NadaEnv *env, const char *name, int silent) {
-    // Search in current environment
-    struct NadaBinding *current = env->bindings;
-    while (current != NULL) {
-        if (strcmp(current->name, name) == 0) {
-            // Return a deep copy of the value, not the original!
-            return nada_deep_copy(current->value);
+// Find the value bound to an interned name in env or its parents
+static NadaValue **find_binding(NadaEnv *env, const char *sym) {
+    for (; env != NULL; env = env->parent) {
+        NadaValue **place = find_local(env, sym);
+        if (place != NULL && *place != NULL) {
+            return place;
         }
-        current = current->next;
     }
+    return NULL;
+}
+
+// Look up a binding for an interned name, NULL if it is unbound
+NadaValue *nada_env_find_symbol(NadaEnv *env, const char *sym) {
+    NadaValue **place = find_binding(env, sym);
+    return place != NULL ? nada_retain(*place) : NULL;
+}
 
-    // If not found and we have a parent, search there
-    if (env->parent != NULL) {
-        return nada_env_get(env->parent, name, silent);
+// Value bound to an interned name without a new reference, NULL if unbound
+NadaValue *nada_env_peek_symbol(NadaEnv *env, const char *sym) {
+    NadaValue **place = find_binding(env, sym);
+    return place != NULL ? *place : NULL;
+}
+
+// Look up a binding in the environment
+NadaValue *nada_env_get(NadaEnv *env, const char *name, int silent) {
+    return nada_env_get_symbol(env, nada_intern(name), silent);
+}
+
+// Look up a binding for an interned name
+NadaValue *nada_env_get_symbol(NadaEnv *env, const char *sym, int silent) {
+    NadaValue **place = find_binding(env, sym);
+    if (place != NULL) {
+        // Return a new reference, the binding keeps its own
+        return nada_retain(*place);
     }
 
     // Not found
     if (!silent && !nada_is_global_silent_symbol_lookup()) {
         nada_report_error(NADA_ERROR_UNDEFINED_SYMBOL,
-                          "symbol '%s' not found in environment", name);
+                          "symbol '%s' not found in environment", sym);
     }
     return nada_create_nil();  // Return nil for undefined symbols
 }
 
+// Replace the value of an existing binding, as set! does
+bool nada_env_assign_symbol(NadaEnv *env, const char *sym, NadaValue *value) {
+    for (; env != NULL; env = env->parent) {
+        NadaValue **place = find_local(env, sym);
+        if (place != NULL && *place != NULL) {
+            note_binding(sym, value);
+            nada_free(*place);
+            // Globals are long-lived, move them out of the nursery
+            *place = bind_value(env, value);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Frame levels up from env for ref when each frame on the way is laid out
+// as resolved and has no bindings added at run time, NULL otherwise
+static NadaEnv *resolved_frame(NadaEnv *env, const NadaVarRef *ref) {
+    NadaFrameLayout *layout = ref->layout;
+    for (int d = 0; d < ref->depth; d++) {
+        if (env == NULL || env->layout != layout || env->bindings != NULL) return NULL;
+        env = env->parent;
+        layout = layout->parent;
+    }
+    if (ref->index >= 0 && (env == NULL || env->layout != layout)) return NULL;
+    return env;
+}
+
+NadaValue *nada_env_peek_var(NadaEnv *env, const NadaVarRef *ref) {
+    NadaEnv *frame = resolved_frame(env, ref);
+    if (frame == NULL) {
+        return nada_env_peek_symbol(env, ref->sym);
+    }
+    if (ref->index < 0) {
+        // None of the known frames has it, continue with the unknown ones
+        return nada_env_peek_symbol(frame, ref->sym);
+    }
+    NadaValue *value = frame->slots[ref->index];
+    return value != NULL ? value : nada_env_peek_symbol(frame->parent, ref->sym);
+}
+
+bool nada_env_assign_var(NadaEnv *env, const NadaVarRef *ref, NadaValue *value) {
+    NadaEnv *frame = resolved_frame(env, ref);
+    if (frame == NULL) {
+        return nada_env_assign_symbol(env, ref->sym, value);
+    }
+    if (ref->index < 0 || frame->slots[ref->index] == NULL) {
+        return nada_env_assign_symbol(ref->index < 0 ? frame : frame->parent, ref->sym, value);
+    }
+    note_binding(ref->sym, value);
+    nada_free(frame->slots[ref->index]);
+    frame->slots[ref->index] = nada_retain(value);
+    return true;
+}
+
 // Remove a binding from the environment
 void nada_env_remove(NadaEnv *env, const char *name) {
-    struct NadaBinding *prev = NULL;
-    struct NadaBinding *current = env->bindings;
-
-    while (current != NULL) {
-        if (strcmp(current->name, name) == 0) {
-            // Found the binding to remove
-            if (prev == NULL) {
-                // It's the first binding
-                env->bindings = current->next;
-            } else {
-                prev->next = current->next;
-            }
-
-            // Free the binding
-            nada_free(current->value);
-            free(current->name);
-            free(current);
+    const char *sym = nada_intern(name);
+    note_binding(sym, NULL);
+
+    for (; env != NULL; env = env->parent) {
+        NadaValue **slot = find_slot(env, sym);
+        if (slot != NULL && *slot != NULL) {
+            nada_free(*slot);
+            *slot = NULL;
             return;
         }
 
-        prev = current;
-        current = current->next;
-    }
+        struct NadaBinding *prev = NULL;
+        struct NadaBinding *current = env->bindings;
+
+        while (current != NULL) {
+            if (current->name == sym) {
+                // Found the binding to remove
+                if (prev == NULL) {
+                    // It's the first binding
+                    env->bindings = current->next;
+                } else {
+                    prev->next = current->next;
+                }
+                if (env == global_cells_env) {
+                    *global_cell(sym) = NULL;
+                }
 
-    // If not found in current environment, try parent
-    if (env->parent != NULL) {
-        nada_env_remove(env->parent, name);
+                // Free the binding
+                nada_free(current->value);
+                nada_pool_free(NADA_POOL_BINDING, current);
+                return;
+            }
+
+            prev = current;
+            current = current->next;
+        }
+        // If not found in current environment, try parent
     }
 }
 
 // Look up a symbol in the environment without printing error messages
 NadaValue *nada_env_lookup_symbol(NadaEnv *env, const char *name) {
-    // Search in current environment
-    struct NadaBinding *current = env->bindings;
-    while (current != NULL) {
-        if (strcmp(current->name, name) == 0) {
-            // Return a deep copy of the value, not the original!
-            return nada_deep_copy(current->value);
-        }
-        current = current->next;
-    }
-
-    // If not found and we have a parent, search there
-    if (env->parent != NULL) {
-        return nada_env_lookup_symbol(env->parent, name);
+    NadaValue **place = find_binding(env, nada_intern(name));
+    if (place != NULL) {
+        return nada_retain(*place);
     }
 
     // Not found - return nil without reporting an error
@@ -259,20 +535,25 @@ NadaValue *nada_env_lookup_symbol(NadaEnv *env, const char *name) {
 // Clean up the global environment
 void nada_cleanup_env(NadaEnv *global_env) {
     if (global_env) {
-        // Break circular references before releasing
-        struct NadaBinding *binding = global_env->bindings;
-        while (binding != NULL) {
-            if (binding->value && binding->value->type == NADA_FUNC &&
-                binding->value->data.function.env == global_env) {
-                binding->value->data.function.env = NULL;
-            }
-            binding = binding->next;
-        }
-
-        // Now release the environment
-        // printf("Releasing global environment with ref count: %d\n", global_env->ref_count);
+#ifdef NADA_ENABLE_GC
+        // Drop the owner's reference; the global environment and the
+        // functions defined in it form cycles that the collector reclaims
         nada_env_release(global_env);
-        // nada_env_free(global_env);
+        nada_gc_collect();
+#else
+        // Break circular references before releasing
+        nada_env_redirect_closures(global_env, NULL);
+
+        // Redirecting dropped the closures' references without counting
+        // them down, so the count no longer reaches zero; free it directly.
+        // Frames released while its bindings are freed must not free it a
+        // second time.
+        global_env->ref_count = INT_MAX;
+        nada_env_clear(global_env);
+        global_env->ref_count = 0;
+        nada_env_free(global_env);
+#endif
         global_env = NULL;
     }
+    nada_clear_lambda_cache();
 }
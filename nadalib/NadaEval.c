@@ -4,6 +4,8 @@
 #include <ctype.h>
 
 #include "NadaEval.h"
+#include "NadaSymbol.h"
+#include "NadaAnalyze.h"
 #include "NadaParser.h"
 #include "NadaString.h"
 #include "NadaError.h"
@@ -12,9 +14,6 @@
 // Forward declaration of the builtins array
 static BuiltinFuncInfo builtins[];
 
-// From builtin special forms
-void fix_env_references(NadaValue *value, NadaEnv *target_env, NadaEnv *replacement_env);
-
 // Flag to control symbol error reporting
 int g_silent_symbol_lookup = 0;
 
@@ -27,7 +26,10 @@ bool nada_is_global_silent_symbol_lookup() {
     return g_silent_symbol_lookup;
 }
 
-// Enhance apply_function to handle function objects from lists
+// Arguments up to this count are evaluated into a stack array
+#define APPLY_INLINE_ARGS 8
+
+// Apply a function to unevaluated argument expressions
 NadaValue *apply_function(NadaValue *func, NadaValue *args, NadaEnv *env) {
     // Special handling for built-in functions
     if (func->type == NADA_FUNC && func->data.function.builtin) {
@@ -35,194 +37,41 @@ NadaValue *apply_function(NadaValue *func, NadaValue *args, NadaEnv *env) {
         return func->data.function.builtin(args, env);
     }
 
-    // For user-defined functions, create a new environment
-    NadaEnv *func_env = nada_env_create(func->data.function.env);
-
-    // Get parameter list and body
-    NadaValue *params = func->data.function.params;
-    NadaValue *body = func->data.function.body;
-
-    // Handle variadic functions - find out if this is a variadic function
-    int is_variadic = 0;
-    const char *rest_param = NULL;
-
-    // Check if params is a single symbol (fully variadic)
-    if (params->type == NADA_SYMBOL) {
-        is_variadic = 1;
-        rest_param = params->data.symbol;
+    // Evaluate the arguments in the caller's environment
+    int argc = 0;
+    for (NadaValue *current = args; current->type == NADA_PAIR; current = current->data.pair.cdr) {
+        argc++;
     }
-    // Check if params ends with a dotted pair (partially variadic)
-    else if (params->type == NADA_PAIR) {
-        NadaValue *current = params;
-        NadaValue *next;
 
-        while (current->type == NADA_PAIR) {
-            next = current->data.pair.cdr;
-            if (next->type == NADA_SYMBOL && !nada_is_nil(next)) {
-                is_variadic = 1;
-                rest_param = next->data.symbol;
-                break;
-            }
-            current = next;
+    NadaValue *inline_argv[APPLY_INLINE_ARGS];
+    NadaValue **argv = inline_argv;
+    if (argc > APPLY_INLINE_ARGS) {
+        argv = malloc(argc * sizeof(NadaValue *));
+        if (argv == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
         }
     }
 
-    // Bind arguments to parameters
-    if (is_variadic) {
-        if (params->type == NADA_SYMBOL) {
-            // Case: (lambda args body) - all args as a list
-            // Evaluate each argument in the list
-            NadaValue *evaluated_args = nada_create_nil();
-            NadaValue *current = args;
-
-            // Evaluate each argument and build a new list
-            while (current->type == NADA_PAIR) {
-                NadaValue *arg_evaluated = nada_eval(current->data.pair.car, env);
-                NadaValue *new_args = nada_cons(arg_evaluated, evaluated_args);
-                nada_free(arg_evaluated);   // Free after it's been copied
-                nada_free(evaluated_args);  // Free the old list
-                evaluated_args = new_args;  // Update our list pointer
-                current = current->data.pair.cdr;
-            }
-
-            // Reverse the list to maintain the original order
-            NadaValue *reversed_args = nada_reverse(evaluated_args);
-            nada_free(evaluated_args);
-
-            // Bind the evaluated arguments list to the parameter
-            nada_env_set(func_env, rest_param, reversed_args);
-            nada_free(reversed_args);  // Free after it's been stored
-        } else {
-            // Case: (lambda (a b . rest) body) - fixed args plus rest list
-            NadaValue *current_param = params;
-            NadaValue *current_arg = args;
-
-            // Process the fixed parameters
-            while (current_param->type == NADA_PAIR &&
-                   current_param->data.pair.cdr->type == NADA_PAIR) {
-
-                if (nada_is_nil(current_arg)) {
-                    // Not enough arguments
-                    nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "too few arguments");
-                    nada_env_release(func_env);
-                    return nada_create_nil();
-                }
-
-                // Evaluate and bind this parameter
-                NadaValue *arg_evaluated = nada_eval(current_arg->data.pair.car, env);
-                nada_env_set(func_env,
-                             current_param->data.pair.car->data.symbol,
-                             arg_evaluated);
-                nada_free(arg_evaluated);  // Free after it's been stored
-
-                // Move to next param and arg
-                current_param = current_param->data.pair.cdr;
-                current_arg = current_arg->data.pair.cdr;
-            }
-
-            // Bind the last fixed parameter
-            if (current_param->type == NADA_PAIR &&
-                current_param->data.pair.car->type == NADA_SYMBOL) {
-
-                if (nada_is_nil(current_arg)) {
-                    // Not enough arguments
-                    nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "too few arguments");
-                    nada_env_release(func_env);
-                    return nada_create_nil();
-                }
-
-                // Bind this parameter
-                nada_env_set(func_env,
-                             current_param->data.pair.car->data.symbol,
-                             current_arg->data.pair.car);
-
-                // Move to next arg
-                current_arg = current_arg->data.pair.cdr;
-            }
-
-            // Bind rest parameter to remaining args - don't use nada_deep_copy
-            nada_env_set(func_env, rest_param, current_arg);
-        }
-    } else {
-        // Regular function binding - same fix applies
-        NadaValue *current_param = params;
-        NadaValue *current_arg = args;
-
-        while (!nada_is_nil(current_param) && !nada_is_nil(current_arg)) {
-            if (current_param->type != NADA_PAIR || current_param->data.pair.car->type != NADA_SYMBOL) {
-                nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "invalid parameter list");
-                nada_env_release(func_env);
-                return nada_create_nil();
-            }
-
-            // Evaluate the argument before binding it to the parameter
-            NadaValue *arg_evaluated = nada_eval(current_arg->data.pair.car, env);
-            nada_env_set(func_env,
-                         current_param->data.pair.car->data.symbol,
-                         arg_evaluated);
-            nada_free(arg_evaluated);  // Free after it's been stored
-
-            // Move to next param and arg
-            current_param = current_param->data.pair.cdr;
-            current_arg = current_arg->data.pair.cdr;
-        }
-
-        // Check for parameter/argument count mismatch
-        if (!nada_is_nil(current_param)) {
-            nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "too few arguments");
-            nada_env_release(func_env);
-            return nada_create_nil();
-        }
-
-        if (!nada_is_nil(current_arg)) {
-            nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "too many arguments");
-            nada_env_release(func_env);
-            return nada_create_nil();
-        }
-    }
-
-    // Evaluate body expressions
-    NadaValue *result = nada_create_nil();
-    NadaValue *current_expr = body;
-
-    while (!nada_is_nil(current_expr)) {
-        nada_free(result);
-        result = nada_eval(current_expr->data.pair.car, func_env);
-        current_expr = current_expr->data.pair.cdr;
+    NadaValue *current = args;
+    for (int i = 0; i < argc; i++) {
+        argv[i] = nada_eval(current->data.pair.car, env);
+        current = current->data.pair.cdr;
     }
 
-    // Make a deep copy before cleaning up
-    NadaValue *result_copy = nada_deep_copy(result);
-    nada_free(result);
-
-    /*
-    // IMPORTANT: Check if the result contains any functions that reference this environment
-    if (result_copy->type == NADA_FUNC && result_copy->data.function.env == func_env) {
-        // Break circular reference to prevent leak
-        result_copy->data.function.env = func->data.function.env;
-        if (func->data.function.env) {
-            nada_env_add_ref(func->data.function.env);
-        }
-    } else if (result_copy->type == NADA_PAIR) {
-        // Recursively scan list result for functions referencing this environment
-        fix_env_references(result_copy, func_env, func->data.function.env);
+    // The frame takes over the evaluated arguments
+    NadaValue *result = nada_run_code(nada_closure_code(func), func->data.function.env, argv, argc);
+    if (argv != inline_argv) {
+        free(argv);
     }
-    */
-
-    // Clean up
-    nada_env_release(func_env);
-
-    return result_copy;
+    return result;
 }
 
-// Helper to check if a name is a built-in function
+static BuiltinFunc find_builtin(const char *sym);
+
+// Helper to check if an interned name is a built-in function
 static int is_builtin(const char *name) {
-    for (int i = 0; builtins[i].name != NULL; i++) {
-        if (strcmp(name, builtins[i].name) == 0) {
-            return 1;
-        }
-    }
-    return 0;
+    return find_builtin(name) != NULL;
 }
 
 // Built-in function predicate
@@ -255,6 +104,15 @@ static NadaValue *builtin_builtin_p(NadaValue *args, NadaEnv *env) {
 
 // Helper function to collect symbols from an environment
 void collect_symbols(NadaEnv *current_env, NadaValue **list) {
+    for (int i = 0; current_env->layout != NULL && i < current_env->layout->count; i++) {
+        if (current_env->slots[i] == NULL) continue;
+        NadaValue *symbol = nada_create_symbol(current_env->layout->names[i]);
+        NadaValue *new_list = nada_cons(symbol, *list);
+        nada_free(symbol);
+        nada_free(*list);
+        *list = new_list;
+    }
+
     struct NadaBinding *binding = current_env->bindings;
     while (binding != NULL) {
         // Create the symbol value
@@ -404,8 +262,10 @@ void serialize_value(NadaValue *val, FILE *f) {
 void nada_serialize_env(NadaEnv *current_env, FILE *out) {
     struct NadaBinding *binding = current_env->bindings;
     while (binding != NULL) {
-        // Skip built-in functions
-        if (!is_builtin(binding->name)) {
+        // Skip built-in functions, but keep user definitions that shadow them
+        NadaValue *value = binding->value;
+        if (!(value->type == NADA_FUNC && value->data.function.builtin != NULL &&
+              value->data.function.builtin == find_builtin(binding->name))) {
             fprintf(out, "(define %s ", binding->name);
             serialize_value(binding->value, out);
             fprintf(out, ")\n");
@@ -468,10 +328,17 @@ static BuiltinFuncInfo builtins[] = {
     {"modulo", builtin_modulo},  // Add modulo as alias
     {"remainder", builtin_remainder},
     {"expt", builtin_expt},
+    {"expt-mod", builtin_expt_mod},
+    {"exact-integer-sqrt", builtin_exact_integer_sqrt},
+    {"exact-integer-root", builtin_exact_integer_root},
     {"numerator", builtin_numerator},      // Add numerator function
     {"denominator", builtin_denominator},  // Add denominator function
     {"sign", builtin_sign},                // Add sign function
     {"factor", builtin_factor},            // Add factor function
+    {"exact->inexact", builtin_exact_to_inexact},
+    {"inexact->exact", builtin_inexact_to_exact},
+    {"inexact", builtin_exact_to_inexact},
+    {"exact", builtin_inexact_to_exact},
     {"define", builtin_define},
     {"lambda", builtin_lambda},
     {"<", builtin_less_than},
@@ -499,6 +366,8 @@ static BuiltinFuncInfo builtins[] = {
     {"undef", builtin_undef},
     {"integer?", builtin_integer_p},
     {"number?", builtin_number_p},  // New number? predicate
+    {"exact?", builtin_exact_p},
+    {"inexact?", builtin_inexact_p},
     {"string?", builtin_string_p},
     {"symbol?", builtin_symbol_p},
     {"defined?", builtin_defined_p},
@@ -582,26 +451,52 @@ static BuiltinFuncInfo builtins[] = {
     {NULL, NULL}  // Sentinel to mark end of array
 };
 
-// Create a standard environment with basic operations
-NadaEnv *nada_standard_env(void) {
-    NadaEnv *env = nada_env_create(NULL);
+static const struct {
+    const char *name;
+    NadaSpecialForm form;
+} special_forms[] = {
+    {"quote", NADA_FORM_QUOTE},
+    {"define", NADA_FORM_DEFINE},
+    {"lambda", NADA_FORM_LAMBDA},
+    {"cond", NADA_FORM_COND},
+    {"let", NADA_FORM_LET},
+    {"if", NADA_FORM_IF},
+    {"begin", NADA_FORM_BEGIN},
+    {"and", NADA_FORM_AND},
+    {"or", NADA_FORM_OR},
+    {"set!", NADA_FORM_SET},
+    {NULL, NADA_FORM_NONE}};
+
+// Record the special forms and builtins with their symbols, so looking one
+// up is a single pointer dereference
+void nada_init_dispatch(void) {
+    static bool initialized = false;
+    if (initialized) return;
+    initialized = true;
+
+    for (int i = 0; special_forms[i].name != NULL; i++) {
+        nada_symbol_dispatch(nada_intern(special_forms[i].name))->special_form = special_forms[i].form;
+    }
 
-    // Add built-in functions to environment
     for (int i = 0; builtins[i].name != NULL; i++) {
-        // For simplicity, we're not creating proper function objects yet
-        // We'll just use symbols with special handling in the evaluator
-        NadaValue *symbol = nada_create_symbol(builtins[i].name);
-        nada_env_set(env, builtins[i].name, symbol);
-        // Free the symbol after it's been added to the environment
-        nada_free(symbol);
+        NadaSymbolDispatch *dispatch = nada_symbol_dispatch(nada_intern(builtins[i].name));
+        // The first entry wins, as with the table scan this replaces
+        if (dispatch->builtin == NULL) {
+            dispatch->builtin = builtins[i].func;
+        }
     }
+}
 
-    return env;
+// Look up a builtin by interned name
+static BuiltinFunc find_builtin(const char *sym) {
+    nada_init_dispatch();
+    return nada_symbol_dispatch(sym)->builtin;
 }
 
 // Create a standard environment with all built-in functions
 NadaEnv *nada_create_standard_env(void) {
-    // Add tracking here
+    // Builtin names must be known before binding them, see note_binding
+    nada_init_dispatch();
     NadaEnv *env = nada_env_create(NULL);
 
     // Register all built-in functions from the builtins array
@@ -616,15 +511,7 @@ NadaEnv *nada_create_standard_env(void) {
 
 // Helper to check if a symbol is a built-in function
 BuiltinFunc get_builtin_func(const char *name) {
-    // Search through the existing builtins array for a matching name
-    for (int i = 0; builtins[i].name != NULL; i++) {
-        if (strcmp(name, builtins[i].name) == 0) {
-            return builtins[i].func;
-        }
-    }
-
-    // No match found
-    return NULL;
+    return find_builtin(nada_intern(name));
 }
 
 // Enhanced function to get the name of a builtin function
@@ -647,6 +534,32 @@ const char *get_builtin_name(BuiltinFunc func) {
     return NULL;
 }
 
+// Report a failed application of op, whose value is op_value
+NadaValue *nada_not_a_function(NadaValue *op, NadaValue *op_value) {
+    // Save the operator name for the error message
+    char op_name[256] = "unknown";
+    if (op->type == NADA_SYMBOL) {
+        strncpy(op_name, op->data.symbol, sizeof(op_name) - 1);
+        op_name[sizeof(op_name) - 1] = '\0';  // Ensure null termination
+    } else if (op_value->type == NADA_NIL) {
+        strcpy(op_name, "nil");
+    } else {
+        // Try to get a representation of the value
+        char *repr = nada_value_to_string(op);
+        if (repr) {
+            strncpy(op_name, repr, sizeof(op_name) - 1);
+            op_name[sizeof(op_name) - 1] = '\0';
+            free(repr);
+        }
+    }
+
+    nada_free(op_value);
+    if (!nada_is_global_silent_symbol_lookup()) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "'%s' is not a function", op_name);
+    }
+    return nada_create_nil();
+}
+
 // Evaluate an expression in an environment
 NadaValue *nada_eval(NadaValue *expr, NadaEnv *env) {
     // Self-evaluating expressions: numbers, strings, booleans, nil, functions, and errors
@@ -654,35 +567,13 @@ NadaValue *nada_eval(NadaValue *expr, NadaEnv *env) {
         expr->type == NADA_BOOL || expr->type == NADA_NIL ||
         expr->type == NADA_ERROR || expr->type == NADA_FUNC) {
 
-        // Make a copy to avoid double-freeing
-        switch (expr->type) {
-        case NADA_NUM:
-            return nada_create_num(expr->data.number);
-        case NADA_STRING:
-            return nada_create_string(expr->data.string);
-        case NADA_BOOL:
-            return nada_create_bool(expr->data.boolean);
-        case NADA_NIL:
-            return nada_create_nil();
-        case NADA_ERROR:
-            return nada_create_error(expr->data.error);
-        case NADA_FUNC:
-            // For built-in functions
-            if (expr->data.function.builtin) {
-                return nada_create_builtin_function(expr->data.function.builtin);
-            }
-            // For user-defined functions, use deep_copy instead of individual components
-            else {
-                return nada_deep_copy(expr);
-            }
-        default:
-            return nada_create_nil();
-        }
+        // Values are immutable, so hand out a new reference
+        return nada_retain(expr);
     }
 
     // Symbol lookup
     if (expr->type == NADA_SYMBOL) {
-        return nada_env_get(env, expr->data.symbol, nada_is_global_silent_symbol_lookup());
+        return nada_env_get_symbol(env, expr->data.symbol, nada_is_global_silent_symbol_lookup());
     }
 
     // List processing and the rest of the function...
@@ -691,73 +582,57 @@ NadaValue *nada_eval(NadaValue *expr, NadaEnv *env) {
         NadaValue *op = nada_car(expr);
         NadaValue *args = nada_cdr(expr);
 
-        // Special forms
         if (op->type == NADA_SYMBOL) {
-            // Quote special form
-            if (strcmp(op->data.symbol, "quote") == 0) {
-                return builtin_quote(args, env);
+            const char *sym = op->data.symbol;
+            nada_init_dispatch();
+            NadaSymbolDispatch *dispatch = nada_symbol_dispatch(sym);
+
+            // Special forms
+            switch (dispatch->special_form) {
+                case NADA_FORM_QUOTE:
+                    return builtin_quote(args, env);
+                case NADA_FORM_DEFINE:
+                    return builtin_define(args, env);
+                case NADA_FORM_LAMBDA:
+                    return builtin_lambda(args, env);
+                case NADA_FORM_COND:
+                    return builtin_cond(args, env);
+                case NADA_FORM_LET:
+                    return builtin_let(args, env);
+                case NADA_FORM_IF:
+                    return builtin_if(args, env);
+                case NADA_FORM_BEGIN:
+                    return builtin_begin(args, env);
+                case NADA_FORM_AND:
+                    return builtin_and(args, env);
+                case NADA_FORM_OR:
+                    return builtin_or(args, env);
+                case NADA_FORM_SET:
+                    return builtin_set(args, env);
+                default:
+                    break;
             }
 
-            // Define special form
-            if (strcmp(op->data.symbol, "define") == 0) {
-                return builtin_define(args, env);
+            // A builtin's name calls the builtin directly until some
+            // environment binds the name to something else
+            if (dispatch->builtin != NULL && !dispatch->rebound) {
+                return dispatch->builtin(args, env);
             }
 
-            // Lambda special form
-            if (strcmp(op->data.symbol, "lambda") == 0) {
-                return builtin_lambda(args, env);
-            }
-
-            // Cond special form
-            if (strcmp(op->data.symbol, "cond") == 0) {
-                return builtin_cond(args, env);
-            }
-
-            // Let special form
-            if (strcmp(op->data.symbol, "let") == 0) {
-                return builtin_let(args, env);
-            }
-
-            // If special form
-            if (strcmp(op->data.symbol, "if") == 0) {
-                return builtin_if(args, env);
-            }
-
-            // Begin special form
-            if (strcmp(op->data.symbol, "begin") == 0) {
-                return builtin_begin(args, env);
-            }
-
-            // And special form
-            if (strcmp(op->data.symbol, "and") == 0) {
-                return builtin_and(args, env);
-            }
-
-            // Or special form
-            if (strcmp(op->data.symbol, "or") == 0) {
-                return builtin_or(args, env);
-            }
-
-            // Set! special form
-            if (strcmp(op->data.symbol, "set!") == 0) {
-                return builtin_set(args, env);
-            }
-
-            // Regular function application
-            BuiltinFunc func = get_builtin_func(op->data.symbol);
-            if (func != NULL) {
-                return func(args, env);
-            }
-
-            // Try to apply as a user-defined function
-            NadaValue *func_val = nada_env_get(env, op->data.symbol, 0);
-            if (func_val->type == NADA_FUNC) {
+            // Otherwise the binding in scope decides, as it does for any
+            // other symbol; an unbound builtin name still reaches the builtin
+            NadaValue *func_val = nada_env_find_symbol(env, sym);
+            if (func_val == NULL) {
+                if (dispatch->builtin != NULL) {
+                    return dispatch->builtin(args, env);
+                }
+            } else if (func_val->type == NADA_FUNC) {
                 NadaValue *result = apply_function(func_val, args, env);
                 nada_free(func_val);
                 return result;
+            } else {
+                nada_free(func_val);
             }
-
-            nada_free(func_val);
         }
 
         // Try to evaluate the operator position
@@ -768,27 +643,7 @@ NadaValue *nada_eval(NadaValue *expr, NadaEnv *env) {
             return result;
         }
 
-        // Save the operator name for the error message
-        char op_name[256] = "unknown";
-        if (op->type == NADA_SYMBOL) {
-            strncpy(op_name, op->data.symbol, sizeof(op_name) - 1);
-            op_name[sizeof(op_name) - 1] = '\0';  // Ensure null termination
-        } else if (eval_op->type == NADA_NIL) {
-            strcpy(op_name, "nil");
-        } else {
-            // Try to get a representation of the value
-            char *repr = nada_value_to_string(op);
-            if (repr) {
-                strncpy(op_name, repr, sizeof(op_name) - 1);
-                op_name[sizeof(op_name) - 1] = '\0';
-            }
-        }
-
-        nada_free(eval_op);
-        if (!nada_is_global_silent_symbol_lookup()) {
-            nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "'%s' is not a function", op_name);
-        }
-        return nada_create_nil();
+        return nada_not_a_function(op, eval_op);
     }
 
     // Default case
@@ -847,7 +702,7 @@ NadaValue *builtin_eval(NadaValue *args, NadaEnv *env) {
             nada_set_silent_symbol_lookup(1);
 
             // Try to lookup the symbol silently
-            NadaValue *lookup_result = nada_env_get(env, expr->data.symbol, 1);
+            NadaValue *lookup_result = nada_env_get_symbol(env, expr->data.symbol, 1);
 
             // Restore normal lookup mode
             nada_set_silent_symbol_lookup(0);
@@ -1011,13 +866,9 @@ NadaValue *builtin_tokenize_expr(NadaValue *args, NadaEnv *env) {
 
 // Add to NadaEval.c
 NadaValue *nada_create_builtin_function(NadaValue *(*func)(NadaValue *, NadaEnv *)) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    val->type = NADA_FUNC;
-    val->data.function.params = NULL;   // No explicit parameters for builtins
-    val->data.function.body = NULL;     // No body for builtins
-    val->data.function.env = NULL;      // No closure environment
+    // No explicit parameters, body or closure environment for builtins
+    NadaValue *val = nada_create_function(NULL, NULL, NULL);
     val->data.function.builtin = func;  // Store the function pointer
-    nada_increment_allocations();       // Move this AFTER initialization
     return val;
 }
 
@@ -0,0 +1,283 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "NadaGC.h"
+#include "NadaValue.h"
+
+#ifdef NADA_ENABLE_GC
+
+// All live environments, linked through gc_prev/gc_next
+static NadaEnv *all_envs = NULL;
+static size_t live_envs = 0;
+
+// Collect after this many environments were created since the last run
+#define NADA_GC_MIN_THRESHOLD 10000
+static size_t envs_created = 0;
+static size_t collect_threshold = NADA_GC_MIN_THRESHOLD;
+static int collecting = 0;
+
+void nada_gc_register_env(NadaEnv *env) {
+    env->gc_prev = NULL;
+    env->gc_next = all_envs;
+    if (all_envs) all_envs->gc_prev = env;
+    all_envs = env;
+    live_envs++;
+    envs_created++;
+}
+
+void nada_gc_unregister_env(NadaEnv *env) {
+    if (env->gc_prev) {
+        env->gc_prev->gc_next = env->gc_next;
+    } else {
+        all_envs = env->gc_next;
+    }
+    if (env->gc_next) env->gc_next->gc_prev = env->gc_prev;
+    env->gc_prev = env->gc_next = NULL;
+    live_envs--;
+}
+
+size_t nada_gc_live_envs(void) {
+    return live_envs;
+}
+
+// Graph node: an environment, or a pair or closure reachable from one
+typedef struct {
+    void *ptr;
+    int is_env;
+    int gc_refs;    // References not accounted for by the graph itself
+    int reachable;  // Set by the mark phase
+} GcNode;
+
+typedef struct {
+    GcNode *nodes;
+    size_t count, capacity;
+    size_t *slots;  // Hash of ptr -> node index + 1 (0 = empty)
+    size_t slot_capacity;
+    size_t *stack;  // Work stack of node indices
+    size_t stack_count, stack_capacity;
+} GcGraph;
+
+static void *gc_xrealloc(void *ptr, size_t size) {
+    void *p = realloc(ptr, size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+static size_t hash_ptr(const void *ptr) {
+    uintptr_t x = (uintptr_t)ptr;
+    x ^= x >> 17;
+    x *= 0x9E3779B97F4A7C15ull;
+    return (size_t)(x ^ (x >> 29));
+}
+
+static void graph_rehash(GcGraph *g) {
+    size_t capacity = g->slot_capacity ? g->slot_capacity * 2 : 1024;
+    free(g->slots);
+    g->slots = calloc(capacity, sizeof(size_t));
+    if (g->slots == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    g->slot_capacity = capacity;
+    for (size_t i = 0; i < g->count; i++) {
+        size_t slot = hash_ptr(g->nodes[i].ptr) & (capacity - 1);
+        while (g->slots[slot]) slot = (slot + 1) & (capacity - 1);
+        g->slots[slot] = i + 1;
+    }
+}
+
+// Return the node index for ptr, or -1 if it is not in the graph
+static long graph_find(GcGraph *g, const void *ptr) {
+    if (g->slot_capacity == 0) return -1;
+    size_t slot = hash_ptr(ptr) & (g->slot_capacity - 1);
+    while (g->slots[slot]) {
+        size_t index = g->slots[slot] - 1;
+        if (g->nodes[index].ptr == ptr) return (long)index;
+        slot = (slot + 1) & (g->slot_capacity - 1);
+    }
+    return -1;
+}
+
+static void graph_push(GcGraph *g, size_t index) {
+    if (g->stack_count == g->stack_capacity) {
+        g->stack_capacity = g->stack_capacity ? g->stack_capacity * 2 : 256;
+        g->stack = gc_xrealloc(g->stack, g->stack_capacity * sizeof(size_t));
+    }
+    g->stack[g->stack_count++] = index;
+}
+
+// Add ptr as a node if it is new; new nodes are pushed for traversal
+static void graph_add(GcGraph *g, void *ptr, int is_env) {
+    if (graph_find(g, ptr) >= 0) return;
+
+    if ((g->count + 1) * 2 > g->slot_capacity) {
+        graph_rehash(g);
+    }
+    if (g->count == g->capacity) {
+        g->capacity = g->capacity ? g->capacity * 2 : 256;
+        g->nodes = gc_xrealloc(g->nodes, g->capacity * sizeof(GcNode));
+    }
+
+    size_t index = g->count++;
+    g->nodes[index] = (GcNode){.ptr = ptr, .is_env = is_env};
+    size_t slot = hash_ptr(ptr) & (g->slot_capacity - 1);
+    while (g->slots[slot]) slot = (slot + 1) & (g->slot_capacity - 1);
+    g->slots[slot] = index + 1;
+
+    graph_push(g, index);
+}
+
+// Only values that can reference an environment take part in the graph
+static int is_container(const NadaValue *val) {
+    if (val == NULL || val->ref_count == NADA_REF_IMMORTAL) return 0;
+    return val->type == NADA_PAIR ||
+           (val->type == NADA_FUNC && val->data.function.builtin == NULL);
+}
+
+typedef void (*GcVisit)(GcGraph *g, void *child, int is_env, void *ctx);
+
+// Call visit for every environment or container referenced by a node
+static void traverse(GcGraph *g, const GcNode *node, GcVisit visit, void *ctx) {
+    if (node->is_env) {
+        NadaEnv *env = node->ptr;
+        if (env->parent) visit(g, env->parent, 1, ctx);
+        for (int i = 0; env->layout != NULL && i < env->layout->count; i++) {
+            if (is_container(env->slots[i])) visit(g, env->slots[i], 0, ctx);
+        }
+        for (struct NadaBinding *b = env->bindings; b != NULL; b = b->next) {
+            if (is_container(b->value)) visit(g, b->value, 0, ctx);
+        }
+        return;
+    }
+
+    NadaValue *val = node->ptr;
+    if (val->type == NADA_PAIR) {
+        if (is_container(val->data.pair.car)) visit(g, val->data.pair.car, 0, ctx);
+        if (is_container(val->data.pair.cdr)) visit(g, val->data.pair.cdr, 0, ctx);
+    } else {
+        if (is_container(val->data.function.params)) visit(g, val->data.function.params, 0, ctx);
+        if (is_container(val->data.function.body)) visit(g, val->data.function.body, 0, ctx);
+        if (val->data.function.env) visit(g, val->data.function.env, 1, ctx);
+    }
+}
+
+static void visit_add(GcGraph *g, void *child, int is_env, void *ctx) {
+    (void)ctx;
+    graph_add(g, child, is_env);
+}
+
+static void visit_subtract(GcGraph *g, void *child, int is_env, void *ctx) {
+    (void)is_env;
+    (void)ctx;
+    long index = graph_find(g, child);
+    if (index >= 0) g->nodes[index].gc_refs--;
+}
+
+static void visit_mark(GcGraph *g, void *child, int is_env, void *ctx) {
+    (void)is_env;
+    (void)ctx;
+    long index = graph_find(g, child);
+    if (index >= 0 && !g->nodes[index].reachable) {
+        g->nodes[index].reachable = 1;
+        graph_push(g, (size_t)index);
+    }
+}
+
+size_t nada_gc_collect(void) {
+    if (collecting) return 0;
+    collecting = 1;
+
+    GcGraph g = {0};
+
+    // 1. Build the graph: every environment plus the containers reachable from them
+    for (NadaEnv *env = all_envs; env != NULL; env = env->gc_next) {
+        graph_add(&g, env, 1);
+    }
+    while (g.stack_count > 0) {
+        size_t index = g.stack[--g.stack_count];
+        GcNode node = g.nodes[index];  // Copy, graph_add may move the array
+        traverse(&g, &node, visit_add, NULL);
+    }
+
+    // 2. Subtract references that come from inside the graph
+    for (size_t i = 0; i < g.count; i++) {
+        GcNode *node = &g.nodes[i];
+        node->gc_refs = node->is_env ? ((NadaEnv *)node->ptr)->ref_count
+                                     : ((NadaValue *)node->ptr)->ref_count;
+    }
+    for (size_t i = 0; i < g.count; i++) {
+        traverse(&g, &g.nodes[i], visit_subtract, NULL);
+    }
+
+    // 3. Mark from the roots: nodes that are still referenced from outside
+    for (size_t i = 0; i < g.count; i++) {
+        if (g.nodes[i].gc_refs > 0) {
+            g.nodes[i].reachable = 1;
+            graph_push(&g, i);
+        }
+    }
+    while (g.stack_count > 0) {
+        size_t index = g.stack[--g.stack_count];
+        traverse(&g, &g.nodes[index], visit_mark, NULL);
+    }
+
+    // 4. Sweep unreachable environments. Hold each one first so that none is
+    //    freed while the others are being cleared; garbage pairs and closures
+    //    are released by reference counting as the bindings are dropped.
+    size_t garbage = 0;
+    for (size_t i = 0; i < g.count; i++) {
+        if (g.nodes[i].is_env && !g.nodes[i].reachable) {
+            nada_env_add_ref(g.nodes[i].ptr);
+            g.nodes[garbage++] = g.nodes[i];  // Compact garbage envs to the front
+        }
+    }
+    for (size_t i = 0; i < garbage; i++) {
+        nada_env_clear(g.nodes[i].ptr);
+    }
+    for (size_t i = 0; i < garbage; i++) {
+        nada_env_release(g.nodes[i].ptr);
+    }
+
+    free(g.nodes);
+    free(g.slots);
+    free(g.stack);
+
+    // Next collection once the number of environments has grown enough
+    envs_created = 0;
+    collect_threshold = live_envs > NADA_GC_MIN_THRESHOLD / 2 ? live_envs * 2 : NADA_GC_MIN_THRESHOLD;
+    collecting = 0;
+    return garbage;
+}
+
+void nada_gc_maybe_collect(void) {
+    if (envs_created >= collect_threshold) {
+        nada_gc_collect();
+    }
+}
+
+#else  // !NADA_ENABLE_GC
+
+size_t nada_gc_collect(void) {
+    return 0;
+}
+
+void nada_gc_maybe_collect(void) {
+}
+
+void nada_gc_register_env(NadaEnv *env) {
+    (void)env;
+}
+
+void nada_gc_unregister_env(NadaEnv *env) {
+    (void)env;
+}
+
+size_t nada_gc_live_envs(void) {
+    return 0;
+}
+
+#endif  // NADA_ENABLE_GC
@@ -1,40 +1,82 @@
 #include "NadaNum.h"
+#include "NadaBigInt.h"
+#include "NadaPrime.h"
 #include "NadaError.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
-#include <assert.h>
-
-// Structure definition for a rational number
+#include <limits.h>
+#include <inttypes.h>
+#include <math.h>
+
+// Structure definition for a number. Exact rationals store numerator and
+// denominator inline while both fit in 64 bits; larger values switch to
+// binary bignum magnitudes (see NadaBigInt.h). The form is canonical: a
+// number is big only if it does not fit the small form, so zero, loop
+// counters and typical rationals never touch the bignum code. Inexact
+// numbers are a plain IEEE double.
 struct NadaNum {
-    char *numerator;    // String representation of numerator digits
-    char *denominator;  // String representation of denominator digits
-    int sign;           // 1 for positive, -1 for negative
+    int sign;         // 1 for positive, -1 for negative
+    bool is_big;      // Which member of the union is in use
+    bool is_flonum;   // Inexact: only flonum is in use, is_big is false
+    bool unreduced;   // Big form not yet in lowest terms (see nada_num_lazy_limbs)
+    union {
+        double flonum;
+        struct {
+            uint64_t numerator;
+            uint64_t denominator;
+        } small;
+        struct {
+            NadaBigInt numerator;
+            NadaBigInt denominator;
+        } big;
+    };
+    // In both exact forms the denominator is >= 1 and, unless unreduced is
+    // set, coprime with the numerator
 };
 
+#ifdef NADA_LAZY_RATIONALS
+size_t nada_num_lazy_limbs = NADA_NUM_LAZY_LIMBS;
+#else
+size_t nada_num_lazy_limbs = 0;
+#endif
+
+// Read-only bignum view of a number in either form
+typedef struct {
+    NadaLimb storage[4];
+    NadaBigInt numerator;
+    NadaBigInt denominator;
+} BigView;
+
 // Forward declarations of helper functions
-static char *add_integers(const char *a, const char *b);
-static char *subtract_integers(const char *a, const char *b);
-static char *multiply_integers(const char *a, const char *b);
-static char *divide_integers(const char *a, const char *b, char **remainder);
-static int compare_integers(const char *a, const char *b);
-static char *gcd(const char *a, const char *b);
-static void normalize(NadaNum *num);
-static char *strip_leading_zeros(const char *num);
+static NadaNum *num_alloc(void);
+static NadaNum *num_small(uint64_t numerator, uint64_t denominator, int sign);
+static NadaNum *num_small_reduce(uint64_t numerator, uint64_t denominator, int sign);
+static NadaNum *num_from_big(NadaBigInt *numerator, NadaBigInt *denominator, int sign);
+static NadaNum *num_from_reduced(NadaBigInt *numerator, NadaBigInt *denominator, int sign);
+static NadaNum *num_from_unreduced(NadaBigInt *numerator, NadaBigInt *denominator, int sign);
+static bool defer_reduction(const NadaNum *a, const NadaNum *b);
+static void num_normalize(const NadaNum *num);
+static void cancel_common(NadaBigInt *x, NadaBigInt *y, const NadaBigInt *a, const NadaBigInt *b);
+static void big_view(const NadaNum *num, BigView *view);
+static void parse_magnitude(NadaBigInt *r, const char *digits);
+static void power_of_ten(NadaBigInt *r, size_t exponent);
+static double big_ratio_to_double(const NadaBigInt *numerator, const NadaBigInt *denominator);
 
 // Create a rational number from an integer value
 NadaNum *nada_num_from_int(int value) {
-    NadaNum *num = malloc(sizeof(NadaNum));
-    if (!num) return NULL;
-
-    char buffer[32];
-    sprintf(buffer, "%d", abs(value));
+    return num_small(value < 0 ? -(uint64_t)value : (uint64_t)value, 1, (value >= 0) ? 1 : -1);
+}
 
-    num->numerator = strdup(buffer);
-    num->denominator = strdup("1");
-    num->sign = (value >= 0) ? 1 : -1;
+// Create an inexact number from a double
+NadaNum *nada_num_from_double(double value) {
+    NadaNum *num = num_alloc();
+    if (!num) return NULL;
 
+    num->is_flonum = true;
+    num->flonum = value;
+    num->sign = signbit(value) ? -1 : 1;
     return num;
 }
 
@@ -42,67 +84,41 @@ NadaNum *nada_num_from_int(int value) {
 NadaNum *nada_num_from_fraction(const char *numerator, const char *denominator) {
     if (!numerator || !denominator) return NULL;
 
-    // Check if denominator is zero
-    bool denom_is_zero = true;
-    for (const char *p = denominator; *p; p++) {
-        if (*p != '0') {
-            denom_is_zero = false;
-            break;
-        }
-    }
-
-    if (denom_is_zero) {
-        fprintf(stderr, "Error: Division by zero\n");
-        return nada_num_from_int(0);  // Return 0 instead of failing
-    }
-
-    NadaNum *num = malloc(sizeof(NadaNum));
-    if (!num) return NULL;
-
     // Determine sign based on numerator (ignoring denominator sign)
-    num->sign = 1;
+    int sign = 1;
     if (numerator[0] == '-') {
-        num->sign = -1;
+        sign = -1;
         numerator++;  // Skip the sign
     }
 
     // Skip denominator sign if present
     if (denominator[0] == '-') {
-        num->sign *= -1;  // Flip sign
+        sign *= -1;  // Flip sign
         denominator++;
     }
 
-    // Copy values, skipping leading zeros
-    num->numerator = strip_leading_zeros(numerator);
-    if (!num->numerator || strcmp(num->numerator, "") == 0) {
-        free(num->numerator);  // Add this to free any allocated memory
-        num->numerator = strdup("0");
-        num->sign = 1;  // Zero is always positive
-    }
-
-    num->denominator = strip_leading_zeros(denominator);
-    if (!num->denominator || strcmp(num->denominator, "") == 0) {
-        free(num->denominator);          // Add this to free any allocated memory
-        num->denominator = strdup("1");  // Default denominator
+    NadaBigInt num = NADA_BIG_INIT, denom = NADA_BIG_INIT;
+    parse_magnitude(&denom, denominator);
+    if (nada_big_is_zero(&denom)) {
+        fprintf(stderr, "Error: Division by zero\n");
+        nada_big_free(&denom);
+        return nada_num_from_int(0);  // Return 0 instead of failing
     }
+    parse_magnitude(&num, numerator);
 
-    // Normalize the fraction (reduce to lowest terms)
-    normalize(num);
-
-    return num;
+    // Reduce to lowest terms
+    return num_from_big(&num, &denom, sign);
 }
 
-// Parse a string into a rational number
+// Parse a string into a rational number; numerals with an exponent
+// (1.5e-7) are read as flonums
 NadaNum *nada_num_from_string(const char *str) {
     if (!str || *str == '\0') return NULL;
-
-    // Copy string to work with
-    char *s = strdup(str);
-    if (!s) return NULL;
+    if (strpbrk(str, "eE")) return nada_num_from_double(strtod(str, NULL));
 
     // Determine the sign
     int sign = 1;
-    char *p = s;
+    const char *p = str;
 
     if (*p == '+') {
         p++;
@@ -112,84 +128,54 @@ NadaNum *nada_num_from_string(const char *str) {
     }
 
     // Check for fraction notation (a/b)
-    char *slash = strchr(p, '/');
+    const char *slash = strchr(p, '/');
     if (slash) {
-        *slash = '\0';  // Split string at slash
-        NadaNum *result = nada_num_from_fraction(p, slash + 1);
-        if (result) {
+        char *numerator = strndup(p, slash - p);
+        if (!numerator) return NULL;
+        NadaNum *result = nada_num_from_fraction(numerator, slash + 1);
+        free(numerator);
+        if (result && !nada_num_is_zero(result)) {
             result->sign *= sign;
         }
-        free(s);
         return result;
     }
 
-    // Check for decimal notation
-    char *dot = strchr(p, '.');
-    if (dot) {
-        *dot = '\0';  // Split at decimal point
-
-        // Handle part before decimal
-        char *integer_part = strip_leading_zeros(p);
-        if (!integer_part || *integer_part == '\0') {
-            integer_part = strdup("0");
-        }
-
-        // For decimal part, preserve the original length (including leading zeros)
-        size_t decimal_len = strlen(dot + 1);
-
-        // Get actual decimal digits (stripping zeros only for calculation)
-        char *decimal_part = strip_leading_zeros(dot + 1);
-        if (!decimal_part || *decimal_part == '\0') {
-            decimal_part = strdup("0");
-        }
-
-        // Create denominator (10^decimal_len) based on ORIGINAL length
-        char *denominator = malloc(decimal_len + 2);
-        denominator[0] = '1';
-        for (size_t i = 0; i < decimal_len; i++) {
-            denominator[i + 1] = '0';
-        }
-        denominator[decimal_len + 1] = '\0';
-
-        // Combine integer_part + decimal_part / 10^decimal_len
-        char *temp = multiply_integers(integer_part, denominator);
-        char *combined_num = add_integers(temp, decimal_part);
-        free(temp);  // Free the intermediate result
+    NadaBigInt num = NADA_BIG_INIT, denom = NADA_BIG_INIT;
 
-        NadaNum *result = nada_num_from_fraction(combined_num, denominator);
-        if (result) {
-            result->sign = sign;
-        }
-
-        free(integer_part);
-        free(decimal_part);
-        free(denominator);
-        free(combined_num);
-        free(s);
-
-        return result;
-    }
-
-    // Simple integer
-    NadaNum *result = nada_num_from_fraction(p, "1");
-    if (result) {
-        result->sign = sign;
+    // Check for decimal notation: the digits without the dot over 10^decimals
+    const char *dot = strchr(p, '.');
+    if (dot) {
+        char *digits = malloc(strlen(p) + 1);
+        if (!digits) return NULL;
+        memcpy(digits, p, dot - p);
+        strcpy(digits + (dot - p), dot + 1);
+
+        parse_magnitude(&num, digits);
+        power_of_ten(&denom, strlen(dot + 1));
+        free(digits);
+    } else {
+        // Simple integer
+        parse_magnitude(&num, p);
+        nada_big_set_u64(&denom, 1);
     }
 
-    free(s);
-    return result;
+    return num_from_big(&num, &denom, sign);
 }
 
 // Create a copy of a rational number
 NadaNum *nada_num_copy(const NadaNum *num) {
     if (!num) return NULL;
 
-    NadaNum *copy = malloc(sizeof(NadaNum));
+    NadaNum *copy = num_alloc();
     if (!copy) return NULL;
 
-    copy->numerator = strdup(num->numerator);
-    copy->denominator = strdup(num->denominator);
-    copy->sign = num->sign;
+    *copy = *num;
+    if (num->is_big) {
+        nada_big_init(&copy->big.numerator);
+        nada_big_init(&copy->big.denominator);
+        nada_big_set(&copy->big.numerator, &num->big.numerator);
+        nada_big_set(&copy->big.denominator, &num->big.denominator);
+    }
 
     return copy;
 }
@@ -198,163 +184,510 @@ NadaNum *nada_num_copy(const NadaNum *num) {
 void nada_num_free(NadaNum *num) {
     if (!num) return;
 
-    free(num->numerator);
-    free(num->denominator);
+    if (num->is_big) {
+        nada_big_free(&num->big.numerator);
+        nada_big_free(&num->big.denominator);
+    }
     free(num);
 }
 
-// Add two rational numbers
-NadaNum *nada_num_add(const NadaNum *a, const NadaNum *b) {
-    if (!a || !b) return NULL;
+// Add a and b, with the sign of b replaced by b_sign
+static NadaNum *add_signed(const NadaNum *a, const NadaNum *b, int b_sign) {
+    if (!a->is_big && !b->is_big) {
+        // a/b + c/d = (a*(d/g) + c*(b/g)) / (b*(d/g)) with g = gcd(b, d)
+        uint64_t g = nada_big_gcd_u64(a->small.denominator, b->small.denominator);
+        uint64_t a_scale = b->small.denominator / g;
+        uint64_t b_scale = a->small.denominator / g;
+        uint64_t x, y, denominator;
+        if (!__builtin_mul_overflow(a->small.numerator, a_scale, &x) &&
+            !__builtin_mul_overflow(b->small.numerator, b_scale, &y) &&
+            !__builtin_mul_overflow(a->small.denominator, a_scale, &denominator)) {
+            if (a->sign != b_sign) {
+                // Different signs: subtract the smaller from the larger
+                return x >= y ? num_small_reduce(x - y, denominator, a->sign)
+                              : num_small_reduce(y - x, denominator, b_sign);
+            }
+            uint64_t sum;
+            if (!__builtin_add_overflow(x, y, &sum)) {
+                return num_small_reduce(sum, denominator, a->sign);
+            }
+        }
+        // Overflow: fall through to the bignum path
+    }
 
-    // Special case: if either operand is 0
-    if (strcmp(a->numerator, "0") == 0) return nada_num_copy(b);
-    if (strcmp(b->numerator, "0") == 0) return nada_num_copy(a);
-
-    // a/b + c/d = (ad + bc)/bd
-    char *ad = multiply_integers(a->numerator, b->denominator);
-    char *bc = multiply_integers(b->numerator, a->denominator);
-    char *bd = multiply_integers(a->denominator, b->denominator);
-
-    if (!ad || !bc || !bd) {
-        // Handle memory allocation failure
-        free(ad);
-        free(bc);
-        free(bd);
-        return nada_num_from_int(0);
+    bool lazy = defer_reduction(a, b);
+    if (!lazy) {
+        num_normalize(a);
+        num_normalize(b);
     }
 
-    // Apply signs
-    char *numerator = NULL;
-    int sign = 1;
+    BigView av, bv;
+    big_view(a, &av);
+    big_view(b, &bv);
 
-    if (a->sign == b->sign) {
-        // Same sign: add absolute values
-        numerator = add_integers(ad, bc);
-        sign = a->sign;
+    // a/b + c/d = (a*(d/g) + c*(b/g)) / (b*(d/g)) with g = gcd(b, d). The
+    // result can only share a factor of g (Knuth 4.5.1), so it is reduced
+    // with a gcd against g rather than against the full denominator. A lazy
+    // result uses g = 1 and is reduced later.
+    NadaBigInt ad = NADA_BIG_INIT, bc = NADA_BIG_INIT, numerator = NADA_BIG_INIT, denominator = NADA_BIG_INIT;
+    NadaBigInt g = NADA_BIG_INIT;
+    if (nada_big_is_one(&av.denominator) && nada_big_is_one(&bv.denominator)) {
+        nada_big_set(&ad, &av.numerator);
+        nada_big_set(&bc, &bv.numerator);
+        nada_big_set_u64(&denominator, 1);
     } else {
-        // Different signs: subtract the smaller from the larger
-        int cmp = compare_integers(ad, bc);
-        if (cmp >= 0) {
-            numerator = subtract_integers(ad, bc);
-            sign = a->sign;
+        if (!lazy) nada_big_gcd(&g, &av.denominator, &bv.denominator);
+        if (lazy || nada_big_is_one(&g)) {
+            nada_big_mul(&ad, &av.numerator, &bv.denominator);
+            nada_big_mul(&bc, &bv.numerator, &av.denominator);
+            nada_big_mul(&denominator, &av.denominator, &bv.denominator);
         } else {
-            numerator = subtract_integers(bc, ad);
-            sign = b->sign;
+            NadaBigInt a_scale = NADA_BIG_INIT, b_scale = NADA_BIG_INIT;
+            nada_big_divmod(&a_scale, NULL, &bv.denominator, &g);
+            nada_big_divmod(&b_scale, NULL, &av.denominator, &g);
+            nada_big_mul(&ad, &av.numerator, &a_scale);
+            nada_big_mul(&bc, &bv.numerator, &b_scale);
+            nada_big_mul(&denominator, &av.denominator, &a_scale);
+            nada_big_free(&a_scale);
+            nada_big_free(&b_scale);
         }
     }
 
-    if (!numerator) {
-        // Handle memory allocation failure
-        free(ad);
-        free(bc);
-        free(bd);
-        return nada_num_from_int(0);
+    int sign;
+    if (a->sign == b_sign) {
+        // Same sign: add absolute values
+        nada_big_add(&numerator, &ad, &bc);
+        sign = a->sign;
+    } else if (nada_big_cmp(&ad, &bc) >= 0) {
+        // Different signs: subtract the smaller from the larger
+        nada_big_sub(&numerator, &ad, &bc);
+        sign = a->sign;
+    } else {
+        nada_big_sub(&numerator, &bc, &ad);
+        sign = b_sign;
     }
 
-    // Create result
-    NadaNum *result = malloc(sizeof(NadaNum));
-    if (!result) {
-        free(ad);
-        free(bc);
-        free(bd);
-        free(numerator);
-        return NULL;
-    }
+    nada_big_free(&ad);
+    nada_big_free(&bc);
 
-    result->numerator = strdup(numerator);
-    result->denominator = strdup(bd);
+    if (lazy) return num_from_unreduced(&numerator, &denominator, sign);
 
-    // Check for strdup failures
-    if (!result->numerator || !result->denominator) {
-        free(result->numerator);
-        free(result->denominator);
-        free(result);
-        free(ad);
-        free(bc);
-        free(bd);
-        free(numerator);
-        return nada_num_from_int(0);
+    // Cancel what the numerator still shares with g
+    if (g.len != 0 && !nada_big_is_one(&g) && !nada_big_is_zero(&numerator)) {
+        nada_big_gcd(&g, &numerator, &g);
+        if (!nada_big_is_one(&g)) {
+            nada_big_divmod(&numerator, NULL, &numerator, &g);
+            nada_big_divmod(&denominator, NULL, &denominator, &g);
+        }
     }
+    nada_big_free(&g);
+    return num_from_reduced(&numerator, &denominator, sign);
+}
 
-    result->sign = sign;
-
-    if (strcmp(result->numerator, "0") == 0) {
-        result->sign = 1;  // Zero is always positive
+// Add two rational numbers
+NadaNum *nada_num_add(const NadaNum *a, const NadaNum *b) {
+    if (!a || !b) return NULL;
+    if (a->is_flonum || b->is_flonum) {
+        return nada_num_from_double(nada_num_to_double(a) + nada_num_to_double(b));
     }
 
-    // Normalize the fraction
-    normalize(result);
-
-    free(ad);
-    free(bc);
-    free(bd);
-    free(numerator);
+    // Special case: if either operand is 0
+    if (nada_num_is_zero(a)) return nada_num_copy(b);
+    if (nada_num_is_zero(b)) return nada_num_copy(a);
 
-    return result;
+    return add_signed(a, b, b->sign);
 }
 
 // Subtract two rational numbers
 NadaNum *nada_num_subtract(const NadaNum *a, const NadaNum *b) {
     if (!a || !b) return NULL;
+    if (a->is_flonum || b->is_flonum) {
+        return nada_num_from_double(nada_num_to_double(a) - nada_num_to_double(b));
+    }
 
     // a - b = a + (-b)
-    NadaNum *neg_b = nada_num_copy(b);
-    neg_b->sign = -neg_b->sign;
-
-    NadaNum *result = nada_num_add(a, neg_b);
+    if (nada_num_is_zero(b)) return nada_num_copy(a);
+    if (nada_num_is_zero(a)) return nada_num_negate(b);
 
-    nada_num_free(neg_b);
-    return result;
+    return add_signed(a, b, -b->sign);
 }
 
 // Multiply two rational numbers
 NadaNum *nada_num_multiply(const NadaNum *a, const NadaNum *b) {
     if (!a || !b) return NULL;
+    if (a->is_flonum || b->is_flonum) {
+        return nada_num_from_double(nada_num_to_double(a) * nada_num_to_double(b));
+    }
 
     // Special case: if either operand is 0
-    if (strcmp(a->numerator, "0") == 0 || strcmp(b->numerator, "0") == 0) {
+    if (nada_num_is_zero(a) || nada_num_is_zero(b)) {
         return nada_num_from_int(0);
     }
 
-    // a/b * c/d = (a*c)/(b*d)
-    char *ac = multiply_integers(a->numerator, b->numerator);
-    char *bd = multiply_integers(a->denominator, b->denominator);
+    int sign = a->sign * b->sign;
 
-    NadaNum *result = nada_num_from_fraction(ac, bd);
-    if (result) {
-        result->sign = a->sign * b->sign;
+    if (!a->is_big && !b->is_big) {
+        // Cancel across before multiplying, so the result is already reduced
+        uint64_t g1 = nada_big_gcd_u64(a->small.numerator, b->small.denominator);
+        uint64_t g2 = nada_big_gcd_u64(b->small.numerator, a->small.denominator);
+        uint64_t numerator, denominator;
+        if (!__builtin_mul_overflow(a->small.numerator / g1, b->small.numerator / g2, &numerator) &&
+            !__builtin_mul_overflow(a->small.denominator / g2, b->small.denominator / g1, &denominator)) {
+            return num_small(numerator, denominator, sign);
+        }
     }
 
-    free(ac);
-    free(bd);
+    bool lazy = defer_reduction(a, b);
+    if (!lazy) {
+        num_normalize(a);
+        num_normalize(b);
+    }
 
-    return result;
+    BigView av, bv;
+    big_view(a, &av);
+    big_view(b, &bv);
+
+    // a/b * c/d = (a*c)/(b*d), cancelling a with d and c with b first so
+    // the products are already in lowest terms
+    NadaBigInt numerator = NADA_BIG_INIT, denominator = NADA_BIG_INIT;
+    if (lazy) {
+        nada_big_mul(&numerator, &av.numerator, &bv.numerator);
+        nada_big_mul(&denominator, &av.denominator, &bv.denominator);
+        return num_from_unreduced(&numerator, &denominator, sign);
+    }
+
+    NadaBigInt a_num = NADA_BIG_INIT, a_denom = NADA_BIG_INIT, b_num = NADA_BIG_INIT, b_denom = NADA_BIG_INIT;
+    cancel_common(&a_num, &b_denom, &av.numerator, &bv.denominator);
+    cancel_common(&b_num, &a_denom, &bv.numerator, &av.denominator);
+    nada_big_mul(&numerator, &a_num, &b_num);
+    nada_big_mul(&denominator, &a_denom, &b_denom);
+    nada_big_free(&a_num);
+    nada_big_free(&a_denom);
+    nada_big_free(&b_num);
+    nada_big_free(&b_denom);
+
+    return num_from_reduced(&numerator, &denominator, sign);
+}
+
+// N-ary sums and products fold every operand into one running fraction.
+// It stays in machine words while the products fit and moves to bignums
+// when they overflow. Sums put each term over the least common
+// denominator so far, products multiply straight across, and the result
+// is reduced once at the end instead of after every operand.
+
+// Pending factors of a bignum product. Consecutive word factors are
+// gathered in one word, and the partial products form a stack of
+// decreasing sizes where equal sizes are merged, so the multiplications
+// see balanced operands as in a product tree.
+typedef struct {
+    uint64_t word;
+    NadaBigInt *items;
+    size_t count, capacity;
+} ProductStack;
+
+// Push value, taking ownership of it
+static void product_push(ProductStack *ps, NadaBigInt *value) {
+    if (ps->count == ps->capacity) {
+        ps->capacity = ps->capacity ? ps->capacity * 2 : 8;
+        NadaBigInt *items = realloc(ps->items, ps->capacity * sizeof(NadaBigInt));
+        if (!items) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+        ps->items = items;
+    }
+    ps->items[ps->count++] = *value;
+    while (ps->count >= 2 && ps->items[ps->count - 1].len >= ps->items[ps->count - 2].len) {
+        NadaBigInt *top = &ps->items[--ps->count];
+        nada_big_mul(top - 1, top - 1, top);
+        nada_big_free(top);
+    }
+}
+
+static void product_push_u64(ProductStack *ps, uint64_t factor) {
+    uint64_t word;
+    if (__builtin_mul_overflow(ps->word, factor, &word)) {
+        NadaBigInt value = NADA_BIG_INIT;
+        nada_big_set_u64(&value, ps->word);
+        product_push(ps, &value);
+        word = factor;
+    }
+    ps->word = word;
+}
+
+static void product_push_big(ProductStack *ps, const NadaBigInt *factor) {
+    uint64_t word;
+    if (nada_big_to_u64(factor, &word)) {
+        product_push_u64(ps, word);
+        return;
+    }
+    NadaBigInt value = NADA_BIG_INIT;
+    nada_big_set(&value, factor);
+    product_push(ps, &value);
+}
+
+// r = the product of everything pushed; releases the stack
+static void product_finish(ProductStack *ps, NadaBigInt *r) {
+    nada_big_set_u64(r, ps->word);
+    while (ps->count > 0) {
+        NadaBigInt *top = &ps->items[--ps->count];
+        nada_big_mul(r, r, top);
+        nada_big_free(top);
+    }
+    free(ps->items);
+}
+
+typedef struct {
+    int sign;
+    bool is_big;
+    bool in_stacks;                                // A big product
+    uint64_t numerator, denominator;               // Until is_big
+    NadaBigInt big_numerator, big_denominator;     // Sums once is_big
+    ProductStack numerators, denominators;         // Products once is_big
+} Fold;
+
+static void fold_init(Fold *f, uint64_t start) {
+    f->sign = 1;
+    f->is_big = false;
+    f->in_stacks = false;
+    f->numerator = start;
+    f->denominator = 1;
+    nada_big_init(&f->big_numerator);
+    nada_big_init(&f->big_denominator);
+    f->numerators = (ProductStack){1, NULL, 0, 0};
+    f->denominators = (ProductStack){1, NULL, 0, 0};
+}
+
+// The folded value as a number in lowest terms; releases the fold
+static NadaNum *fold_finish(Fold *f) {
+    if (!f->is_big) return num_small_reduce(f->numerator, f->denominator, f->sign);
+    if (f->in_stacks) {
+        product_finish(&f->numerators, &f->big_numerator);
+        product_finish(&f->denominators, &f->big_denominator);
+    }
+    if (nada_big_is_zero(&f->big_numerator)) {
+        nada_big_free(&f->big_numerator);
+        nada_big_free(&f->big_denominator);
+        return nada_num_from_int(0);
+    }
+    return num_from_big(&f->big_numerator, &f->big_denominator, f->sign);
+}
+
+static void fold_add(Fold *f, const NadaNum *term) {
+    if (!f->is_big && !term->is_big) {
+        uint64_t x = f->numerator, y = term->small.numerator, denominator = f->denominator;
+        bool fits = true;
+        if (term->small.denominator != denominator) {
+            uint64_t g = nada_big_gcd_u64(denominator, term->small.denominator);
+            uint64_t scale = term->small.denominator / g;
+            fits = !__builtin_mul_overflow(x, scale, &x) && !__builtin_mul_overflow(y, denominator / g, &y) &&
+                   !__builtin_mul_overflow(denominator, scale, &denominator);
+        }
+        if (fits) {
+            int sign = f->sign;
+            if (sign == term->sign) {
+                fits = !__builtin_add_overflow(x, y, &x);
+            } else if (x >= y) {
+                x -= y;
+            } else {
+                x = y - x;
+                sign = term->sign;
+            }
+            if (fits) {
+                f->numerator = x;
+                f->denominator = denominator;
+                f->sign = sign;
+                return;
+            }
+        }
+    }
+    if (!f->is_big) {
+        nada_big_set_u64(&f->big_numerator, f->numerator);
+        nada_big_set_u64(&f->big_denominator, f->denominator);
+        f->is_big = true;
+    }
+
+    BigView tv;
+    big_view(term, &tv);
+    NadaBigInt t = NADA_BIG_INIT;
+    if (nada_big_cmp(&tv.denominator, &f->big_denominator) == 0) {
+        nada_big_set(&t, &tv.numerator);
+    } else {
+        NadaBigInt g = NADA_BIG_INIT, scale = NADA_BIG_INIT;
+        nada_big_gcd(&g, &f->big_denominator, &tv.denominator);
+        nada_big_divmod(&scale, NULL, &f->big_denominator, &g);
+        nada_big_mul(&t, &tv.numerator, &scale);
+        nada_big_divmod(&scale, NULL, &tv.denominator, &g);
+        nada_big_mul(&f->big_numerator, &f->big_numerator, &scale);
+        nada_big_mul(&f->big_denominator, &f->big_denominator, &scale);
+        nada_big_free(&g);
+        nada_big_free(&scale);
+    }
+
+    if (f->sign == term->sign) {
+        nada_big_add(&f->big_numerator, &f->big_numerator, &t);
+    } else if (nada_big_cmp(&f->big_numerator, &t) >= 0) {
+        nada_big_sub(&f->big_numerator, &f->big_numerator, &t);
+    } else {
+        nada_big_sub(&f->big_numerator, &t, &f->big_numerator);
+        f->sign = term->sign;
+    }
+    nada_big_free(&t);
+}
+
+static void fold_multiply(Fold *f, const NadaNum *term) {
+    f->sign *= term->sign;
+    if (!f->is_big && !term->is_big) {
+        uint64_t x = f->numerator, y = term->small.numerator;
+        uint64_t x_denominator = f->denominator, y_denominator = term->small.denominator;
+        if (x_denominator != 1 || y_denominator != 1) {
+            // Cancelling across is two word gcds and keeps the words small
+            uint64_t g1 = nada_big_gcd_u64(y, x_denominator);
+            uint64_t g2 = nada_big_gcd_u64(x, y_denominator);
+            y /= g1;
+            x_denominator /= g1;
+            x /= g2;
+            y_denominator /= g2;
+        }
+        if (!__builtin_mul_overflow(x, y, &x) &&
+            !__builtin_mul_overflow(x_denominator, y_denominator, &x_denominator)) {
+            f->numerator = x;
+            f->denominator = x_denominator;
+            return;
+        }
+    }
+    if (!f->is_big) {
+        product_push_u64(&f->numerators, f->numerator);
+        product_push_u64(&f->denominators, f->denominator);
+        f->is_big = true;
+        f->in_stacks = true;
+    }
+
+    BigView tv;
+    big_view(term, &tv);
+    product_push_big(&f->numerators, &tv.numerator);
+    if (!nada_big_is_one(&tv.denominator)) {
+        product_push_big(&f->denominators, &tv.denominator);
+    }
+}
+
+// Fold terms[0..count) with fold_step; the first inexact term converts
+// what was folded so far and continues in doubles with combine
+static NadaNum *fold_terms(NadaNum *const *terms, size_t count, uint64_t start,
+                           void (*fold_step)(Fold *, const NadaNum *), double (*combine)(double, double)) {
+    Fold f;
+    fold_init(&f, start);
+    size_t i = 0;
+    for (; i < count && !terms[i]->is_flonum; i++) {
+        fold_step(&f, terms[i]);
+    }
+
+    NadaNum *exact = fold_finish(&f);
+    if (i == count) return exact;
+
+    // A leading inexact term is the start value, which keeps its sign of zero
+    double value = i == 0 ? terms[i++]->flonum : nada_num_to_double(exact);
+    nada_num_free(exact);
+    for (; i < count; i++) {
+        value = combine(value, nada_num_to_double(terms[i]));
+    }
+    return nada_num_from_double(value);
+}
+
+static double double_add(double a, double b) {
+    return a + b;
+}
+
+static double double_multiply(double a, double b) {
+    return a * b;
+}
+
+NadaNum *nada_num_sum(NadaNum *const *terms, size_t count) {
+    return fold_terms(terms, count, 0, fold_add, double_add);
+}
+
+NadaNum *nada_num_product(NadaNum *const *factors, size_t count) {
+    return fold_terms(factors, count, 1, fold_multiply, double_multiply);
 }
 
 // Divide two rational numbers
 NadaNum *nada_num_divide(const NadaNum *a, const NadaNum *b) {
     if (!a || !b) return NULL;
 
+    // Inexact division by zero gives an infinity or NaN, as in IEEE
+    if (a->is_flonum || b->is_flonum) {
+        return nada_num_from_double(nada_num_to_double(a) / nada_num_to_double(b));
+    }
+
     // Check for division by zero
-    if (strcmp(b->numerator, "0") == 0) {
+    if (nada_num_is_zero(b)) {
         fprintf(stderr, "Error: Division by zero\n");
         return nada_num_from_int(0);
     }
 
-    // a/b / c/d = (a/b) * (d/c) = (a*d)/(b*c)
-    char *ad = multiply_integers(a->numerator, b->denominator);
-    char *bc = multiply_integers(a->denominator, b->numerator);
+    if (nada_num_is_zero(a)) {
+        return nada_num_from_int(0);
+    }
 
-    NadaNum *result = nada_num_from_fraction(ad, bc);
-    if (result) {
-        result->sign = a->sign * b->sign;
+    int sign = a->sign * b->sign;
+
+    if (!a->is_big && !b->is_big) {
+        // Multiply by the reciprocal, cancelling across first
+        uint64_t g1 = nada_big_gcd_u64(a->small.numerator, b->small.numerator);
+        uint64_t g2 = nada_big_gcd_u64(b->small.denominator, a->small.denominator);
+        uint64_t numerator, denominator;
+        if (!__builtin_mul_overflow(a->small.numerator / g1, b->small.denominator / g2, &numerator) &&
+            !__builtin_mul_overflow(a->small.denominator / g2, b->small.numerator / g1, &denominator)) {
+            return num_small(numerator, denominator, sign);
+        }
     }
 
-    free(ad);
-    free(bc);
+    bool lazy = defer_reduction(a, b);
+    if (!lazy) {
+        num_normalize(a);
+        num_normalize(b);
+    }
 
-    return result;
+    BigView av, bv;
+    big_view(a, &av);
+    big_view(b, &bv);
+
+    // a/b / c/d = (a/b) * (d/c) = (a*d)/(b*c), cancelling across as in
+    // nada_num_multiply
+    NadaBigInt numerator = NADA_BIG_INIT, denominator = NADA_BIG_INIT;
+    if (lazy) {
+        nada_big_mul(&numerator, &av.numerator, &bv.denominator);
+        nada_big_mul(&denominator, &av.denominator, &bv.numerator);
+        return num_from_unreduced(&numerator, &denominator, sign);
+    }
+
+    NadaBigInt a_num = NADA_BIG_INIT, a_denom = NADA_BIG_INIT, b_num = NADA_BIG_INIT, b_denom = NADA_BIG_INIT;
+    cancel_common(&a_num, &b_num, &av.numerator, &bv.numerator);
+    cancel_common(&a_denom, &b_denom, &av.denominator, &bv.denominator);
+    nada_big_mul(&numerator, &a_num, &b_denom);
+    nada_big_mul(&denominator, &a_denom, &b_num);
+    nada_big_free(&a_num);
+    nada_big_free(&a_denom);
+    nada_big_free(&b_num);
+    nada_big_free(&b_denom);
+
+    return num_from_reduced(&numerator, &denominator, sign);
+}
+
+// Remainder of the absolute values of two integers, with the given sign
+static NadaNum *integer_remainder(const NadaNum *a, const NadaNum *b, int sign) {
+    if (!a->is_big && !b->is_big) {
+        return num_small(a->small.numerator % b->small.numerator, 1, sign);
+    }
+
+    BigView av, bv;
+    big_view(a, &av);
+    big_view(b, &bv);
+
+    NadaBigInt remainder = NADA_BIG_INIT, one = NADA_BIG_INIT;
+    nada_big_divmod(NULL, &remainder, &av.numerator, &bv.numerator);
+    nada_big_set_u64(&one, 1);
+    return num_from_big(&remainder, &one, sign);
 }
 
 // Calculate modulo of two rational numbers
@@ -362,7 +695,7 @@ NadaNum *nada_num_modulo(const NadaNum *a, const NadaNum *b) {
     if (!a || !b) return NULL;
 
     // Check for modulo by zero
-    if (strcmp(b->numerator, "0") == 0) {
+    if (nada_num_is_zero(b)) {
         fprintf(stderr, "Error: Modulo by zero\n");
         return nada_num_from_int(0);
     }
@@ -373,42 +706,29 @@ NadaNum *nada_num_modulo(const NadaNum *a, const NadaNum *b) {
         return nada_num_from_int(0);
     }
 
-    // Get absolute values for the calculation
-    char *a_abs = strdup(a->numerator);
-    char *b_abs = strdup(b->numerator);
-
-    char *remainder = NULL;
-    char *quotient = divide_integers(a_abs, b_abs, &remainder);
-
-    // Create result from remainder, initially with the sign of a
-    NadaNum *result = nada_num_from_fraction(remainder, "1");
-    result->sign = a->sign;
-
-    // Now adjust based on the rules of Scheme's modulo:
-    // In Scheme, modulo returns a result with the same sign as the divisor
-
-    // If signs differ and remainder isn't zero, adjust
-    if (a->sign != b->sign && strcmp(result->numerator, "0") != 0) {
-        // For modulo, we need a value in range [0, |b|)
-        char *b_abs_copy = strdup(b_abs);
-        char *adjusted = subtract_integers(b_abs_copy, remainder);
-
-        free(result->numerator);
-        result->numerator = adjusted;
-        result->sign = b->sign;  // Result takes the sign of divisor
-
-        free(b_abs_copy);
+    if (a->is_flonum || b->is_flonum) {
+        double x = nada_num_to_double(a), y = nada_num_to_double(b);
+        double r = fmod(x, y);
+        if (r != 0 && (r < 0) != (y < 0)) r += y;
+        return nada_num_from_double(r);
     }
 
-    // Ensure zero is always positive
-    if (strcmp(result->numerator, "0") == 0) {
+    NadaNum *result = integer_remainder(a, b, a->sign);
+
+    // In Scheme, modulo returns a result with the same sign as the divisor,
+    // so if the signs differ and the remainder isn't zero, adjust
+    if (a->sign != b->sign && !nada_num_is_zero(result)) {
+        // For modulo, we need a value in range [0, |b|): |b| - remainder
+        NadaNum *abs_b = nada_num_copy(b);
+        abs_b->sign = 1;
         result->sign = 1;
-    }
+        NadaNum *adjusted = nada_num_subtract(abs_b, result);
+        adjusted->sign = b->sign;  // Result takes the sign of divisor
 
-    free(quotient);
-    free(remainder);
-    free(a_abs);
-    free(b_abs);
+        nada_num_free(abs_b);
+        nada_num_free(result);
+        result = adjusted;
+    }
 
     return result;
 }
@@ -418,7 +738,7 @@ NadaNum *nada_num_remainder(const NadaNum *a, const NadaNum *b) {
     if (!a || !b) return NULL;
 
     // Check for division by zero
-    if (strcmp(b->numerator, "0") == 0) {
+    if (nada_num_is_zero(b)) {
         fprintf(stderr, "Error: Remainder by zero\n");
         return nada_num_from_int(0);
     }
@@ -429,72 +749,98 @@ NadaNum *nada_num_remainder(const NadaNum *a, const NadaNum *b) {
         return nada_num_from_int(0);
     }
 
-    // Get absolute values for the calculation
-    char *a_abs = strdup(a->numerator);
-    char *b_abs = strdup(b->numerator);
-
-    char *remainder = NULL;
-    char *quotient = divide_integers(a_abs, b_abs, &remainder);
-
-    // Create result from remainder, with the sign of dividend (a)
-    NadaNum *result = nada_num_from_fraction(remainder, "1");
-    result->sign = a->sign;
-
-    // Ensure zero is always positive
-    if (strcmp(result->numerator, "0") == 0) {
-        result->sign = 1;
+    if (a->is_flonum || b->is_flonum) {
+        return nada_num_from_double(fmod(nada_num_to_double(a), nada_num_to_double(b)));
     }
 
-    free(quotient);
-    free(remainder);
-    free(a_abs);
-    free(b_abs);
-
-    return result;
+    // The result has the sign of dividend (a)
+    return integer_remainder(a, b, a->sign);
 }
 
 // Negate a rational number
 NadaNum *nada_num_negate(const NadaNum *a) {
     if (!a) return NULL;
 
+    if (a->is_flonum) return nada_num_from_double(-a->flonum);
+
     NadaNum *result = nada_num_copy(a);
-    if (result) {
-        result->sign = -result->sign;
-        if (strcmp(result->numerator, "0") == 0) {
-            result->sign = 1;  // Zero is always positive
-        }
+    if (result && !nada_num_is_zero(result)) {
+        result->sign = -result->sign;  // Zero is always positive
     }
 
     return result;
 }
 
+// Compare numbers of which at least one is a flonum: -1, 0 or 1, or 2
+// when a NaN makes them unordered. A finite flonum is compared with an
+// exact number as the exact rational it stands for, not by rounding the
+// exact number to a double.
+static int compare_inexact(const NadaNum *a, const NadaNum *b) {
+    if (a->is_flonum && b->is_flonum) {
+        if (isnan(a->flonum) || isnan(b->flonum)) return 2;
+        return (a->flonum > b->flonum) - (a->flonum < b->flonum);
+    }
+    const NadaNum *flonum = a->is_flonum ? a : b;
+    int order = a->is_flonum ? 1 : -1;  // Flips the result when b is the flonum
+    if (isnan(flonum->flonum)) return 2;
+    if (isinf(flonum->flonum)) return flonum->flonum > 0 ? order : -order;
+
+    NadaNum *exact = nada_num_to_exact(flonum);
+    const NadaNum *other = a->is_flonum ? b : a;
+    int cmp = nada_num_less(exact, other) ? -1 : (nada_num_equal(exact, other) ? 0 : 1);
+    nada_num_free(exact);
+    return cmp * order;
+}
+
 // Check if two rational numbers are equal
 bool nada_num_equal(const NadaNum *a, const NadaNum *b) {
     if (!a || !b) return false;
+    if (a->is_flonum || b->is_flonum) return compare_inexact(a, b) == 0;
+    num_normalize(a);
+    num_normalize(b);
 
     // After normalization, fractions are equal if their
     // numerators, denominators, and signs are identical
-    return a->sign == b->sign &&
-           strcmp(a->numerator, b->numerator) == 0 &&
-           strcmp(a->denominator, b->denominator) == 0;
+    if (a->sign != b->sign || a->is_big != b->is_big) return false;
+    if (!a->is_big) {
+        return a->small.numerator == b->small.numerator &&
+               a->small.denominator == b->small.denominator;
+    }
+    return nada_big_cmp(&a->big.numerator, &b->big.numerator) == 0 &&
+           nada_big_cmp(&a->big.denominator, &b->big.denominator) == 0;
 }
 
 // Check if rational number a is less than b
 bool nada_num_less(const NadaNum *a, const NadaNum *b) {
     if (!a || !b) return false;
+    if (a->is_flonum || b->is_flonum) return compare_inexact(a, b) == -1;
 
     // Different signs
     if (a->sign < b->sign) return true;
     if (a->sign > b->sign) return false;
 
     // Same sign - compare a/b <? c/d by comparing a*d vs b*c
-    char *ad = multiply_integers(a->numerator, b->denominator);
-    char *bc = multiply_integers(b->numerator, a->denominator);
-
-    int cmp = compare_integers(ad, bc);
-
-    free(ad);
-    free(bc);
+    int cmp;
+    uint64_t ad, bc;
+    if (!a->is_big && !b->is_big &&
+        !__builtin_mul_overflow(a->small.numerator, b->small.denominator, &ad) &&
+        !__builtin_mul_overflow(b->small.numerator, a->small.denominator, &bc)) {
+        cmp = (ad > bc) - (ad < bc);
+    } else {
+        BigView av, bv;
+        big_view(a, &av);
+        big_view(b, &bv);
+        if (nada_big_is_one(&av.denominator) && nada_big_is_one(&bv.denominator)) {
+            cmp = nada_big_cmp(&av.numerator, &bv.numerator);
+        } else {
+            NadaBigInt big_ad = NADA_BIG_INIT, big_bc = NADA_BIG_INIT;
+            nada_big_mul(&big_ad, &av.numerator, &bv.denominator);
+            nada_big_mul(&big_bc, &bv.numerator, &av.denominator);
+            cmp = nada_big_cmp(&big_ad, &big_bc);
+            nada_big_free(&big_ad);
+            nada_big_free(&big_bc);
+        }
+    }
 
     // If a->sign is positive, we want ad < bc
     // If a->sign is negative, we want ad > bc (larger negative is less)
@@ -503,7 +849,7 @@ bool nada_num_less(const NadaNum *a, const NadaNum *b) {
 
 // Check if rational number a is greater than b
 bool nada_num_greater(const NadaNum *a, const NadaNum *b) {
-    return !nada_num_less(a, b) && !nada_num_equal(a, b);
+    return nada_num_less(b, a);
 }
 
 // Check if rational number a is less than or equal to b
@@ -513,27 +859,40 @@ bool nada_num_less_equal(const NadaNum *a, const NadaNum *b) {
 
 // Check if rational number a is greater than or equal to b
 bool nada_num_greater_equal(const NadaNum *a, const NadaNum *b) {
-    return !nada_num_less(a, b);
+    return nada_num_less(b, a) || nada_num_equal(a, b);
 }
 
 // Check if a rational number is an integer
 bool nada_num_is_integer(const NadaNum *num) {
     if (!num) return false;
+    if (num->is_flonum) return isfinite(num->flonum) && num->flonum == floor(num->flonum);
+    num_normalize(num);
 
-    return strcmp(num->denominator, "1") == 0;
+    return num->is_big ? nada_big_is_one(&num->big.denominator) : num->small.denominator == 1;
+}
+
+// Check if a number is an integer that fits in an int, and return it
+bool nada_num_fits_int(const NadaNum *num, int *out) {
+    if (num) num_normalize(num);
+    if (!num || num->is_big || num->is_flonum || num->small.denominator != 1 || num->small.numerator > INT_MAX) return false;
+    if (out) *out = (int)num->small.numerator * num->sign;
+    return true;
 }
 
 // Check if a rational number is zero
 bool nada_num_is_zero(const NadaNum *num) {
     if (!num) return false;
 
-    return strcmp(num->numerator, "0") == 0;
+    // Exact zero always has the small form
+    if (num->is_flonum) return num->flonum == 0;
+    return !num->is_big && num->small.numerator == 0;
 }
 
 // Check if a rational number is positive
 bool nada_num_is_positive(const NadaNum *num) {
     if (!num) return false;
 
+    if (num->is_flonum) return num->flonum > 0;
     return num->sign > 0 && !nada_num_is_zero(num);
 }
 
@@ -541,194 +900,231 @@ bool nada_num_is_positive(const NadaNum *num) {
 bool nada_num_is_negative(const NadaNum *num) {
     if (!num) return false;
 
+    if (num->is_flonum) return num->flonum < 0;
     return num->sign < 0 && !nada_num_is_zero(num);
 }
 
-// Convert a rational number to a string
+// Shortest decimal that reads back as the same double, marked inexact
+// with a decimal point or exponent. Magnitudes from 1e-4 up to 1e16 are
+// written positionally, others with an exponent, as Python's repr does.
+static char *flonum_to_string(double value) {
+    if (isnan(value)) return strdup("+nan.0");
+    if (isinf(value)) return strdup(value < 0 ? "-inf.0" : "+inf.0");
+
+    // Shortest significand: "d.ddde+XX"
+    char scientific[40];
+    for (int precision = 0; precision <= 16; precision++) {
+        snprintf(scientific, sizeof(scientific), "%.*e", precision, value);
+        if (strtod(scientific, NULL) == value) break;
+    }
+
+    char digits[20];
+    int count = 0;
+    const char *p = scientific;
+    bool negative = *p == '-';
+    if (negative) p++;
+    for (; *p != 'e'; p++) {
+        if (isdigit((unsigned char)*p)) digits[count++] = *p;
+    }
+    digits[count] = '\0';
+    int exponent = atoi(p + 1);
+
+    char buffer[48];
+    char *out = buffer;
+    if (negative) *out++ = '-';
+    if (exponent < -4 || exponent >= 16) {
+        *out++ = digits[0];
+        if (count > 1) out += sprintf(out, ".%s", digits + 1);
+        sprintf(out, "e%c%02d", exponent < 0 ? '-' : '+', abs(exponent));
+    } else if (exponent < 0) {
+        // 0.000ddd
+        out += sprintf(out, "0.");
+        for (int i = -1; i > exponent; i--) *out++ = '0';
+        strcpy(out, digits);
+    } else if (exponent + 1 >= count) {
+        // ddd000.0
+        out += sprintf(out, "%s", digits);
+        for (int i = count; i <= exponent; i++) *out++ = '0';
+        strcpy(out, ".0");
+    } else {
+        // ddd.ddd
+        memcpy(out, digits, exponent + 1);
+        out += exponent + 1;
+        sprintf(out, ".%s", digits + exponent + 1);
+    }
+    return strdup(buffer);
+}
+
+// Convert a number to a string
 char *nada_num_to_string(const NadaNum *num) {
     if (!num) return NULL;
+    if (num->is_flonum) return flonum_to_string(num->flonum);
+    num_normalize(num);
 
-    // Special case for zero
-    if (strcmp(num->numerator, "0") == 0) {
-        return strdup("0");
+    if (!num->is_big) {
+        char buffer[48];  // Sign, two 20-digit numbers, slash
+        if (num->small.denominator == 1) {
+            snprintf(buffer, sizeof(buffer), "%s%" PRIu64, (num->sign < 0 ? "-" : ""), num->small.numerator);
+        } else {
+            snprintf(buffer, sizeof(buffer), "%s%" PRIu64 "/%" PRIu64, (num->sign < 0 ? "-" : ""),
+                     num->small.numerator, num->small.denominator);
+        }
+        return strdup(buffer);
     }
 
+    char *numerator = nada_big_to_decimal(&num->big.numerator);
+    if (!numerator) return NULL;
+
     // Integer case
-    if (strcmp(num->denominator, "1") == 0) {
-        char *result = malloc(strlen(num->numerator) + 2);  // +2 for sign and null terminator
-        if (!result) return NULL;
+    if (nada_big_is_one(&num->big.denominator)) {
+        if (num->sign > 0) return numerator;
 
-        sprintf(result, "%s%s", (num->sign < 0 ? "-" : ""), num->numerator);
+        char *result = malloc(strlen(numerator) + 2);  // +2 for sign and null terminator
+        if (result) sprintf(result, "-%s", numerator);
+        free(numerator);
         return result;
     }
 
     // Fraction case
-    char *result = malloc(strlen(num->numerator) + strlen(num->denominator) + 3);  // +3 for sign, slash, and null terminator
-    if (!result) return NULL;
+    char *denominator = nada_big_to_decimal(&num->big.denominator);
+    char *result = denominator ? malloc(strlen(numerator) + strlen(denominator) + 3) : NULL;  // +3 for sign, slash, and null terminator
+    if (result) {
+        sprintf(result, "%s%s/%s", (num->sign < 0 ? "-" : ""), numerator, denominator);
+    }
 
-    sprintf(result, "%s%s/%s", (num->sign < 0 ? "-" : ""), num->numerator, num->denominator);
+    free(numerator);
+    free(denominator);
     return result;
 }
 
-// Add this function declaration to the forward declarations section
-static char *divide_with_precision(const char *numerator, const char *denominator, int precision);
-
-// Add this function to the public interface section
 // Convert a rational number to a floating-point string with specified precision
+// (digits after the decimal point are truncated, not rounded)
 char *nada_num_to_float_string(const NadaNum *num, int precision) {
     if (!num || precision < 0) return NULL;
-
-    // Special case for zero
-    if (strcmp(num->numerator, "0") == 0) {
-        char *result = malloc(precision + 3);  // "0." + precision zeros + null
-        if (!result) return NULL;
-
-        strcpy(result, "0.");
-        for (int i = 0; i < precision; i++) {
-            result[i + 2] = '0';
-        }
-        result[precision + 2] = '\0';
+    if (num->is_flonum) {
+        NadaNum *exact = nada_num_to_exact(num);
+        if (!exact) return flonum_to_string(num->flonum);
+        char *result = nada_num_to_float_string(exact, precision);
+        nada_num_free(exact);
         return result;
     }
 
-    // Do the division with specified precision
-    char *abs_result = divide_with_precision(num->numerator, num->denominator, precision);
-    if (!abs_result) return NULL;
+    BigView view;
+    big_view(num, &view);
 
-    // Add sign if negative
-    if (num->sign < 0) {
-        char *signed_result = malloc(strlen(abs_result) + 2);
-        if (!signed_result) {
-            free(abs_result);
-            return NULL;
-        }
-        sprintf(signed_result, "-%s", abs_result);
-        free(abs_result);
-        return signed_result;
-    }
+    // Integer part and remainder of the division
+    NadaBigInt quotient = NADA_BIG_INIT, remainder = NADA_BIG_INIT, scale = NADA_BIG_INIT;
+    nada_big_divmod(&quotient, &remainder, &view.numerator, &view.denominator);
 
-    return abs_result;
-}
+    // Fractional digits: remainder * 10^precision / denominator
+    power_of_ten(&scale, (size_t)precision);
+    nada_big_mul(&remainder, &remainder, &scale);
+    nada_big_divmod(&remainder, NULL, &remainder, &view.denominator);
 
-// Helper function to perform division with specified decimal precision
-static char *divide_with_precision(const char *numerator, const char *denominator, int precision) {
-    if (!numerator || !denominator || strcmp(denominator, "0") == 0) return NULL;
+    char *integer_part = nada_big_to_decimal(&quotient);
+    char *fraction = nada_big_to_decimal(&remainder);
+    nada_big_free(&quotient);
+    nada_big_free(&remainder);
+    nada_big_free(&scale);
 
-    // First compute the integer part
-    char *remainder = NULL;
-    char *quotient = divide_integers(numerator, denominator, &remainder);
-    if (!quotient || !remainder) {
-        free(quotient);
-        free(remainder);
-        return NULL;
+    char *result = NULL;
+    if (integer_part && fraction) {
+        // Sign + integer + "." + zero-padded fraction + null
+        result = malloc(strlen(integer_part) + precision + 3);
     }
-
-    // Check if remainder is zero - exact division
-    if (strcmp(remainder, "0") == 0) {
-        char *result = malloc(strlen(quotient) + precision + 3);
-        if (!result) {
-            free(quotient);
-            free(remainder);
-            return NULL;
-        }
-
-        sprintf(result, "%s.", quotient);
-        for (int i = 0; i < precision; i++) {
-            strcat(result, "0");
+    if (result) {
+        char *p = result + sprintf(result, "%s%s.", (num->sign < 0 ? "-" : ""), integer_part);
+        if (precision > 0) {
+            size_t pad = precision - strlen(fraction);
+            memset(p, '0', pad);
+            strcpy(p + pad, fraction);
         }
-
-        free(quotient);
-        free(remainder);
-        return result;
-    }
-
-    // Calculate fractional part via long division
-    char *fractional = malloc(precision + 1);
-    if (!fractional) {
-        free(quotient);
-        free(remainder);
-        return NULL;
     }
 
-    for (int i = 0; i < precision; i++) {
-        // Multiply remainder by 10
-        char *temp = multiply_integers(remainder, "10");
-        free(remainder);
-        remainder = temp;
-
-        // Divide by denominator, storing the new remainder in a different variable
-        char *new_remainder = NULL;
-        char *digit_quotient = divide_integers(remainder, denominator, &new_remainder);
-
-        // Free the old remainder now that we have a new one
-        free(remainder);
-
-        // Update our remainder pointer to the newly allocated one
-        remainder = new_remainder;
+    free(integer_part);
+    free(fraction);
+    return result;
+}
 
-        // Extract the first digit
-        fractional[i] = digit_quotient[0];
+// Convert a rational number to an integer (truncating)
+int nada_num_to_int(const NadaNum *num) {
+    if (!num) return 0;
+    if (num->is_flonum) return (int)num->flonum;
 
-        // Free the quotient now that we've used it
-        free(digit_quotient);
+    uint64_t magnitude = 0;
+    if (!num->is_big) {
+        magnitude = num->small.numerator / num->small.denominator;
+    } else {
+        NadaBigInt quotient = NADA_BIG_INIT;
+        nada_big_divmod(&quotient, NULL, &num->big.numerator, &num->big.denominator);
 
-        // If remainder becomes zero, we can stop early
-        if (strcmp(remainder, "0") == 0) {
-            // Pad the rest with zeros
-            for (int j = i + 1; j < precision; j++) {
-                fractional[j] = '0';
-            }
-            break;
+        // Values beyond 64 bits keep their low limbs, like a C integer cast
+        if (!nada_big_to_u64(&quotient, &magnitude)) {
+            magnitude = ((uint64_t)quotient.limbs[1] << NADA_LIMB_BITS) | quotient.limbs[0];
         }
+        nada_big_free(&quotient);
     }
-    fractional[precision] = '\0';
 
-    // Combine integer and fractional parts
-    char *result = malloc(strlen(quotient) + precision + 3);  // Integer + "." + fractional + null
-    if (!result) {
-        free(quotient);
-        free(remainder);
-        free(fractional);
-        return NULL;
-    }
+    return (int)(num->sign < 0 ? -magnitude : magnitude);
+}
 
-    sprintf(result, "%s.%s", quotient, fractional);
+// Convert a rational number to a double
+double nada_num_to_double(const NadaNum *num) {
+    if (!num) return 0.0;
+    if (num->is_flonum) return num->flonum;
 
-    // Clean up
-    free(quotient);
-    free(remainder);
-    free(fractional);
+    // Both parts exact in a double: one IEEE division rounds correctly
+    const uint64_t exact_limit = (uint64_t)1 << 53;
+    if (!num->is_big && num->small.numerator <= exact_limit && num->small.denominator <= exact_limit) {
+        return ((double)num->small.numerator / (double)num->small.denominator) * num->sign;
+    }
 
-    return result;
+    BigView view;
+    big_view(num, &view);
+    return big_ratio_to_double(&view.numerator, &view.denominator) * num->sign;
 }
 
-// Convert a rational number to an integer
-int nada_num_to_int(const NadaNum *num) {
-    if (!num) return 0;
-
-    // Calculate division
-    char *remainder = NULL;
-    char *quotient = divide_integers(num->numerator, num->denominator, &remainder);
+// Check whether a number is exact (rational) rather than a flonum
+bool nada_num_is_exact(const NadaNum *num) {
+    return num && !num->is_flonum;
+}
 
-    // Convert to integer
-    int result = atoi(quotient) * num->sign;
+// Exact rational with the value of num; every finite double is one
+NadaNum *nada_num_to_exact(const NadaNum *num) {
+    if (!num) return NULL;
+    if (!num->is_flonum) return nada_num_copy(num);
 
-    free(quotient);
-    free(remainder);
+    if (!isfinite(num->flonum)) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "No exact representation for %s",
+                          isnan(num->flonum) ? "+nan.0" : "an infinity");
+        return NULL;
+    }
 
-    return result;
+    // |value| = mantissa * 2^exponent with a 53-bit integer mantissa
+    int exponent;
+    double fraction = frexp(fabs(num->flonum), &exponent);
+    uint64_t mantissa = (uint64_t)ldexp(fraction, 53);
+    exponent -= 53;
+    if (mantissa == 0) return nada_num_from_int(0);
+    int shift = __builtin_ctzll(mantissa);
+    mantissa >>= shift;
+    exponent += shift;
+
+    NadaBigInt numerator = NADA_BIG_INIT, denominator = NADA_BIG_INIT;
+    nada_big_set_u64(&numerator, mantissa);
+    nada_big_set_u64(&denominator, 1);
+    if (exponent > 0) {
+        nada_big_shl(&numerator, &numerator, (size_t)exponent);
+    } else {
+        nada_big_shl(&denominator, &denominator, (size_t)-exponent);
+    }
+    return num_from_reduced(&numerator, &denominator, num->sign);
 }
 
-// Convert a rational number to a double
-double nada_num_to_double(const NadaNum *num) {
-    if (!num) return 0.0;
-
-    // We could use arbitrary precision division here for better accuracy,
-    // but for simplicity, we'll convert the strings to doubles and divide
-    double numer = atof(num->numerator);
-    double denom = atof(num->denominator);
-
-    return (numer / denom) * num->sign;
+// Nearest flonum to num
+NadaNum *nada_num_to_inexact(const NadaNum *num) {
+    if (!num) return NULL;
+    return nada_num_from_double(nada_num_to_double(num));
 }
 
 // Check if a string is a valid number
@@ -748,7 +1144,14 @@ bool nada_is_valid_number_string(const char *str) {
     bool has_dot = false;
 
     while (*p) {
-        if (*p == '/') {
+        if ((*p == 'e' || *p == 'E') && !has_slash && isdigit((unsigned char)p[-1])) {
+            // Exponent: optional sign and at least one digit, nothing else
+            p++;
+            if (*p == '+' || *p == '-') p++;
+            if (!isdigit((unsigned char)*p)) return false;
+            while (isdigit((unsigned char)*p)) p++;
+            return *p == '\0';
+        } else if (*p == '/') {
             if (has_slash || has_dot) return false;  // Only one slash allowed, no slash after decimal
             has_slash = true;
         } else if (*p == '.') {
@@ -766,9 +1169,22 @@ bool nada_is_valid_number_string(const char *str) {
     return true;
 }
 
+// base^e in a machine word; false on overflow
+static bool u64_pow(uint64_t base, uint64_t e, uint64_t *out) {
+    uint64_t result = 1;
+    while (e > 0) {
+        if ((e & 1) && __builtin_mul_overflow(result, base, &result)) return false;
+        e >>= 1;
+        if (e > 0 && __builtin_mul_overflow(base, base, &base)) return false;
+    }
+    *out = result;
+    return true;
+}
+
 // Compute integer exponent power exactly
 NadaNum *nada_num_int_expt(const NadaNum *base, int exponent) {
     if (!base) return NULL;
+    if (base->is_flonum) return nada_num_from_double(pow(base->flonum, exponent));
 
     // Handle special cases
     if (exponent == 0) {
@@ -784,437 +1200,330 @@ NadaNum *nada_num_int_expt(const NadaNum *base, int exponent) {
         }
     }
 
-    // Handle negative exponents
-    if (exponent < 0) {
-        // For negative exponent, compute 1/(base^(-exponent))
-        NadaNum *temp = nada_num_int_expt(base, -exponent);
-        if (!temp) return NULL;  // Propagate error
+    // (a/b)^e = a^e / b^e is in lowest terms when a/b is, and a negative
+    // exponent just swaps the two
+    num_normalize(base);
+    uint64_t e = exponent < 0 ? -(uint64_t)(int64_t)exponent : (uint64_t)exponent;
+    int sign = (base->sign < 0 && (e & 1)) ? -1 : 1;
 
-        NadaNum *one = nada_num_from_int(1);
-        NadaNum *result = nada_num_divide(one, temp);
-
-        // Free temporary values
-        nada_num_free(one);
-        nada_num_free(temp);
-
-        return result;
+    uint64_t small_num, small_denom;
+    if (!base->is_big && u64_pow(base->small.numerator, e, &small_num) &&
+        u64_pow(base->small.denominator, e, &small_denom)) {
+        return exponent > 0 ? num_small(small_num, small_denom, sign) : num_small(small_denom, small_num, sign);
     }
 
-    // Use binary exponentiation for efficiency
-    NadaNum *result = nada_num_from_int(1);
-    NadaNum *current = nada_num_copy(base);
+    // Square-and-multiply on the magnitudes
+    BigView view;
+    big_view(base, &view);
+    NadaBigInt numerator = NADA_BIG_INIT, denominator = NADA_BIG_INIT;
+    nada_big_pow(&numerator, &view.numerator, e);
+    nada_big_pow(&denominator, &view.denominator, e);
+    if (exponent < 0) nada_big_swap(&numerator, &denominator);
 
-    while (exponent > 0) {
-        if (exponent % 2 == 1) {
-            // This is where the leak likely happened - need to store temp and free old result
-            NadaNum *temp = nada_num_multiply(result, current);
-            nada_num_free(result);  // Free old result
-            result = temp;
-        }
-
-        exponent /= 2;
-        if (exponent > 0) {
-            // Same here - store temp and free old current
-            NadaNum *temp = nada_num_multiply(current, current);
-            nada_num_free(current);  // Free old current
-            current = temp;
-        }
-    }
-
-    nada_num_free(current);
-    return result;
+    return num_from_reduced(&numerator, &denominator, sign);
 }
 
-// Helper function implementations
-
-// Add two arbitrary precision integers
-static char *add_integers(const char *a, const char *b) {
-    if (!a || !b) return NULL;
-
-    // Determine the longer number
-    size_t len_a = strlen(a);
-    size_t len_b = strlen(b);
-    size_t max_len = len_a > len_b ? len_a : len_b;
-
-    // Allocate result with space for a possible carry
-    char *result = malloc(max_len + 2);
-    if (!result) return NULL;
-
-    // Initialize the whole buffer with zeros to prevent issues
-    memset(result, 0, max_len + 2);
+// Compute base^exponent mod modulus for integers without forming the power
+NadaNum *nada_num_expt_mod(const NadaNum *base, const NadaNum *exponent, const NadaNum *modulus) {
+    if (!base || !exponent || !modulus) return NULL;
 
-    int carry = 0;
-    size_t i = 0;
-
-    // Add digits from right to left (least significant first)
-    while (i < max_len || carry) {
-        int digit_a = (i < len_a) ? a[len_a - 1 - i] - '0' : 0;
-        int digit_b = (i < len_b) ? b[len_b - 1 - i] - '0' : 0;
-
-        int sum = digit_a + digit_b + carry;
-        carry = sum / 10;
-
-        // Write digit from right to left
-        result[max_len + 1 - i - 1] = (sum % 10) + '0';
-        i++;
+    if (!nada_num_is_integer(base) || !nada_num_is_integer(exponent) || !nada_num_is_integer(modulus) ||
+        base->is_flonum || exponent->is_flonum || modulus->is_flonum) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "expt-mod requires exact integer arguments");
+        return NULL;
     }
-
-    // Find where the number actually starts (skipping leading zeros)
-    char *start = result;
-    while (*start == 0 || *start == '0') {
-        if (*(start + 1) == '\0') break;  // Keep at least one digit
-        start++;
+    if (nada_num_is_negative(exponent)) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "expt-mod requires a non-negative exponent");
+        return NULL;
     }
-
-    // Move the result to the beginning of the buffer
-    char *final_result = strdup(start);
-    free(result);
-
-    return final_result;
-}
-
-// Subtract two arbitrary precision integers (assumes a >= b)
-static char *subtract_integers(const char *a, const char *b) {
-    if (!a || !b) return NULL;
-
-    // If a < b, return "0" (this function assumes a >= b)
-    if (compare_integers(a, b) < 0) {
-        return strdup("0");
+    if (!nada_num_is_positive(modulus)) {
+        nada_report_error(NADA_ERROR_INVALID_ARGUMENT, "expt-mod requires a positive modulus");
+        return NULL;
     }
 
-    size_t len_a = strlen(a);
-    size_t len_b = strlen(b);
-
-    // Allocate result
-    char *result = malloc(len_a + 1);
-    if (!result) return NULL;
-
-    int borrow = 0;
-    size_t i = 0;
+    BigView bv, ev, mv;
+    big_view(base, &bv);
+    big_view(exponent, &ev);
+    big_view(modulus, &mv);
 
-    // Subtract digits from right to left
-    while (i < len_a) {
-        int digit_a = a[len_a - 1 - i] - '0';
-        int digit_b = (i < len_b) ? b[len_b - 1 - i] - '0' : 0;
-
-        int diff = digit_a - digit_b - borrow;
-
-        if (diff < 0) {
-            diff += 10;
-            borrow = 1;
-        } else {
-            borrow = 0;
-        }
-
-        result[len_a - 1 - i] = diff + '0';
-        i++;
+    // Reduce the base into [0, modulus), as modulo does
+    NadaBigInt reduced = NADA_BIG_INIT, result = NADA_BIG_INIT, one = NADA_BIG_INIT;
+    nada_big_divmod(NULL, &reduced, &bv.numerator, &mv.numerator);
+    if (base->sign < 0 && !nada_big_is_zero(&reduced)) {
+        nada_big_sub(&reduced, &mv.numerator, &reduced);
     }
 
-    result[len_a] = '\0';
-
-    // Remove leading zeros
-    char *cleaned = strip_leading_zeros(result);
-    free(result);
-
-    // If result is empty, return "0"
-    if (!cleaned || cleaned[0] == '\0') {
-        free(cleaned);
-        return strdup("0");
+    // Word-sized moduli keep every product in a machine word
+    uint64_t m, b, e;
+    if (nada_big_to_u64(&mv.numerator, &m) && m <= UINT32_MAX && nada_big_to_u64(&ev.numerator, &e)) {
+        nada_big_to_u64(&reduced, &b);
+        uint64_t r = 1 % m;
+        for (; e > 0; e >>= 1) {
+            if (e & 1) r = r * b % m;
+            b = b * b % m;
+        }
+        nada_big_free(&reduced);
+        return num_small(r, 1, 1);
     }
 
-    return cleaned;
+    nada_big_powmod(&result, &reduced, &ev.numerator, &mv.numerator);
+    nada_big_set_u64(&one, 1);
+    nada_big_free(&reduced);
+    return num_from_reduced(&result, &one, 1);
 }
 
-// Multiply two arbitrary precision integers using the grade-school algorithm
-static char *multiply_integers(const char *a, const char *b) {
-    if (!a || !b) return NULL;
+NadaNum *nada_num_exact_integer_root(const NadaNum *n, int k) {
+    if (!n) return NULL;
 
-    // Special case for zero
-    if (strcmp(a, "0") == 0 || strcmp(b, "0") == 0) {
-        return strdup("0");
-    }
-
-    size_t len_a = strlen(a);
-    size_t len_b = strlen(b);
-    size_t result_len = len_a + len_b;
-
-    // Allocate and initialize result array with zeros
-    int *result_arr = calloc(result_len, sizeof(int));
-    if (!result_arr) return NULL;
-
-    // Multiply each digit of b with each digit of a
-    for (size_t i = 0; i < len_a; i++) {
-        for (size_t j = 0; j < len_b; j++) {
-            int digit_a = a[len_a - 1 - i] - '0';
-            int digit_b = b[len_b - 1 - j] - '0';
-
-            result_arr[i + j] += digit_a * digit_b;
-        }
-    }
+    // The builtins report invalid arguments under their own names
+    if (n->is_flonum || !nada_num_is_integer(n) || nada_num_is_negative(n) || k < 1) return NULL;
 
-    // Handle carries
-    for (size_t i = 0; i < result_len - 1; i++) {
-        result_arr[i + 1] += result_arr[i] / 10;
-        result_arr[i] %= 10;
-    }
-
-    // Convert result to string
-    char *result_str = malloc(result_len + 1);
-    if (!result_str) {
-        free(result_arr);
-        return NULL;
-    }
+    BigView nv;
+    big_view(n, &nv);
+    NadaBigInt root = NADA_BIG_INIT, one = NADA_BIG_INIT;
+    nada_big_root(&root, &nv.numerator, (uint64_t)k);
+    nada_big_set_u64(&one, 1);
+    return num_from_reduced(&root, &one, 1);
+}
 
-    // Find the actual length (ignoring leading zeros)
-    size_t actual_len = result_len;
-    while (actual_len > 1 && result_arr[actual_len - 1] == 0) {
-        actual_len--;
-    }
+// Helper function implementations
 
-    // Copy digits to result string (in reverse order)
-    for (size_t i = 0; i < actual_len; i++) {
-        result_str[actual_len - 1 - i] = result_arr[i] + '0';
-    }
-    result_str[actual_len] = '\0';
+// Allocate a zero in the small form
+static NadaNum *num_alloc(void) {
+    NadaNum *num = malloc(sizeof(NadaNum));
+    if (!num) return NULL;
 
-    free(result_arr);
-    return result_str;
+    num->sign = 1;
+    num->is_big = false;
+    num->is_flonum = false;
+    num->unreduced = false;
+    num->small.numerator = 0;
+    num->small.denominator = 1;
+    return num;
 }
 
-// Divide two arbitrary precision integers (long division algorithm)
-static char *divide_integers(const char *a, const char *b, char **remainder) {
-    // Check for null inputs
-    if (!a || !b) {
-        if (remainder) *remainder = strdup("0");
-        return NULL;
-    }
-
-    // Check for division by zero
-    if (strcmp(b, "0") == 0) {
-        fprintf(stderr, "Error: Division by zero\n");
-        if (remainder) *remainder = strdup("0");
-        return strdup("0");
-    }
+// Small number from a fraction that is already in lowest terms
+static NadaNum *num_small(uint64_t numerator, uint64_t denominator, int sign) {
+    NadaNum *num = num_alloc();
+    if (!num) return NULL;
 
-    // If a < b, quotient is 0, remainder is a
-    if (compare_integers(a, b) < 0) {
-        if (remainder) *remainder = strdup(a);
-        return strdup("0");
-    }
+    num->small.numerator = numerator;
+    num->small.denominator = numerator == 0 ? 1 : denominator;
+    num->sign = numerator == 0 ? 1 : sign;  // Zero is always positive
+    return num;
+}
 
-    // If a == b, quotient is 1, remainder is 0
-    if (compare_integers(a, b) == 0) {
-        if (remainder) *remainder = strdup("0");
-        return strdup("1");
+// Small number from any fraction, reduced to lowest terms
+static NadaNum *num_small_reduce(uint64_t numerator, uint64_t denominator, int sign) {
+    if (denominator != 1) {
+        uint64_t g = nada_big_gcd_u64(numerator, denominator);
+        numerator /= g;
+        denominator /= g;
     }
+    return num_small(numerator, denominator, sign);
+}
 
-    // Long division algorithm
-    size_t len_a = strlen(a);
-    size_t len_b = strlen(b);
-    size_t len_q = len_a - len_b + 1;  // Maximum possible quotient length
-
-    char *quotient = malloc(len_q + 1);
-    if (!quotient) {
-        if (remainder) *remainder = strdup("0");
-        return NULL;
+// Number from bignum magnitudes, taking ownership of them. The fraction is
+// reduced to lowest terms and stored in the small form if it fits.
+static NadaNum *num_from_big(NadaBigInt *numerator, NadaBigInt *denominator, int sign) {
+    if (!nada_big_is_zero(numerator) && !nada_big_is_one(denominator)) {
+        NadaBigInt g = NADA_BIG_INIT;
+        nada_big_gcd(&g, numerator, denominator);
+        if (!nada_big_is_one(&g)) {
+            nada_big_divmod(numerator, NULL, numerator, &g);
+            nada_big_divmod(denominator, NULL, denominator, &g);
+        }
+        nada_big_free(&g);
     }
+    return num_from_reduced(numerator, denominator, sign);
+}
 
-    // Initialize quotient with zeros
-    memset(quotient, '0', len_q);
-    quotient[len_q] = '\0';
-
-    // Working copy of the dividend
-    char *working = malloc(len_a + 1);
-    if (!working) {
-        free(quotient);
-        if (remainder) *remainder = strdup("0");
-        return NULL;
+// Like num_from_big for a fraction already in lowest terms
+static NadaNum *num_from_reduced(NadaBigInt *numerator, NadaBigInt *denominator, int sign) {
+    uint64_t small_num, small_denom;
+    if (nada_big_to_u64(numerator, &small_num) && nada_big_to_u64(denominator, &small_denom)) {
+        nada_big_free(numerator);
+        nada_big_free(denominator);
+        return num_small(small_num, small_denom, sign);
     }
-    strcpy(working, a);
-
-    // Process each digit of the quotient
-    for (size_t i = 0; i < len_q; i++) {
-        // Current divisor position
-        size_t pos = i;
-
-        // Try each digit (9 to 0)
-        for (int digit = 9; digit >= 0; digit--) {
-            // Set current quotient digit
-            quotient[pos] = digit + '0';
-
-            // Calculate product of partial quotient and divisor
-            char partial_quotient[len_q + 1];
-            memset(partial_quotient, '0', len_q);
-            partial_quotient[pos] = digit + '0';
-            partial_quotient[len_q] = '\0';
-
-            char *product = multiply_integers(partial_quotient, b);
-            if (!product) {
-                free(working);
-                free(quotient);
-                if (remainder) *remainder = strdup("0");
-                return strdup("0");
-            }
-
-            // If product <= working substring, we found the digit
-            if (compare_integers(product, working) <= 0) {
-                // Subtract product from working
-                char *new_working = subtract_integers(working, product);
-                free(product);  // Free product immediately
-
-                if (!new_working) {
-                    // Handle allocation failure
-                    free(working);
-                    free(quotient);
-                    if (remainder) *remainder = strdup("0");
-                    return strdup("0");
-                }
-
-                // Free old working and replace with new
-                free(working);
-                working = new_working;
-                break;
-            }
 
-            free(product);  // Free product if not used
-        }
-    }
+    NadaNum *num = num_alloc();
+    if (!num) return NULL;
 
-    // Handle remainder
-    if (remainder) {
-        const char *p = working;
-        // Skip leading zeros, but keep last digit if all zeros
-        while (*p == '0' && *(p + 1) != '\0') {
-            p++;
-        }
-        *remainder = strdup(p);  // This is where the leak occurs at line 1536
-    }
+    num->is_big = true;
+    num->big.numerator = *numerator;
+    num->big.denominator = *denominator;
+    num->sign = sign;
+    return num;
+}
 
-    // Clean up quotient - remove leading zeros
-    char *cleaned_quotient = NULL;
-    const char *q = quotient;
-    while (*q == '0' && *(q + 1) != '\0') {
-        q++;
+// Like num_from_big, but a big result is left unreduced. The small form
+// is always reduced, as that costs only a word gcd.
+static NadaNum *num_from_unreduced(NadaBigInt *numerator, NadaBigInt *denominator, int sign) {
+    uint64_t small_num, small_denom;
+    if (nada_big_to_u64(numerator, &small_num) && nada_big_to_u64(denominator, &small_denom)) {
+        nada_big_free(numerator);
+        nada_big_free(denominator);
+        return num_small_reduce(small_num, small_denom, sign);
     }
-    cleaned_quotient = strdup(q);
-
-    // IMPORTANT: Free temporary buffers
-    free(quotient);
-    free(working);  // Free working copy in all cases
 
-    return cleaned_quotient ? cleaned_quotient : strdup("0");
+    NadaNum *num = num_from_reduced(numerator, denominator, sign);
+    if (num) num->unreduced = !nada_big_is_one(&num->big.denominator);
+    return num;
 }
 
-// Compare two arbitrary precision integers
-static int compare_integers(const char *a, const char *b) {
-    if (!a || !b) return 0;
-
-    // Remove leading zeros
-    while (*a == '0' && *(a + 1) != '\0')
-        a++;
-    while (*b == '0' && *(b + 1) != '\0')
-        b++;
+// Limbs in the numerator and denominator of num
+static size_t num_limbs(const NadaNum *num) {
+    return num->is_big ? num->big.numerator.len + num->big.denominator.len : 4;
+}
 
-    // Different lengths
-    size_t len_a = strlen(a);
-    size_t len_b = strlen(b);
+// Whether an operation on a and b may leave its result unreduced
+static bool defer_reduction(const NadaNum *a, const NadaNum *b) {
+    return num_limbs(a) + num_limbs(b) < nada_num_lazy_limbs;
+}
 
-    if (len_a > len_b) return 1;
-    if (len_a < len_b) return -1;
+// Bring an unreduced number to lowest terms. This does not change its
+// value, so it is done in place even through a const pointer.
+static void num_normalize(const NadaNum *num) {
+    if (!num->is_big || !num->unreduced) return;
 
-    // Same length, compare digit by digit
-    return strcmp(a, b);
+    NadaNum *target = (NadaNum *)num;
+    NadaNum *reduced = num_from_big(&target->big.numerator, &target->big.denominator, target->sign);
+    if (!reduced) return;
+    *target = *reduced;
+    free(reduced);
 }
 
-// Calculate greatest common divisor (GCD) using Euclidean algorithm
-static char *gcd(const char *a, const char *b) {
-    if (!a || !b) return strdup("1");  // Safe default
-
-    // Base case: GCD(a, 0) = a
-    if (strcmp(b, "0") == 0) {
-        return strdup(a);
+// x = a / g and y = b / g with g = gcd(a, b)
+static void cancel_common(NadaBigInt *x, NadaBigInt *y, const NadaBigInt *a, const NadaBigInt *b) {
+    NadaBigInt g = NADA_BIG_INIT;
+    if (!nada_big_is_one(a) && !nada_big_is_one(b)) {
+        nada_big_gcd(&g, a, b);
     }
-
-    // Calculate a % b
-    char *remainder = NULL;
-    char *quotient = divide_integers(a, b, &remainder);
-    free(quotient);  // We don't need the quotient
-
-    if (!remainder) return strdup("1");  // Error fallback
-
-    // Recursively calculate GCD(b, a % b)
-    char *result = gcd(b, remainder);
-
-    free(remainder);
-    return result;
+    if (g.len == 0 || nada_big_is_one(&g)) {
+        nada_big_set(x, a);
+        nada_big_set(y, b);
+    } else {
+        nada_big_divmod(x, NULL, a, &g);
+        nada_big_divmod(y, NULL, b, &g);
+    }
+    nada_big_free(&g);
 }
 
-// Normalize a rational number (reduce to lowest terms)
-static void normalize(NadaNum *num) {
-    if (!num || !num->numerator || !num->denominator) return;
-
-    // Special case: if numerator is 0, set denominator to 1
-    if (strcmp(num->numerator, "0") == 0) {
-        free(num->denominator);
-        num->denominator = strdup("1");
-        if (!num->denominator) {
-            num->denominator = strdup("1");  // Try once more
-        }
-        num->sign = 1;  // Zero is always positive
+// Fill view with the magnitudes of num; a view of a small number points
+// into its own storage and must not be copied
+static void big_view(const NadaNum *num, BigView *view) {
+    if (num->is_big) {
+        view->numerator = num->big.numerator;
+        view->denominator = num->big.denominator;
         return;
     }
 
-    // Calculate GCD of numerator and denominator
-    char *g = gcd(num->numerator, num->denominator);
-    if (!g) return;
-
-    // If GCD is not 1, reduce the fraction
-    if (strcmp(g, "1") != 0) {
-        char *new_num = NULL;
-        char *remainder = NULL;
-
-        // numerator = numerator / gcd
-        new_num = divide_integers(num->numerator, g, &remainder);
-        if (new_num) {
-            free(num->numerator);
-            num->numerator = new_num;
-        }
-        if (remainder) free(remainder);
-
-        // denominator = denominator / gcd
-        new_num = divide_integers(num->denominator, g, &remainder);
-        if (new_num) {
-            free(num->denominator);
-            num->denominator = new_num;
-        }
-        if (remainder) free(remainder);
-    }
-
-    free(g);
+    view->storage[0] = (NadaLimb)num->small.numerator;
+    view->storage[1] = (NadaLimb)(num->small.numerator >> NADA_LIMB_BITS);
+    view->storage[2] = (NadaLimb)num->small.denominator;
+    view->storage[3] = (NadaLimb)(num->small.denominator >> NADA_LIMB_BITS);
+    view->numerator = (NadaBigInt){view->storage, view->storage[1] ? 2 : view->storage[0] ? 1 : 0, 2};
+    view->denominator = (NadaBigInt){view->storage + 2, view->storage[3] ? 2 : 1, 2};
 }
 
-// Strip leading zeros from a number string
-static char *strip_leading_zeros(const char *num) {
-    if (!num) return strdup("0");
+// Parse the decimal digits of a magnitude; anything that is not a plain
+// digit string reads as zero
+static void parse_magnitude(NadaBigInt *r, const char *digits) {
+    nada_big_from_decimal(r, digits, strlen(digits));
+}
 
-    // Skip leading zeros (but keep at least one digit)
-    const char *p = num;
-    while (*p == '0' && *(p + 1) != '\0')
-        p++;
+// Correctly rounded value of numerator / denominator for a non-zero
+// denominator: take a 64-bit quotient, fold the rest into a sticky bit and
+// round that to 53 bits, nearest with ties to even
+static double big_ratio_to_double(const NadaBigInt *numerator, const NadaBigInt *denominator) {
+    if (nada_big_is_zero(numerator)) return 0.0;
+
+    // Scale so the quotient has 65 or 66 bits
+    long shift = 65 - ((long)nada_big_bit_length(numerator) - (long)nada_big_bit_length(denominator));
+    NadaBigInt scaled = NADA_BIG_INIT, quotient = NADA_BIG_INIT, remainder = NADA_BIG_INIT, divisor = NADA_BIG_INIT;
+    if (shift > 0) {
+        nada_big_shl(&scaled, numerator, (size_t)shift);
+        nada_big_set(&divisor, denominator);
+    } else {
+        nada_big_set(&scaled, numerator);
+        nada_big_shl(&divisor, denominator, (size_t)-shift);
+    }
+    nada_big_divmod(&quotient, &remainder, &scaled, &divisor);
+    bool sticky = !nada_big_is_zero(&remainder);
+
+    // Keep 62 bits so the sum below can't overflow; the bits shifted out
+    // join the sticky bit
+    size_t excess = nada_big_bit_length(&quotient) - 62;
+    for (size_t i = 0; i < excess && !sticky; i++) {
+        sticky = (quotient.limbs[i / NADA_LIMB_BITS] >> (i % NADA_LIMB_BITS)) & 1;
+    }
+    nada_big_shr(&quotient, &quotient, excess);
+    uint64_t q;
+    nada_big_to_u64(&quotient, &q);
+    long exponent = (long)excess - shift;
+
+    nada_big_free(&scaled);
+    nada_big_free(&quotient);
+    nada_big_free(&remainder);
+    nada_big_free(&divisor);
+
+    // Subnormal results have fewer than 53 significant bits
+    int drop = 62 - 53;
+    if (exponent + 62 < -1021) {
+        long extra = -1021 - (exponent + 62);
+        drop = extra > 62 ? 63 : (int)(drop + extra);
+    }
+    if (drop > 62) return 0.0;
+
+    uint64_t half = (uint64_t)1 << (drop - 1);
+    uint64_t rest = q & ((half << 1) - 1);
+    q >>= drop;
+    if (rest > half || (rest == half && (sticky || (q & 1)))) q++;
+
+    // Far outside the double range ldexp saturates anyway
+    exponent += drop;
+    if (exponent > 4096) exponent = 4096;
+    if (exponent < -4096) exponent = -4096;
+    return ldexp((double)q, (int)exponent);
+}
 
-    return strdup(p);
+// r = 10^exponent, by squaring so long fractions stay subquadratic
+static void power_of_ten(NadaBigInt *r, size_t exponent) {
+    NadaBigInt ten = NADA_BIG_INIT;
+    nada_big_set_u64(&ten, 10);
+    nada_big_pow(r, &ten, exponent);
+    nada_big_free(&ten);
 }
 
 // Get the numerator as a string (caller must free)
 char *nada_num_get_numerator(const NadaNum *num) {
     if (!num) return NULL;
-    return strdup(num->numerator);
+    if (num->is_flonum) {
+        NadaNum *exact = nada_num_to_exact(num);
+        char *result = exact ? nada_num_get_numerator(exact) : NULL;
+        nada_num_free(exact);
+        return result;
+    }
+    num_normalize(num);
+    BigView view;
+    big_view(num, &view);
+    return nada_big_to_decimal(&view.numerator);
 }
 
 // Get the denominator as a string (caller must free)
 char *nada_num_get_denominator(const NadaNum *num) {
     if (!num) return NULL;
-    return strdup(num->denominator);
+    if (num->is_flonum) {
+        NadaNum *exact = nada_num_to_exact(num);
+        char *result = exact ? nada_num_get_denominator(exact) : NULL;
+        nada_num_free(exact);
+        return result;
+    }
+    num_normalize(num);
+    BigView view;
+    big_view(num, &view);
+    return nada_big_to_decimal(&view.denominator);
 }
 
 // Get the sign of the number (1 for positive, -1 for negative)
@@ -1223,34 +1532,6 @@ int nada_num_get_sign(const NadaNum *num) {
     return num->sign;
 }
 
-// Helper function to check if a number is prime
-static bool is_prime(unsigned long n) {
-    if (n <= 1) return false;
-    if (n <= 3) return true;
-    if (n % 2 == 0 || n % 3 == 0) return false;
-
-    for (unsigned long i = 5; i * i <= n; i += 6) {
-        if (n % i == 0 || n % (i + 2) == 0)
-            return false;
-    }
-
-    return true;
-}
-
-// Helper function to find the next prime after n
-static unsigned long next_prime(unsigned long n) {
-    if (n < 2) return 2;
-
-    // Start with odd number higher than n
-    unsigned long candidate = (n % 2 == 0) ? n + 1 : n + 2;
-
-    while (!is_prime(candidate)) {
-        candidate += 2;
-    }
-
-    return candidate;
-}
-
 // Factor the numerator of an integer into prime factors
 // Returns array of NadaNum* (caller must free each element and the array)
 NadaNum **nada_num_factor_numerator(const NadaNum *num, size_t *count) {
@@ -1258,73 +1539,28 @@ NadaNum **nada_num_factor_numerator(const NadaNum *num, size_t *count) {
 
     *count = 0;
 
-    // Check if this is an integer
-    if (!nada_num_is_integer(num)) return NULL;
-
-    // Special cases: 0, 1, -1
-    if (nada_num_is_zero(num) ||
-        (strcmp(num->numerator, "1") == 0)) {
-        return NULL;  // No prime factors
-    }
-
-    // Convert numerator to unsigned long for factorization
-    char *end;
-    unsigned long n = strtoul(num->numerator, &end, 10);
-    if (*end != '\0') {
-        // Conversion failed or number too large
-        return NULL;
-    }
-
-    // Allocate an initial array (will resize as needed)
-    size_t capacity = 10;
-    NadaNum **factors = malloc(capacity * sizeof(NadaNum *));
-    if (!factors) return NULL;
-
-    // Find prime factors
-    unsigned long p = 2;
-
-    while (n > 1) {
-        if (n % p == 0) {
-            // p is a factor
-            if (*count >= capacity) {
-                // Need to resize
-                capacity *= 2;
-                NadaNum **new_factors = realloc(factors, capacity * sizeof(NadaNum *));
-                if (!new_factors) {
-                    // Free existing factors on error
-                    for (size_t i = 0; i < *count; i++) {
-                        nada_num_free(factors[i]);
-                    }
-                    free(factors);
-                    return NULL;
-                }
-                factors = new_factors;
-            }
-
-            // Add p to the factors list
-            factors[*count] = nada_num_from_int((int)p);
-            if (!factors[*count]) {
-                // Handle allocation error
-                for (size_t i = 0; i < *count; i++) {
-                    nada_num_free(factors[i]);
-                }
-                free(factors);
-                return NULL;
-            }
-
-            (*count)++;
-            n /= p;
+    // Check if this is an exact integer
+    if (num->is_flonum || !nada_num_is_integer(num)) return NULL;
+
+    // Sieve, Miller-Rabin, Pollard-Brent and ECM on the magnitude
+    BigView view;
+    big_view(num, &view);
+    size_t prime_count = 0;
+    NadaBigInt *primes = nada_prime_factor(&view.numerator, &prime_count);
+    if (!primes) return NULL;  // 0 and 1 have no prime factors
+
+    NadaNum **factors = malloc(prime_count * sizeof(NadaNum *));
+    for (size_t i = 0; i < prime_count; i++) {
+        if (factors) {
+            NadaBigInt one = NADA_BIG_INIT;
+            nada_big_set_u64(&one, 1);
+            factors[i] = num_from_reduced(&primes[i], &one, 1);
         } else {
-            // Move to next prime
-            p = next_prime(p);
+            nada_big_free(&primes[i]);
         }
     }
+    free(primes);
 
-    // If no factors were found (shouldn't happen for valid inputs)
-    if (*count == 0) {
-        free(factors);
-        return NULL;
-    }
-
+    if (factors) *count = prime_count;
     return factors;
-}
\ No newline at end of file
+}
@@ -9,13 +9,45 @@
 #include "NadaEval.h"
 #include "NadaError.h"
 
+// Initial token buffer size; longer tokens grow it
+#define TOKEN_INITIAL_CAPACITY 256
+
 // Initialize the tokenizer
 void tokenizer_init(Tokenizer *t, const char *input) {
     t->input = input;
     t->position = 0;
+    t->token_capacity = TOKEN_INITIAL_CAPACITY;
+    t->token = malloc(t->token_capacity);
+    if (!t->token) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
     t->token[0] = '\0';
 }
 
+// Release the token buffer
+void tokenizer_free(Tokenizer *t) {
+    free(t->token);
+    t->token = NULL;
+    t->token_capacity = 0;
+}
+
+// Store c at index i of the token, growing the buffer so that index i + 1
+// still fits for the terminator
+static inline void token_put(Tokenizer *t, size_t i, char c) {
+    if (i + 1 >= t->token_capacity) {
+        size_t capacity = t->token_capacity * 2;
+        char *token = realloc(t->token, capacity);
+        if (!token) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+        t->token = token;
+        t->token_capacity = capacity;
+    }
+    t->token[i] = c;
+}
+
 // Skip whitespace
 static void skip_whitespace(Tokenizer *t) {
     while (t->input[t->position] != '\0' && isspace(t->input[t->position])) {
@@ -66,19 +98,19 @@ static int next_token(Tokenizer *t) {
     // String
     if (t->input[t->position] == '"') {
         size_t i = 0;
-        t->token[i++] = t->input[t->position++];  // Add opening quote
+        token_put(t, i++, t->input[t->position++]);  // Add opening quote
 
         while (t->input[t->position] != '\0' && t->input[t->position] != '"') {
             // Handle escaped quotes
             if (t->input[t->position] == '\\' && t->input[t->position + 1] == '"') {
-                t->token[i++] = '\\';
+                token_put(t, i++, '\\');
                 t->position++;
             }
-            t->token[i++] = t->input[t->position++];
+            token_put(t, i++, t->input[t->position++]);
         }
 
         if (t->input[t->position] == '"') {
-            t->token[i++] = t->input[t->position++];  // Add closing quote
+            token_put(t, i++, t->input[t->position++]);  // Add closing quote
         }
 
         t->token[i] = '\0';
@@ -93,7 +125,7 @@ static int next_token(Tokenizer *t) {
            t->input[t->position] != ')' &&
            t->input[t->position] != '[' &&  // Add square bracket checks
            t->input[t->position] != ']') {  // for token termination
-        t->token[i++] = t->input[t->position++];
+        token_put(t, i++, t->input[t->position++]);
     }
     t->token[i] = '\0';
     return 1;
@@ -340,6 +372,7 @@ NadaValue *nada_parse(const char *input) {
     // Get the first token
     if (!get_next_token(&t)) {
         // Empty input
+        tokenizer_free(&t);
         return nada_create_nil();
     }
 
@@ -353,32 +386,15 @@ NadaValue *nada_parse(const char *input) {
         fprintf(stderr, "Error: unexpected closing parenthesis\n");
     }
 
+    tokenizer_free(&t);
     return result;
 }
 
-NadaValue *nada_parse_eval_multi(const char *input, NadaEnv *env) {
-    // First validate parentheses
-    int error_pos = -1;
-    int paren_balance = nada_validate_parentheses(input, &error_pos);
-
-    if (paren_balance != 0) {
-        // Error handling code (unchanged)
-        char error_buffer[1024];
-        if (paren_balance > 0) {
-            snprintf(error_buffer, sizeof(error_buffer),
-                     "Missing %d closing parentheses", paren_balance);
-        } else {
-            snprintf(error_buffer, sizeof(error_buffer),
-                     "Unexpected closing parenthesis at position %d", error_pos);
-        }
-        return nada_create_error(error_buffer);
-    }
-
-    Tokenizer t;
-    tokenizer_init(&t, input);
-
+// Evaluate every expression left in the tokenizer and return the last
+// result, or the first error
+static NadaValue *parse_eval_all(Tokenizer *t, NadaEnv *env) {
     // Get the first token
-    if (!get_next_token(&t)) {
+    if (!get_next_token(t)) {
         // Empty input - this is not an error
         return nada_create_nil();
     }
@@ -388,9 +404,9 @@ NadaValue *nada_parse_eval_multi(const char *input, NadaEnv *env) {
     NadaValue *last_valid_result = NULL;
 
     // Continue until we've processed all input
-    while (t.token[0] != '\0') {
+    while (t->token[0] != '\0') {
         // Parse the next expression
-        expr = parse_expr(&t);
+        expr = parse_expr(t);
 
         // Free any previous result
         if (result != NULL) {
@@ -432,11 +448,11 @@ NadaValue *nada_parse_eval_multi(const char *input, NadaEnv *env) {
         if (last_valid_result != NULL) {
             nada_free(last_valid_result);
         }
-        last_valid_result = nada_deep_copy(result);
+        last_valid_result = nada_retain(result);
 
         // Token handling is already done by parse_expr - no need to skip whitespace again
-        // If t.token is empty, we're done parsing
-        if (t.token[0] == '\0') {
+        // If t->token is empty, we're done parsing
+        if (t->token[0] == '\0') {
             break;
         }
     }
@@ -448,4 +464,29 @@ NadaValue *nada_parse_eval_multi(const char *input, NadaEnv *env) {
 
     // Return the last valid result (or nil if none)
     return last_valid_result ? last_valid_result : nada_create_nil();
+}
+
+NadaValue *nada_parse_eval_multi(const char *input, NadaEnv *env) {
+    // First validate parentheses
+    int error_pos = -1;
+    int paren_balance = nada_validate_parentheses(input, &error_pos);
+
+    if (paren_balance != 0) {
+        // Error handling code (unchanged)
+        char error_buffer[1024];
+        if (paren_balance > 0) {
+            snprintf(error_buffer, sizeof(error_buffer),
+                     "Missing %d closing parentheses", paren_balance);
+        } else {
+            snprintf(error_buffer, sizeof(error_buffer),
+                     "Unexpected closing parenthesis at position %d", error_pos);
+        }
+        return nada_create_error(error_buffer);
+    }
+
+    Tokenizer t;
+    tokenizer_init(&t, input);
+    NadaValue *result = parse_eval_all(&t, env);
+    tokenizer_free(&t);
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "NadaPool.h"
+#include "NadaValue.h"
+#include "NadaEnv.h"
+
+// Pools carve objects out of aligned blocks, so the block header of any
+// pooled object is found by masking its address
+#define NADA_POOL_BLOCK_SIZE (64 * 1024)
+
+#define ALIGN_UP(n) (((n) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+// A free object stores the link to the next free object in its first bytes
+typedef struct PoolFree {
+    struct PoolFree *next;
+} PoolFree;
+
+typedef struct PoolBlock {
+    struct PoolBlock *next;  // Slab chain of a pool, or list of empty nursery blocks
+    struct PoolBlock *all;   // Every nursery block, for nada_pool_trim()
+    int young;               // Nursery block (bump allocated)
+    size_t live;             // Nursery: objects handed out and not yet freed
+    char *cursor;            // Nursery: next unused byte
+} PoolBlock;
+
+#define BLOCK_HEADER ALIGN_UP(sizeof(PoolBlock))
+#define BLOCK_OF(ptr) ((PoolBlock *)((uintptr_t)(ptr) & ~(uintptr_t)(NADA_POOL_BLOCK_SIZE - 1)))
+
+typedef struct {
+    size_t object_size;
+    PoolFree *free_list;
+    PoolBlock *slabs;
+    size_t slab_count;
+    size_t in_use;
+} Pool;
+
+#define POOL_SIZE(type) ALIGN_UP(sizeof(type) < sizeof(PoolFree) ? sizeof(PoolFree) : sizeof(type))
+
+static Pool pools[NADA_POOL_CLASS_COUNT] = {
+    [NADA_POOL_VALUE] = {.object_size = POOL_SIZE(struct NadaValue)},
+    [NADA_POOL_ENV] = {.object_size = POOL_SIZE(struct NadaEnv)},
+    [NADA_POOL_BINDING] = {.object_size = POOL_SIZE(struct NadaBinding)},
+};
+
+#ifdef NADA_USE_POOL
+
+static PoolBlock *block_alloc(int young) {
+    PoolBlock *block = aligned_alloc(NADA_POOL_BLOCK_SIZE, NADA_POOL_BLOCK_SIZE);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    block->next = NULL;
+    block->all = NULL;
+    block->young = young;
+    block->live = 0;
+    block->cursor = (char *)block + BLOCK_HEADER;
+    return block;
+}
+
+// Carve a new slab into objects and push them onto the free list
+static void pool_refill(Pool *pool) {
+    PoolBlock *slab = block_alloc(0);
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count++;
+
+    // Push in reverse so objects are handed out in address order
+    size_t count = (NADA_POOL_BLOCK_SIZE - BLOCK_HEADER) / pool->object_size;
+    char *base = (char *)slab + BLOCK_HEADER;
+    for (size_t i = count; i-- > 0;) {
+        PoolFree *obj = (PoolFree *)(base + i * pool->object_size);
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+    }
+}
+
+void *nada_pool_alloc_old(NadaPoolClass cls) {
+    Pool *pool = &pools[cls];
+    if (pool->free_list == NULL) {
+        pool_refill(pool);
+    }
+    PoolFree *obj = pool->free_list;
+    pool->free_list = obj->next;
+    pool->in_use++;
+    return obj;
+}
+
+#ifdef NADA_USE_NURSERY
+
+// Young values are bump allocated from the current nursery block. A block
+// is recycled as a whole once every object in it has been freed, so
+// temporaries cost no per-object free list work. Values that survive into
+// long-lived places are copied out with nada_promote() (NadaValue.c).
+static PoolBlock *nursery_current = NULL;
+static PoolBlock *nursery_empty = NULL;  // Fully freed blocks, ready for reuse
+static PoolBlock *nursery_all = NULL;
+static size_t nursery_block_count = 0;
+
+static void *nursery_alloc(Pool *pool) {
+    PoolBlock *block = nursery_current;
+    if (block == NULL || block->cursor + pool->object_size > (char *)block + NADA_POOL_BLOCK_SIZE) {
+        if (block != NULL && block->live == 0) {
+            // Everything allocated here already died, start over in place
+            block->cursor = (char *)block + BLOCK_HEADER;
+        } else {
+            // Retire the current block; it is recycled when its last object dies
+            if (nursery_empty != NULL) {
+                block = nursery_empty;
+                nursery_empty = block->next;
+            } else {
+                block = block_alloc(1);
+                block->all = nursery_all;
+                nursery_all = block;
+                nursery_block_count++;
+            }
+            block->next = NULL;
+            block->cursor = (char *)block + BLOCK_HEADER;
+            nursery_current = block;
+        }
+    }
+
+    void *obj = block->cursor;
+    block->cursor += pool->object_size;
+    block->live++;
+    pool->in_use++;
+    return obj;
+}
+
+static void nursery_free(Pool *pool, PoolBlock *block) {
+    pool->in_use--;
+    if (--block->live > 0) return;
+
+    if (block == nursery_current) {
+        // Bulk free: rewind the bump pointer over the dead temporaries
+        block->cursor = (char *)block + BLOCK_HEADER;
+    } else {
+        block->next = nursery_empty;
+        nursery_empty = block;
+    }
+}
+
+void *nada_pool_alloc(NadaPoolClass cls) {
+    if (cls == NADA_POOL_VALUE) {
+        return nursery_alloc(&pools[cls]);
+    }
+    return nada_pool_alloc_old(cls);
+}
+
+bool nada_pool_is_young(const void *ptr) {
+    return BLOCK_OF(ptr)->young;
+}
+
+#else  // !NADA_USE_NURSERY
+
+void *nada_pool_alloc(NadaPoolClass cls) {
+    return nada_pool_alloc_old(cls);
+}
+
+bool nada_pool_is_young(const void *ptr) {
+    (void)ptr;
+    return false;
+}
+
+#endif  // NADA_USE_NURSERY
+
+void nada_pool_free(NadaPoolClass cls, void *ptr) {
+    if (ptr == NULL) return;
+    Pool *pool = &pools[cls];
+
+#ifdef NADA_USE_NURSERY
+    PoolBlock *block = BLOCK_OF(ptr);
+    if (block->young) {
+        nursery_free(pool, block);
+        return;
+    }
+#endif
+
+    PoolFree *obj = ptr;
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    pool->in_use--;
+}
+
+void nada_pool_trim(void) {
+    for (int cls = 0; cls < NADA_POOL_CLASS_COUNT; cls++) {
+        Pool *pool = &pools[cls];
+        if (pool->in_use != 0) continue;  // Objects still live in these slabs
+        PoolBlock *slab = pool->slabs;
+        while (slab) {
+            PoolBlock *next = slab->next;
+            free(slab);
+            slab = next;
+        }
+        pool->slabs = NULL;
+        pool->free_list = NULL;
+        pool->slab_count = 0;
+    }
+
+#ifdef NADA_USE_NURSERY
+    if (pools[NADA_POOL_VALUE].in_use == 0) {
+        PoolBlock *block = nursery_all;
+        while (block) {
+            PoolBlock *next = block->all;
+            free(block);
+            block = next;
+        }
+        nursery_all = nursery_empty = nursery_current = NULL;
+        nursery_block_count = 0;
+    }
+#endif
+}
+
+#else  // !NADA_USE_POOL
+
+void *nada_pool_alloc(NadaPoolClass cls) {
+    void *obj = malloc(pools[cls].object_size);
+    if (obj == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    pools[cls].in_use++;
+    return obj;
+}
+
+void *nada_pool_alloc_old(NadaPoolClass cls) {
+    return nada_pool_alloc(cls);
+}
+
+void nada_pool_free(NadaPoolClass cls, void *ptr) {
+    if (ptr == NULL) return;
+    pools[cls].in_use--;
+    free(ptr);
+}
+
+bool nada_pool_is_young(const void *ptr) {
+    (void)ptr;
+    return false;
+}
+
+void nada_pool_trim(void) {
+}
+
+#endif  // NADA_USE_POOL
+
+size_t nada_pool_in_use(NadaPoolClass cls) {
+    return pools[cls].in_use;
+}
+
+size_t nada_pool_slabs(NadaPoolClass cls) {
+#if defined(NADA_USE_POOL) && defined(NADA_USE_NURSERY)
+    if (cls == NADA_POOL_VALUE) {
+        return pools[cls].slab_count + nursery_block_count;
+    }
+#endif
+    return pools[cls].slab_count;
+}
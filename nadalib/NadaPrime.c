@@ -0,0 +1,786 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "NadaPrime.h"
+
+// Primes below this are removed by trial division, so any factor left
+// after it is at least SIEVE_LIMIT
+#define SIEVE_LIMIT 65536u
+
+// Pollard-Brent iterations on a bignum before switching to ECM
+#define RHO_BUDGET 65536
+
+// Stage 2 of ECM covers primes up to ECM_B2_FACTOR * B1 in giant steps of
+// ECM_STAGE2_D
+#define ECM_B2_FACTOR 100
+#define ECM_STAGE2_D 210
+
+// Miller-Rabin bases: the first twelve primes make the test exact below
+// 3.3 * 10^24 (Sorenson and Webster)
+static const uint32_t mr_bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+#define MR_BASE_COUNT (sizeof(mr_bases) / sizeof(mr_bases[0]))
+// Extra pseudo-random bases for numbers beyond that bound
+#define MR_EXTRA_BASES 8
+
+static void *prime_xmalloc(size_t size) {
+    void *p = malloc(size ? size : 1);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+// xorshift64*: deterministic choices of curves and starting points
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+// Small primes: a sieve of Eratosthenes, cached for the life of the
+// process and rebuilt only when a larger bound is needed
+
+static uint32_t *small_primes = NULL;
+static size_t small_prime_count = 0;
+static uint32_t small_prime_limit = 0;
+
+// Make sure all primes below limit are in small_primes
+static void sieve_primes(uint32_t limit) {
+    if (limit <= small_prime_limit) return;
+
+    unsigned char *composite = calloc(limit, 1);
+    if (composite == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    size_t count = 0;
+    for (uint32_t i = 2; i < limit; i++) {
+        if (composite[i]) continue;
+        count++;
+        for (uint64_t j = (uint64_t)i * i; j < limit; j += i) {
+            composite[j] = 1;
+        }
+    }
+
+    free(small_primes);
+    small_primes = prime_xmalloc(count * sizeof(uint32_t));
+    small_prime_count = 0;
+    for (uint32_t i = 2; i < limit; i++) {
+        if (!composite[i]) small_primes[small_prime_count++] = i;
+    }
+    small_prime_limit = limit;
+    free(composite);
+}
+
+// Primes up to the stage 2 bound of ECM, one bit per odd number, cached
+// like small_primes
+
+static uint8_t *odd_composite = NULL;
+static uint64_t odd_composite_limit = 0;
+
+// Make sure odd_is_prime answers for all x below limit
+static void sieve_odd(uint64_t limit) {
+    if (limit <= odd_composite_limit) return;
+
+    size_t bits = limit / 2 + 1;
+    free(odd_composite);
+    odd_composite = calloc((bits + 7) / 8, 1);
+    if (odd_composite == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    odd_composite[0] |= 1;  // 1 is not a prime
+    for (uint64_t i = 3; i * i < limit; i += 2) {
+        if (odd_composite[i / 16] >> (i / 2 % 8) & 1) continue;
+        for (uint64_t j = i * i; j < limit; j += 2 * i) {
+            odd_composite[j / 16] |= (uint8_t)(1 << (j / 2 % 8));
+        }
+    }
+    odd_composite_limit = limit;
+}
+
+static bool odd_is_prime(uint64_t x) {
+    return !(odd_composite[x / 16] >> (x / 2 % 8) & 1);
+}
+
+// Machine words: 128-bit products for the modular arithmetic
+
+static uint64_t mulmod_u64(uint64_t a, uint64_t b, uint64_t m) {
+    return (uint64_t)((unsigned __int128)a * b % m);
+}
+
+static uint64_t addmod_u64(uint64_t a, uint64_t b, uint64_t m) {
+    return a >= m - b ? a - (m - b) : a + b;
+}
+
+static uint64_t powmod_u64(uint64_t base, uint64_t e, uint64_t m) {
+    uint64_t result = 1 % m;
+    base %= m;
+    for (; e > 0; e >>= 1) {
+        if (e & 1) result = mulmod_u64(result, base, m);
+        base = mulmod_u64(base, base, m);
+    }
+    return result;
+}
+
+// Deterministic Miller-Rabin for any 64-bit n
+static bool is_prime_u64(uint64_t n) {
+    if (n < 2) return false;
+    for (size_t i = 0; i < MR_BASE_COUNT; i++) {
+        if (n % mr_bases[i] == 0) return n == mr_bases[i];
+    }
+
+    uint64_t d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+    for (size_t i = 0; i < MR_BASE_COUNT; i++) {
+        uint64_t x = powmod_u64(mr_bases[i], d, n);
+        if (x == 1 || x == n - 1) continue;
+        int r = 1;
+        for (; r < s; r++) {
+            x = mulmod_u64(x, x, n);
+            if (x == n - 1) break;
+        }
+        if (r == s) return false;
+    }
+    return true;
+}
+
+// Brent's variant of Pollard's rho with y -> y^2 + c; returns a divisor of
+// n, which is n itself when this c fails
+static uint64_t rho_u64(uint64_t n, uint64_t c, uint64_t y) {
+    const uint64_t batch = 128;
+    uint64_t x = y, ys = y, q = 1, g = 1;
+    for (uint64_t r = 1; g == 1; r *= 2) {
+        x = y;
+        for (uint64_t i = 0; i < r; i++) {
+            y = addmod_u64(mulmod_u64(y, y, n), c, n);
+        }
+        for (uint64_t k = 0; k < r && g == 1; k += batch) {
+            ys = y;
+            uint64_t steps = r - k < batch ? r - k : batch;
+            for (uint64_t i = 0; i < steps; i++) {
+                y = addmod_u64(mulmod_u64(y, y, n), c, n);
+                q = mulmod_u64(q, x > y ? x - y : y - x, n);
+            }
+            g = nada_big_gcd_u64(q, n);
+        }
+    }
+
+    // The batch overshot: redo its steps one gcd at a time
+    if (g == n) {
+        do {
+            ys = addmod_u64(mulmod_u64(ys, ys, n), c, n);
+            g = nada_big_gcd_u64(x > ys ? x - ys : ys - x, n);
+        } while (g == 1);
+    }
+    return g;
+}
+
+// Bignums: Montgomery arithmetic modulo an odd n on plain arrays of 64-bit
+// words, so the inner loops of rho and ECM never allocate and take a
+// quarter of the multiplications that 32-bit limbs would need
+
+typedef uint64_t Word;
+typedef unsigned __int128 DWord;  // Holds the product of two words
+
+#define WORD_BITS 64
+
+typedef struct {
+    const NadaBigInt *mod;
+    size_t n;          // Words per residue
+    Word *m;           // mod in n words
+    Word inverse;      // -mod^-1 mod 2^WORD_BITS
+    Word *scratch;     // n + 2 words
+    Word *one;         // 2^(WORD_BITS * n) mod mod, the Montgomery form of 1
+    NadaLimb *limbs;   // 2n limbs for the bignum view of a residue
+} Mont;
+
+// Pack a < 2^(WORD_BITS * n) into n words
+static void words_from_big(Word *r, const NadaBigInt *a, size_t n) {
+    memset(r, 0, n * sizeof(Word));
+    for (size_t i = 0; i < a->len; i++) {
+        r[i / 2] |= (Word)a->limbs[i] << (i % 2 * NADA_LIMB_BITS);
+    }
+}
+
+static int words_cmp(const Word *a, const Word *b, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// r = a - b over n words; returns the borrow
+static Word words_sub(Word *r, const Word *a, const Word *b, size_t n) {
+    Word borrow = 0;
+    for (size_t j = 0; j < n; j++) {
+        Word d = a[j] - b[j];
+        Word out = a[j] < b[j];
+        r[j] = d - borrow;
+        borrow = out | (d < borrow);
+    }
+    return borrow;
+}
+
+static void mont_init(Mont *ctx, const NadaBigInt *mod) {
+    ctx->mod = mod;
+    ctx->n = (mod->len + 1) / 2;
+    ctx->m = prime_xmalloc(ctx->n * sizeof(Word));
+    ctx->scratch = prime_xmalloc((ctx->n + 2) * sizeof(Word));
+    ctx->one = prime_xmalloc(ctx->n * sizeof(Word));
+    ctx->limbs = prime_xmalloc(2 * ctx->n * sizeof(NadaLimb));
+    words_from_big(ctx->m, mod, ctx->n);
+
+    // Newton's iteration doubles the correct low bits of the inverse
+    Word m0 = ctx->m[0], x = m0;
+    for (int i = 0; i < 6; i++) {
+        x *= 2 - m0 * x;
+    }
+    ctx->inverse = -x;
+
+    NadaBigInt r = NADA_BIG_INIT;
+    nada_big_set_u64(&r, 1);
+    nada_big_shl(&r, &r, ctx->n * WORD_BITS);
+    nada_big_divmod(NULL, &r, &r, mod);
+    words_from_big(ctx->one, &r, ctx->n);
+    nada_big_free(&r);
+}
+
+static void mont_free(Mont *ctx) {
+    free(ctx->m);
+    free(ctx->scratch);
+    free(ctx->one);
+    free(ctx->limbs);
+}
+
+// r = a into the Montgomery form, for a < mod
+static void mont_enter(const Mont *ctx, Word *r, const NadaBigInt *a) {
+    NadaBigInt t = NADA_BIG_INIT;
+    nada_big_shl(&t, a, ctx->n * WORD_BITS);
+    nada_big_divmod(NULL, &t, &t, ctx->mod);
+    words_from_big(r, &t, ctx->n);
+    nada_big_free(&t);
+}
+
+static void mont_enter_u64(const Mont *ctx, Word *r, uint64_t a) {
+    NadaBigInt t = NADA_BIG_INIT;
+    nada_big_set_u64(&t, a);
+    nada_big_divmod(NULL, &t, &t, ctx->mod);
+    mont_enter(ctx, r, &t);
+    nada_big_free(&t);
+}
+
+// r = a * b / 2^(WORD_BITS * n) mod mod (CIOS); r may alias a or b
+static void mont_mul(const Mont *ctx, Word *r, const Word *a, const Word *b) {
+    const Word *m = ctx->m;
+    size_t n = ctx->n;
+    Word *t = ctx->scratch;
+    memset(t, 0, (n + 2) * sizeof(Word));
+
+    for (size_t i = 0; i < n; i++) {
+        Word bi = b[i];
+        DWord carry = 0;
+        for (size_t j = 0; j < n; j++) {
+            carry += (DWord)a[j] * bi + t[j];
+            t[j] = (Word)carry;
+            carry >>= WORD_BITS;
+        }
+        carry += t[n];
+        t[n] = (Word)carry;
+        t[n + 1] = (Word)(carry >> WORD_BITS);
+
+        Word q = t[0] * ctx->inverse;
+        carry = ((DWord)q * m[0] + t[0]) >> WORD_BITS;
+        for (size_t j = 1; j < n; j++) {
+            carry += (DWord)q * m[j] + t[j];
+            t[j - 1] = (Word)carry;
+            carry >>= WORD_BITS;
+        }
+        carry += t[n];
+        t[n - 1] = (Word)carry;
+        t[n] = t[n + 1] + (Word)(carry >> WORD_BITS);
+    }
+
+    // t < 2 * mod
+    if (t[n] || words_cmp(t, m, n) >= 0) words_sub(t, t, m, n);
+    memcpy(r, t, n * sizeof(Word));
+}
+
+static void mont_add(const Mont *ctx, Word *r, const Word *a, const Word *b) {
+    const Word *m = ctx->m;
+    size_t n = ctx->n;
+    Word carry = 0;
+    for (size_t j = 0; j < n; j++) {
+        Word sum = a[j] + carry;
+        carry = sum < carry;
+        r[j] = sum + b[j];
+        carry |= r[j] < sum;
+    }
+    if (carry || words_cmp(r, m, n) >= 0) words_sub(r, r, m, n);
+}
+
+static void mont_sub(const Mont *ctx, Word *r, const Word *a, const Word *b) {
+    const Word *m = ctx->m;
+    size_t n = ctx->n;
+    if (words_sub(r, a, b, n)) {
+        Word carry = 0;
+        for (size_t j = 0; j < n; j++) {
+            Word sum = r[j] + carry;
+            carry = sum < carry;
+            r[j] = sum + m[j];
+            carry |= r[j] < sum;
+        }
+    }
+}
+
+// g = gcd(a, mod) for a residue a; the Montgomery factor is coprime with
+// the odd modulus, so residues in either form give the same gcd
+static void mont_gcd(const Mont *ctx, NadaBigInt *g, const Word *a) {
+    size_t len = 2 * ctx->n;
+    for (size_t i = 0; i < ctx->n; i++) {
+        ctx->limbs[2 * i] = (NadaLimb)a[i];
+        ctx->limbs[2 * i + 1] = (NadaLimb)(a[i] >> NADA_LIMB_BITS);
+    }
+    while (len > 0 && ctx->limbs[len - 1] == 0) len--;
+    NadaBigInt view = {ctx->limbs, len, 2 * ctx->n};
+    nada_big_gcd(g, &view, ctx->mod);
+}
+
+// Strong probable-prime test of the odd mod to the base in Montgomery form
+static bool mont_strong_probable(const Mont *ctx, const Word *base, const NadaBigInt *d, size_t s,
+                                 const Word *minus_one, Word *x) {
+    size_t n = ctx->n;
+    memcpy(x, ctx->one, n * sizeof(Word));
+    for (size_t bit = nada_big_bit_length(d); bit-- > 0;) {
+        mont_mul(ctx, x, x, x);
+        if ((d->limbs[bit / NADA_LIMB_BITS] >> (bit % NADA_LIMB_BITS)) & 1) {
+            mont_mul(ctx, x, x, base);
+        }
+    }
+    if (words_cmp(x, ctx->one, n) == 0 || words_cmp(x, minus_one, n) == 0) return true;
+    for (size_t r = 1; r < s; r++) {
+        mont_mul(ctx, x, x, x);
+        if (words_cmp(x, minus_one, n) == 0) return true;
+    }
+    return false;
+}
+
+bool nada_prime_is_probable(const NadaBigInt *n) {
+    uint64_t small;
+    if (nada_big_to_u64(n, &small)) return is_prime_u64(small);
+    if ((n->limbs[0] & 1) == 0) return false;
+
+    // n - 1 = d * 2^s with d odd
+    NadaBigInt d = NADA_BIG_INIT, one = NADA_BIG_INIT;
+    nada_big_set_u64(&one, 1);
+    nada_big_sub(&d, n, &one);
+    nada_big_free(&one);
+    size_t s = 0;
+    while (((d.limbs[s / NADA_LIMB_BITS] >> (s % NADA_LIMB_BITS)) & 1) == 0) s++;
+    nada_big_shr(&d, &d, s);
+
+    Mont ctx;
+    mont_init(&ctx, n);
+    size_t words = ctx.n;
+    Word *base = prime_xmalloc(3 * words * sizeof(Word));
+    Word *minus_one = base + words, *x = base + 2 * words;
+    memset(x, 0, words * sizeof(Word));
+    mont_sub(&ctx, minus_one, x, ctx.one);
+
+    bool probable = true;
+    uint64_t state = n->limbs[0] | 1;
+    for (size_t i = 0; i < MR_BASE_COUNT + MR_EXTRA_BASES && probable; i++) {
+        // n > 2^64 exceeds every base
+        uint64_t a = i < MR_BASE_COUNT ? mr_bases[i] : 2 + (next_random(&state) >> 33);
+        mont_enter_u64(&ctx, base, a);
+        probable = mont_strong_probable(&ctx, base, &d, s, minus_one, x);
+    }
+
+    free(base);
+    mont_free(&ctx);
+    nada_big_free(&d);
+    return probable;
+}
+
+// Pollard-Brent rho on a bignum within budget iterations; true with a
+// proper divisor in factor on success
+static bool rho_big(const Mont *ctx, uint64_t *seed, size_t budget, NadaBigInt *factor) {
+    const size_t batch = 128;
+    size_t n = ctx->n;
+    Word *buffer = prime_xmalloc(6 * n * sizeof(Word));
+    Word *y = buffer, *x = buffer + n, *ys = buffer + 2 * n;
+    Word *q = buffer + 3 * n, *c = buffer + 4 * n, *diff = buffer + 5 * n;
+
+    // Any start and constant below the modulus will do, in either form
+    memset(buffer, 0, 6 * n * sizeof(Word));
+    y[0] = (Word)next_random(seed);
+    c[0] = (Word)next_random(seed) | 1;
+    memcpy(q, ctx->one, n * sizeof(Word));
+
+    NadaBigInt g = NADA_BIG_INIT;
+    nada_big_set_u64(&g, 1);
+    size_t iterations = 0;
+    for (size_t r = 1; nada_big_is_one(&g) && iterations < budget; r *= 2) {
+        memcpy(x, y, n * sizeof(Word));
+        for (size_t i = 0; i < r; i++) {
+            mont_mul(ctx, y, y, y);
+            mont_add(ctx, y, y, c);
+        }
+        for (size_t k = 0; k < r && nada_big_is_one(&g); k += batch) {
+            memcpy(ys, y, n * sizeof(Word));
+            size_t steps = r - k < batch ? r - k : batch;
+            for (size_t i = 0; i < steps; i++) {
+                mont_mul(ctx, y, y, y);
+                mont_add(ctx, y, y, c);
+                mont_sub(ctx, diff, x, y);
+                mont_mul(ctx, q, q, diff);
+            }
+            mont_gcd(ctx, &g, q);
+            iterations += steps;
+        }
+        iterations += r;
+    }
+
+    // The batch overshot: redo its steps one gcd at a time
+    if (nada_big_cmp(&g, ctx->mod) == 0) {
+        do {
+            mont_mul(ctx, ys, ys, ys);
+            mont_add(ctx, ys, ys, c);
+            mont_sub(ctx, diff, x, ys);
+            mont_gcd(ctx, &g, diff);
+        } while (nada_big_is_one(&g));
+    }
+
+    bool found = !nada_big_is_one(&g) && nada_big_cmp(&g, ctx->mod) != 0;
+    if (found) nada_big_swap(factor, &g);
+    nada_big_free(&g);
+    free(buffer);
+    return found;
+}
+
+// ECM with Montgomery curves By^2 = x^3 + Ax^2 + x in x:z coordinates and
+// Suyama's parametrization. (A + 2) / 4 is kept as the fraction
+// a24_num / a24_den, which avoids a modular inverse.
+
+typedef struct {
+    const Mont *ctx;
+    Word *a24_num, *a24_den;
+    Word *t[6];  // Scratch residues
+} Curve;
+
+typedef struct {
+    Word *x, *z;
+} Point;
+
+// r = 2p; r may alias p
+static void curve_double(const Curve *cv, Point *r, const Point *p) {
+    const Mont *ctx = cv->ctx;
+    Word *s = cv->t[0], *d = cv->t[1], *t = cv->t[2], *u = cv->t[3];
+    mont_add(ctx, s, p->x, p->z);
+    mont_mul(ctx, s, s, s);              // (x + z)^2
+    mont_sub(ctx, d, p->x, p->z);
+    mont_mul(ctx, d, d, d);              // (x - z)^2
+    mont_sub(ctx, t, s, d);              // 4xz
+    mont_mul(ctx, d, d, cv->a24_den);
+    mont_mul(ctx, r->x, s, d);           // den (x + z)^2 (x - z)^2
+    mont_mul(ctx, u, t, cv->a24_num);
+    mont_add(ctx, u, u, d);
+    mont_mul(ctx, r->z, t, u);           // 4xz (den (x - z)^2 + num 4xz)
+}
+
+// r = p + q given diff = p - q; r may alias p or q but not diff
+static void curve_add(const Curve *cv, Point *r, const Point *p, const Point *q, const Point *diff) {
+    const Mont *ctx = cv->ctx;
+    Word *a = cv->t[0], *b = cv->t[1], *c = cv->t[2], *d = cv->t[3];
+    mont_sub(ctx, a, p->x, p->z);
+    mont_add(ctx, b, q->x, q->z);
+    mont_mul(ctx, a, a, b);              // (xp - zp)(xq + zq)
+    mont_add(ctx, c, p->x, p->z);
+    mont_sub(ctx, d, q->x, q->z);
+    mont_mul(ctx, c, c, d);              // (xp + zp)(xq - zq)
+    mont_add(ctx, b, a, c);
+    mont_sub(ctx, d, a, c);
+    mont_mul(ctx, b, b, b);
+    mont_mul(ctx, d, d, d);
+    mont_mul(ctx, r->x, diff->z, b);
+    mont_mul(ctx, r->z, diff->x, d);
+}
+
+static void point_copy(const Mont *ctx, Point *r, const Point *p) {
+    memcpy(r->x, p->x, ctx->n * sizeof(Word));
+    memcpy(r->z, p->z, ctx->n * sizeof(Word));
+}
+
+// r = k * p for k >= 1 with the Montgomery ladder; r0 and r1 are scratch
+// points, and r may alias p
+static void curve_multiply(const Curve *cv, Point *r, const Point *p, uint64_t k, Point *r0, Point *r1,
+                           Point *base) {
+    point_copy(cv->ctx, base, p);
+    point_copy(cv->ctx, r0, p);
+    curve_double(cv, r1, p);
+    for (int bit = 62 - __builtin_clzll(k); bit >= 0; bit--) {
+        if ((k >> bit) & 1) {
+            curve_add(cv, r0, r1, r0, base);
+            curve_double(cv, r1, r1);
+        } else {
+            curve_add(cv, r1, r0, r1, base);
+            curve_double(cv, r0, r0);
+        }
+    }
+    point_copy(cv->ctx, r, r0);
+}
+
+// Carve residues of n words out of a shared buffer
+static Word *take_residue(Word **next, size_t n) {
+    Word *residue = *next;
+    *next += n;
+    return residue;
+}
+
+static Point take_point(Word **next, size_t n) {
+    Point p;
+    p.x = take_residue(next, n);
+    p.z = take_residue(next, n);
+    return p;
+}
+
+// One curve with stage 1 bound b1 and stage 2 up to ECM_B2_FACTOR * b1;
+// true with a proper divisor in factor on success
+static bool ecm_curve(const Mont *ctx, uint64_t *seed, uint32_t b1, NadaBigInt *factor) {
+    size_t n = ctx->n;
+    const size_t baby_count = ECM_STAGE2_D / 4 + 1;  // Odd j below D/2
+    // Curve constants and scratch, seven points, six residues, baby steps
+    size_t residues = 8 + 2 * 7 + 6 + 2 * baby_count;
+    Word *buffer = prime_xmalloc(residues * n * sizeof(Word));
+    Word *next = buffer;
+
+    Curve cv = {ctx, take_residue(&next, n), take_residue(&next, n), {NULL}};
+    for (int i = 0; i < 6; i++) cv.t[i] = take_residue(&next, n);
+    Point q = take_point(&next, n), r0 = take_point(&next, n), r1 = take_point(&next, n);
+    Point base = take_point(&next, n), giant = take_point(&next, n);
+    Point previous = take_point(&next, n), step = take_point(&next, n);
+    Word *u = take_residue(&next, n), *v = take_residue(&next, n), *w = take_residue(&next, n);
+    Word *acc = take_residue(&next, n), *sigma_r = take_residue(&next, n), *five = take_residue(&next, n);
+    Point *baby = prime_xmalloc(baby_count * sizeof(Point));
+    for (size_t i = 0; i < baby_count; i++) {
+        baby[i] = take_point(&next, n);
+    }
+
+    // u = sigma^2 - 5, v = 4 sigma, start at (u^3 : v^3),
+    // (A + 2) / 4 = (v - u)^3 (3u + v) / (16 u^3 v)
+    uint64_t sigma = 6 + (next_random(seed) >> 34);
+    mont_enter_u64(ctx, sigma_r, sigma);
+    mont_enter_u64(ctx, five, 5);
+    mont_mul(ctx, u, sigma_r, sigma_r);
+    mont_sub(ctx, u, u, five);
+    mont_add(ctx, v, sigma_r, sigma_r);
+    mont_add(ctx, v, v, v);
+    mont_mul(ctx, q.x, u, u);
+    mont_mul(ctx, q.x, q.x, u);
+    mont_mul(ctx, q.z, v, v);
+    mont_mul(ctx, q.z, q.z, v);
+    mont_sub(ctx, w, v, u);
+    mont_mul(ctx, cv.a24_num, w, w);
+    mont_mul(ctx, cv.a24_num, cv.a24_num, w);
+    mont_add(ctx, w, u, u);
+    mont_add(ctx, w, w, u);
+    mont_add(ctx, w, w, v);
+    mont_mul(ctx, cv.a24_num, cv.a24_num, w);
+    mont_mul(ctx, cv.a24_den, q.x, v);
+    for (int i = 0; i < 4; i++) {
+        mont_add(ctx, cv.a24_den, cv.a24_den, cv.a24_den);
+    }
+
+    // Stage 1: multiply by every prime power up to b1
+    sieve_primes(b1 + 1);
+    for (size_t i = 0; i < small_prime_count && small_primes[i] <= b1; i++) {
+        uint64_t p = small_primes[i], power = p;
+        while (power * p <= b1) power *= p;
+        curve_multiply(&cv, &q, &q, power, &r0, &r1, &base);
+    }
+
+    NadaBigInt g = NADA_BIG_INIT;
+    mont_gcd(ctx, &g, q.z);
+
+    if (nada_big_is_one(&g)) {
+        // Stage 2: for each prime p = mD +- j up to B2, (mD)Q = +-jQ modulo
+        // a factor, which shows in x_mD z_j - x_j z_mD
+        const uint64_t d = ECM_STAGE2_D;
+        point_copy(ctx, &baby[0], &q);
+        curve_double(&cv, &step, &q);
+        for (size_t i = 1; i < baby_count; i++) {
+            if (i == 1) {
+                curve_add(&cv, &baby[1], &step, &q, &q);  // 3Q = 2Q + Q
+            } else {
+                curve_add(&cv, &baby[i], &baby[i - 1], &step, &baby[i - 2]);
+            }
+        }
+
+        uint64_t m = b1 / d;
+        uint64_t b2 = (uint64_t)b1 * ECM_B2_FACTOR;
+        sieve_odd(b2 + d);
+        curve_multiply(&cv, &step, &q, d, &r0, &r1, &base);
+        curve_multiply(&cv, &giant, &q, m * d, &r0, &r1, &base);
+        curve_multiply(&cv, &previous, &q, (m - 1) * d, &r0, &r1, &base);
+        memcpy(acc, ctx->one, n * sizeof(Word));
+        for (; m * d <= b2 + d / 2; m++) {
+            for (size_t i = 0; i < baby_count; i++) {
+                uint64_t j = 2 * i + 1;
+                if (!odd_is_prime(m * d - j) && !odd_is_prime(m * d + j)) continue;
+                mont_mul(ctx, u, giant.x, baby[i].z);
+                mont_mul(ctx, v, baby[i].x, giant.z);
+                mont_sub(ctx, u, u, v);
+                mont_mul(ctx, acc, acc, u);
+            }
+            curve_add(&cv, &r0, &giant, &step, &previous);
+            point_copy(ctx, &previous, &giant);
+            point_copy(ctx, &giant, &r0);
+        }
+        mont_gcd(ctx, &g, acc);
+    }
+
+    bool found = !nada_big_is_one(&g) && nada_big_cmp(&g, ctx->mod) != 0;
+    if (found) nada_big_swap(factor, &g);
+    nada_big_free(&g);
+    free(baby);
+    free(buffer);
+    return found;
+}
+
+// Proper divisor of an odd composite n above 2^64; false once the curve
+// schedule is used up without finding one
+static bool find_factor(const NadaBigInt *n, uint64_t *seed, NadaBigInt *factor) {
+    // Curves per stage 1 bound, about what finds factors of 15, 20 and 25
+    // digits. Larger factors would take minutes to hours, so the search
+    // stops here and leaves n unsplit.
+    static const struct {
+        uint32_t b1;
+        uint32_t curves;
+    } schedule[] = {{2000, 25}, {11000, 90}, {50000, 300}};
+    const size_t stages = sizeof(schedule) / sizeof(schedule[0]);
+
+    Mont ctx;
+    mont_init(&ctx, n);
+    bool found = rho_big(&ctx, seed, RHO_BUDGET, factor);
+    for (size_t stage = 0; stage < stages && !found; stage++) {
+        for (uint32_t curve = 0; curve < schedule[stage].curves && !found; curve++) {
+            found = ecm_curve(&ctx, seed, schedule[stage].b1, factor);
+        }
+    }
+    mont_free(&ctx);
+    return found;
+}
+
+// Growable list of factors
+
+typedef struct {
+    NadaBigInt *items;
+    size_t count;
+    size_t capacity;
+} FactorList;
+
+static void factor_push(FactorList *list, const NadaBigInt *value) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        NadaBigInt *items = realloc(list->items, list->capacity * sizeof(NadaBigInt));
+        if (items == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+        list->items = items;
+    }
+    NadaBigInt *slot = &list->items[list->count++];
+    nada_big_init(slot);
+    nada_big_set(slot, value);
+}
+
+static void factor_push_u64(FactorList *list, uint64_t value) {
+    NadaBigInt t = NADA_BIG_INIT;
+    nada_big_set_u64(&t, value);
+    factor_push(list, &t);
+    nada_big_free(&t);
+}
+
+// Factor n > 1 without prime factors below SIEVE_LIMIT
+static void factor_u64(uint64_t n, FactorList *found, uint64_t *seed) {
+    if (n == 1) return;
+    if (n < (uint64_t)SIEVE_LIMIT * SIEVE_LIMIT || is_prime_u64(n)) {
+        factor_push_u64(found, n);
+        return;
+    }
+
+    uint64_t divisor = n;
+    while (divisor == n) {
+        divisor = rho_u64(n, 1 + next_random(seed) % (n - 1), next_random(seed) % n);
+    }
+    factor_u64(divisor, found, seed);
+    factor_u64(n / divisor, found, seed);
+}
+
+static int factor_compare(const void *a, const void *b) {
+    return nada_big_cmp((const NadaBigInt *)a, (const NadaBigInt *)b);
+}
+
+NadaBigInt *nada_prime_factor(const NadaBigInt *n, size_t *count) {
+    *count = 0;
+    if (nada_big_is_zero(n) || nada_big_is_one(n)) return NULL;
+
+    FactorList found = {NULL, 0, 0}, pending = {NULL, 0, 0};
+    NadaBigInt rest = NADA_BIG_INIT, quotient = NADA_BIG_INIT;
+    nada_big_set(&rest, n);
+
+    // Trial division by the small primes, stopping once p^2 > rest
+    sieve_primes(SIEVE_LIMIT);
+    for (size_t i = 0; i < small_prime_count && small_primes[i] < SIEVE_LIMIT; i++) {
+        NadaLimb p = small_primes[i];
+        uint64_t word;
+        if (nada_big_to_u64(&rest, &word) && (uint64_t)p * p > word) break;
+        while (nada_big_divmod_small(NULL, &rest, p) == 0) {
+            nada_big_divmod_small(&rest, &rest, p);
+            factor_push_u64(&found, p);
+        }
+    }
+
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    uint64_t word;
+    if (nada_big_to_u64(&rest, &word) && word < (uint64_t)SIEVE_LIMIT * SIEVE_LIMIT) {
+        // No prime below SIEVE_LIMIT divides it, so it is 1 or a prime
+        if (word > 1) factor_push_u64(&found, word);
+    } else {
+        factor_push(&pending, &rest);
+    }
+
+    // Split composites until only primes are left
+    while (pending.count > 0) {
+        NadaBigInt c = pending.items[--pending.count];
+        if (nada_big_to_u64(&c, &word)) {
+            factor_u64(word, &found, &seed);
+        } else if (nada_prime_is_probable(&c)) {
+            factor_push(&found, &c);
+        } else {
+            NadaBigInt divisor = NADA_BIG_INIT;
+            if (find_factor(&c, &seed, &divisor)) {
+                nada_big_divmod(&quotient, NULL, &c, &divisor);
+                factor_push(&pending, &divisor);
+                factor_push(&pending, &quotient);
+            } else {
+                factor_push(&found, &c);
+            }
+            nada_big_free(&divisor);
+        }
+        nada_big_free(&c);
+    }
+
+    nada_big_free(&rest);
+    nada_big_free(&quotient);
+    free(pending.items);
+
+    qsort(found.items, found.count, sizeof(NadaBigInt), factor_compare);
+    *count = found.count;
+    return found.items;
+}
@@ -511,8 +511,18 @@ NadaValue *builtin_string_to_number(NadaValue *args, NadaEnv *env) {
         return nada_create_bool(0);  // Return #f for invalid number
     }
 
-    NadaValue *result = nada_create_num_from_string(str_val->data.string);
+    // As in R7RS, a decimal point makes the number inexact here, so that
+    // number->string output reads back as the same flonum. Decimal
+    // literals in source stay exact.
+    NadaNum *num = nada_num_from_string(str_val->data.string);
+    if (strchr(str_val->data.string, '.') && nada_num_is_exact(num)) {
+        NadaNum *inexact = nada_num_to_inexact(num);
+        nada_num_free(num);
+        num = inexact;
+    }
     nada_free(str_val);
+    NadaValue *result = nada_create_num(num);
+    nada_num_free(num);
     return result;
 }
 
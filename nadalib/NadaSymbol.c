@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "NadaSymbol.h"
+
+// A table entry owns the name and the symbol value that refers to it
+typedef struct {
+    NadaValue value;  // Immortal NADA_SYMBOL, value.data.symbol == name
+    NadaSymbolDispatch dispatch;
+    uint32_t hash;
+    char name[];
+} SymbolEntry;
+
+// Open-addressing hash table, capacity is a power of two kept at most half full
+static SymbolEntry **table = NULL;
+static size_t table_capacity = 0;
+static size_t table_count = 0;
+
+// FNV-1a
+static uint32_t hash_name(const char *name) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void table_grow(void) {
+    size_t new_capacity = table_capacity ? table_capacity * 2 : 512;
+    SymbolEntry **new_table = calloc(new_capacity, sizeof(SymbolEntry *));
+    if (new_table == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < table_capacity; i++) {
+        SymbolEntry *entry = table[i];
+        if (entry == NULL) continue;
+        size_t slot = entry->hash & (new_capacity - 1);
+        while (new_table[slot] != NULL) {
+            slot = (slot + 1) & (new_capacity - 1);
+        }
+        new_table[slot] = entry;
+    }
+
+    free(table);
+    table = new_table;
+    table_capacity = new_capacity;
+}
+
+static SymbolEntry *intern_entry(const char *name) {
+    if (table_count * 2 >= table_capacity) {
+        table_grow();
+    }
+
+    uint32_t hash = hash_name(name);
+    size_t slot = hash & (table_capacity - 1);
+    while (table[slot] != NULL) {
+        SymbolEntry *entry = table[slot];
+        if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+        slot = (slot + 1) & (table_capacity - 1);
+    }
+
+    // New symbol
+    size_t len = strlen(name);
+    SymbolEntry *entry = malloc(sizeof(SymbolEntry) + len + 1);
+    if (entry == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    memcpy(entry->name, name, len + 1);
+    entry->hash = hash;
+    entry->value.type = NADA_SYMBOL;
+    entry->value.ref_count = NADA_REF_IMMORTAL;
+    entry->value.data.symbol = entry->name;
+    entry->dispatch = (NadaSymbolDispatch){0};
+
+    table[slot] = entry;
+    table_count++;
+    return entry;
+}
+
+const char *nada_intern(const char *name) {
+    return intern_entry(name)->name;
+}
+
+NadaValue *nada_symbol_value(const char *name) {
+    return &intern_entry(name)->value;
+}
+
+NadaSymbolDispatch *nada_symbol_dispatch(const char *sym) {
+    // sym points at the name stored inside its entry
+    SymbolEntry *entry = (SymbolEntry *)(sym - offsetof(SymbolEntry, name));
+    return &entry->dispatch;
+}
+
+size_t nada_symbol_count(void) {
+    return table_count;
+}
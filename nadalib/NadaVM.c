@@ -0,0 +1,1112 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "NadaVM.h"
+#include "NadaAnalyze.h"
+#include "NadaEval.h"
+#include "NadaError.h"
+#include "NadaSymbol.h"
+#include "NadaBuiltinSpecialForms.h"
+#include "NadaBuiltinBoolOps.h"
+
+// Dispatch with computed goto where the compiler supports labels as values
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+// Instructions, with the operands that follow them in the code array.
+// Jump targets are absolute offsets into the code.
+typedef enum {
+    OP_CONST,              // k: push consts[k]
+    OP_REF,                // r: push the value of the variable refs[r]
+    OP_POP,                // drop the top value
+    OP_JUMP,               // t: jump to t
+    OP_JUMP_IF_FALSE,      // t: pop, jump to t if it was #f (if)
+    OP_JUMP_UNLESS,        // t: pop, jump to t if it was #f or nil (cond)
+    OP_AND,                // t: jump to t if the top is #f or nil, else pop it
+    OP_OR,                 // t: jump to t unless the top is #f or nil, else pop it
+    OP_JUMP_IF_ERROR,      // t: jump to t if the top is an error
+    OP_BAIL,               // k t: if the top is an error, drop the k values
+                           //      below it and jump to t
+    OP_DEFINE,             // n: pop a value, bind names[n] to it, push the name
+    OP_DEFINE_FUNC,        // f: define the function of templates[f], push its name
+    OP_SET,                // r: pop a value and assign it to refs[r], push it
+    OP_LAMBDA,             // f: push a closure of templates[f]
+    OP_LET,                // f: pop the values of the bindings of templates[f]
+                           //    into the slots of a new frame
+    OP_LEAVE_LET,          // return to the environment enclosing the let
+    OP_NAMED_LET,          // f: like OP_LET, then define the loop function
+    OP_LEAVE_NAMED_LET,    // return to the environment enclosing the named let
+    OP_CALL_RAW,           // s: call the builtin of sites[s] with its unevaluated
+                           //    arguments, push the result
+    OP_CALL_NAMED,         // s n: call the function named by sites[s] with the
+                           //      top n values, push the result
+    OP_CALL,               // s n: call the function below the top n values
+    OP_TAIL_CALL_NAMED,    // s n: OP_CALL_NAMED in tail position
+    OP_TAIL_CALL,          // s n: OP_CALL in tail position
+    OP_FORM,               // s: apply the special form of sites[s] to its arguments
+    OP_RETURN              // return the top value
+} OpCode;
+
+// A call or special form left to its builtin
+typedef struct {
+    NadaValue *op;    // Operator expression, for error messages
+    NadaValue *args;  // Unevaluated arguments
+    NadaSymbolDispatch *dispatch;  // Of the operator, when it is a symbol
+    const char *sym;
+    NadaVarRef ref;    // The operator variable, when it is a symbol
+    BuiltinFunc form;  // OP_FORM only
+} CallSite;
+
+// A lambda, function definition or let
+typedef struct {
+    const char *sym;     // Defined name or loop function of a named let
+    NadaValue *params;
+    NadaValue *body;
+    NadaCode *code;
+    int count;                // Let bindings
+    NadaFrameLayout *layout;  // Frame of a let
+} Template;
+
+struct NadaBytecode {
+    int *code;
+    int length;
+    NadaValue **consts;
+    int const_count;
+    const char **names;
+    int name_count;
+    NadaVarRef *refs;
+    int ref_count;
+    CallSite *sites;
+    int site_count;
+    Template *templates;
+    int template_count;
+    int max_stack;  // Values the code pushes at most
+};
+
+static NadaEngine current_engine = NADA_ENGINE_TREE;
+
+void nada_set_engine(NadaEngine engine) {
+    current_engine = engine;
+}
+
+NadaEngine nada_get_engine(void) {
+    return current_engine;
+}
+
+static void *checked_realloc(void *p, size_t size) {
+    p = realloc(p, size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+// ----- Compiler -----
+
+typedef struct {
+    NadaBytecode *bc;
+    int code_capacity;
+    int depth;               // Values on the stack at the current instruction
+    NadaFrameLayout *scope;  // Frame the current instruction runs in
+    int tail;                // The expression's value is the value of the body
+} Compiler;
+
+static void compile_expr(Compiler *c, NadaValue *expr);
+static void compile_seq(Compiler *c, NadaValue *exprs);
+
+// Compile an expression whose value is used by the code that follows
+static void compile_operand(Compiler *c, NadaValue *expr) {
+    int tail = c->tail;
+    c->tail = 0;
+    compile_expr(c, expr);
+    c->tail = tail;
+}
+
+// Grow an array of count elements so one more fits; the capacity is the
+// next power of two
+#define GROW(array, count)                                                                 \
+    do {                                                                                   \
+        if (((count) & ((count) - 1)) == 0) {                                              \
+            (array) = checked_realloc((array), ((count) ? 2 * (count) : 1) * sizeof(*(array))); \
+        }                                                                                  \
+    } while (0)
+
+static void emit(Compiler *c, int word) {
+    NadaBytecode *bc = c->bc;
+    if (bc->length == c->code_capacity) {
+        c->code_capacity = c->code_capacity ? 2 * c->code_capacity : 32;
+        bc->code = checked_realloc(bc->code, c->code_capacity * sizeof(int));
+    }
+    bc->code[bc->length++] = word;
+}
+
+// Track the stack depth of the code emitted so far
+static void stack_effect(Compiler *c, int delta) {
+    c->depth += delta;
+    if (c->depth > c->bc->max_stack) {
+        c->bc->max_stack = c->depth;
+    }
+}
+
+// Emit a jump with its target still open; returns where to patch it
+static int emit_jump(Compiler *c, int op) {
+    emit(c, op);
+    emit(c, -1);
+    return c->bc->length - 1;
+}
+
+static void patch_jump(Compiler *c, int at) {
+    c->bc->code[at] = c->bc->length;
+}
+
+static int add_const(Compiler *c, NadaValue *value) {
+    NadaBytecode *bc = c->bc;
+    GROW(bc->consts, bc->const_count);
+    bc->consts[bc->const_count] = nada_retain(value);
+    return bc->const_count++;
+}
+
+static int add_name(Compiler *c, const char *sym) {
+    NadaBytecode *bc = c->bc;
+    for (int i = 0; i < bc->name_count; i++) {
+        if (bc->names[i] == sym) return i;
+    }
+    GROW(bc->names, bc->name_count);
+    bc->names[bc->name_count] = sym;
+    return bc->name_count++;
+}
+
+static int add_ref(Compiler *c, const char *sym) {
+    NadaBytecode *bc = c->bc;
+    for (int i = 0; i < bc->ref_count; i++) {
+        if (bc->refs[i].sym == sym && bc->refs[i].layout == c->scope) return i;
+    }
+    GROW(bc->refs, bc->ref_count);
+    nada_resolve_var(&bc->refs[bc->ref_count], c->scope, sym);
+    return bc->ref_count++;
+}
+
+static int add_site(Compiler *c, NadaValue *op, NadaValue *args, BuiltinFunc form) {
+    NadaBytecode *bc = c->bc;
+    GROW(bc->sites, bc->site_count);
+    CallSite *site = &bc->sites[bc->site_count];
+    site->op = nada_retain(op);
+    site->args = nada_retain(args);
+    site->sym = op->type == NADA_SYMBOL ? op->data.symbol : NULL;
+    site->dispatch = site->sym != NULL ? nada_symbol_dispatch(site->sym) : NULL;
+    if (site->sym != NULL) {
+        nada_resolve_var(&site->ref, c->scope, site->sym);
+    }
+    site->form = form;
+    return bc->site_count++;
+}
+
+// A template for a function of params and body created in layout, or for
+// a let with params NULL
+static int add_template(Compiler *c, const char *sym, NadaValue *params, NadaValue *body,
+                        NadaFrameLayout *layout) {
+    NadaBytecode *bc = c->bc;
+    GROW(bc->templates, bc->template_count);
+    Template *t = &bc->templates[bc->template_count];
+    t->sym = sym;
+    t->params = params != NULL ? nada_retain(params) : NULL;
+    t->body = body != NULL ? nada_retain(body) : NULL;
+    t->code = params != NULL ? nada_analyze_lambda(params, body, layout) : NULL;
+    t->count = 0;
+    t->layout = NULL;
+    return bc->template_count++;
+}
+
+static void emit_const(Compiler *c, NadaValue *value) {
+    emit(c, OP_CONST);
+    emit(c, add_const(c, value));
+    stack_effect(c, 1);
+}
+
+static void compile_form(Compiler *c, BuiltinFunc form, NadaValue *op, NadaValue *args) {
+    emit(c, OP_FORM);
+    emit(c, add_site(c, op, args, form));
+    stack_effect(c, 1);
+}
+
+static void compile_if(Compiler *c, NadaValue *op, NadaValue *args) {
+    int count = nada_list_length(args);
+    if (count < 2) {
+        compile_form(c, builtin_if, op, args);
+        return;
+    }
+
+    compile_operand(c, args->data.pair.car);
+    int to_else = emit_jump(c, OP_JUMP_IF_FALSE);
+    stack_effect(c, -1);
+
+    args = args->data.pair.cdr;
+    compile_expr(c, args->data.pair.car);
+    int to_end = emit_jump(c, OP_JUMP);
+    stack_effect(c, -1);
+
+    patch_jump(c, to_else);
+    if (count > 2) {
+        compile_expr(c, args->data.pair.cdr->data.pair.car);
+    } else {
+        emit_const(c, nada_create_nil());  // No else clause
+    }
+    patch_jump(c, to_end);
+}
+
+static void compile_cond(Compiler *c, NadaValue *op, NadaValue *args) {
+    int count = nada_list_length(args);
+    if (count < 0) {
+        compile_form(c, builtin_cond, op, args);
+        return;
+    }
+
+    // Clauses must be lists, else only in the last one
+    const char *sym_else = nada_intern("else");
+    int i = 0;
+    for (NadaValue *clause = args; clause->type == NADA_PAIR; clause = clause->data.pair.cdr, i++) {
+        NadaValue *cl = clause->data.pair.car;
+        if (cl->type != NADA_PAIR || nada_list_length(cl) < 0) {
+            compile_form(c, builtin_cond, op, args);
+            return;
+        }
+        NadaValue *test = cl->data.pair.car;
+        if (test->type == NADA_SYMBOL && test->data.symbol == sym_else && i != count - 1) {
+            compile_form(c, builtin_cond, op, args);
+            return;
+        }
+    }
+
+    int *to_end = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (to_end == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    int exits = 0;
+    int matched_else = 0;
+    for (NadaValue *clause = args; clause->type == NADA_PAIR; clause = clause->data.pair.cdr) {
+        NadaValue *test = clause->data.pair.car->data.pair.car;
+        NadaValue *body = clause->data.pair.car->data.pair.cdr;
+        int is_else = test->type == NADA_SYMBOL && test->data.symbol == sym_else;
+
+        int to_next = -1;
+        if (!is_else) {
+            compile_operand(c, test);
+            to_next = emit_jump(c, OP_JUMP_UNLESS);
+            stack_effect(c, -1);
+        }
+
+        // A clause without body yields true
+        if (nada_is_nil(body)) {
+            emit_const(c, nada_create_bool(1));
+        } else {
+            compile_seq(c, body);
+        }
+
+        if (is_else) {
+            matched_else = 1;
+            break;
+        }
+        to_end[exits++] = emit_jump(c, OP_JUMP);
+        stack_effect(c, -1);
+        patch_jump(c, to_next);
+    }
+
+    // No condition matched
+    if (!matched_else) {
+        emit_const(c, nada_create_nil());
+    }
+    for (int k = 0; k < exits; k++) {
+        patch_jump(c, to_end[k]);
+    }
+    free(to_end);
+}
+
+// (and ...) and (or ...): stop at the first value deciding the result
+static void compile_junction(Compiler *c, int op_code, NadaValue *exprs, int count, int empty) {
+    if (count == 0) {
+        emit_const(c, nada_create_bool(empty));
+        return;
+    }
+
+    int *to_end = malloc(count * sizeof(int));
+    if (to_end == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        if (i < count - 1) {
+            compile_operand(c, exprs->data.pair.car);
+            to_end[i] = emit_jump(c, op_code);
+            stack_effect(c, -1);
+        } else {
+            compile_expr(c, exprs->data.pair.car);
+        }
+        exprs = exprs->data.pair.cdr;
+    }
+    for (int i = 0; i < count - 1; i++) {
+        patch_jump(c, to_end[i]);
+    }
+    free(to_end);
+}
+
+static void compile_define(Compiler *c, NadaValue *op, NadaValue *args) {
+    if (args->type != NADA_PAIR || args->data.pair.cdr->type != NADA_PAIR) {
+        compile_form(c, builtin_define, op, args);
+        return;
+    }
+
+    NadaValue *first = args->data.pair.car;
+
+    // (define symbol expr)
+    if (first->type == NADA_SYMBOL) {
+        compile_operand(c, args->data.pair.cdr->data.pair.car);
+        emit(c, OP_DEFINE);
+        emit(c, add_name(c, first->data.symbol));
+        return;
+    }
+
+    // (define (name params...) body...)
+    if (first->type == NADA_PAIR && first->data.pair.car->type == NADA_SYMBOL &&
+        nada_list_length(args->data.pair.cdr) > 0) {
+        emit(c, OP_DEFINE_FUNC);
+        emit(c, add_template(c, first->data.pair.car->data.symbol, first->data.pair.cdr,
+                             args->data.pair.cdr, c->scope));
+        stack_effect(c, 1);
+        return;
+    }
+
+    compile_form(c, builtin_define, op, args);
+}
+
+// Evaluate the bindings of a let, leaving their values on the stack. An
+// error value ends the let with that value, like builtin_let.
+static void compile_bindings(Compiler *c, NadaValue *bindings, int *to_end) {
+    int i = 0;
+    for (NadaValue *b = bindings; b->type == NADA_PAIR; b = b->data.pair.cdr, i++) {
+        compile_operand(c, b->data.pair.car->data.pair.cdr->data.pair.car);
+        emit(c, OP_BAIL);
+        emit(c, i);
+        emit(c, -1);
+        to_end[i] = c->bc->length - 1;
+    }
+}
+
+static void let_template(Compiler *c, int f, int count, NadaFrameLayout *layout) {
+    Template *t = &c->bc->templates[f];
+    t->count = count;
+    t->layout = layout;
+}
+
+static void compile_let(Compiler *c, NadaValue *op, NadaValue *args) {
+    if (args->type != NADA_PAIR || nada_list_length(args) < 0) {
+        compile_form(c, builtin_let, op, args);
+        return;
+    }
+
+    NadaValue *first = args->data.pair.car;
+    int named = first->type == NADA_SYMBOL;
+    NadaValue *bindings = named ? (args->data.pair.cdr->type == NADA_PAIR ? args->data.pair.cdr->data.pair.car : NULL)
+                                : first;
+    int count = bindings != NULL ? nada_let_bindings(bindings) : -1;
+    NadaValue *body = count >= 0 ? (named ? args->data.pair.cdr->data.pair.cdr : args->data.pair.cdr) : NULL;
+    NadaFrameLayout *layout =
+        count >= 0 ? nada_let_layout(bindings, count, named ? first->data.symbol : NULL, body, c->scope) : NULL;
+    if (layout == NULL) {
+        compile_form(c, builtin_let, op, args);
+        return;
+    }
+    NadaFrameLayout *outer = c->scope;
+
+    int *to_end = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (to_end == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+    compile_bindings(c, bindings, to_end);
+
+    if (!named) {
+        int f = add_template(c, NULL, NULL, NULL, NULL);
+        let_template(c, f, count, layout);
+        emit(c, OP_LET);
+        emit(c, f);
+        stack_effect(c, -count);
+        c->scope = layout;
+        compile_seq(c, body);
+        c->scope = outer;
+        emit(c, OP_LEAVE_LET);
+    } else {
+        // Parameters of the loop function
+        NadaValue *params = nada_create_nil();
+        for (int i = count - 1; i >= 0; i--) {
+            NadaValue *b = bindings;
+            for (int k = 0; k < i; k++) b = b->data.pair.cdr;
+            NadaValue *new_params = nada_cons(b->data.pair.car->data.pair.car, params);
+            nada_free(params);
+            params = new_params;
+        }
+        int f = add_template(c, first->data.symbol, params, body, layout);
+        nada_free(params);
+        let_template(c, f, count, layout);
+        emit(c, OP_NAMED_LET);
+        emit(c, f);
+        stack_effect(c, -count);
+        c->scope = layout;
+
+        // The body stops at the first error, like builtin_let
+        int exprs = nada_list_length(body);
+        if (exprs == 0) {
+            emit_const(c, nada_create_nil());
+        }
+        int *to_leave = malloc((exprs > 0 ? exprs : 1) * sizeof(int));
+        if (to_leave == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+        int i = 0;
+        for (NadaValue *e = body; e->type == NADA_PAIR; e = e->data.pair.cdr, i++) {
+            if (i < exprs - 1) {
+                compile_operand(c, e->data.pair.car);
+                to_leave[i] = emit_jump(c, OP_JUMP_IF_ERROR);
+                emit(c, OP_POP);
+                stack_effect(c, -1);
+            } else {
+                compile_expr(c, e->data.pair.car);
+            }
+        }
+        for (i = 0; i < exprs - 1; i++) {
+            patch_jump(c, to_leave[i]);
+        }
+        free(to_leave);
+        c->scope = outer;
+        emit(c, OP_LEAVE_NAMED_LET);
+    }
+
+    for (int i = 0; i < count; i++) {
+        patch_jump(c, to_end[i]);
+    }
+    free(to_end);
+}
+
+static void compile_call(Compiler *c, NadaValue *op, NadaValue *args) {
+    int argc = 0;
+    for (NadaValue *arg = args; arg->type == NADA_PAIR; arg = arg->data.pair.cdr) {
+        argc++;
+    }
+
+    // Builtins that take their arguments unevaluated are called with them
+    if (op->type == NADA_SYMBOL) {
+        BuiltinFunc builtin = nada_symbol_dispatch(op->data.symbol)->builtin;
+        if (builtin != NULL && !nada_builtin_is_strict(builtin)) {
+            emit(c, OP_CALL_RAW);
+            emit(c, add_site(c, op, args, NULL));
+            stack_effect(c, 1);
+            return;
+        }
+    } else {
+        compile_operand(c, op);
+    }
+
+    for (NadaValue *arg = args; arg->type == NADA_PAIR; arg = arg->data.pair.cdr) {
+        compile_operand(c, arg->data.pair.car);
+    }
+
+    if (c->tail) {
+        emit(c, op->type == NADA_SYMBOL ? OP_TAIL_CALL_NAMED : OP_TAIL_CALL);
+    } else {
+        emit(c, op->type == NADA_SYMBOL ? OP_CALL_NAMED : OP_CALL);
+    }
+    emit(c, add_site(c, op, args, NULL));
+    emit(c, argc);
+    stack_effect(c, op->type == NADA_SYMBOL ? 1 - argc : -argc);
+}
+
+static void compile_pair(Compiler *c, NadaValue *expr) {
+    NadaValue *op = expr->data.pair.car;
+    NadaValue *args = expr->data.pair.cdr;
+
+    if (op->type == NADA_SYMBOL) {
+        int count;
+        switch (nada_symbol_dispatch(op->data.symbol)->special_form) {
+        case NADA_FORM_QUOTE:
+            if (nada_list_length(args) != 1) {
+                compile_form(c, builtin_quote, op, args);
+            } else {
+                emit_const(c, args->data.pair.car);
+            }
+            return;
+        case NADA_FORM_DEFINE:
+            compile_define(c, op, args);
+            return;
+        case NADA_FORM_LAMBDA:
+            if (args->type != NADA_PAIR || nada_list_length(args->data.pair.cdr) < 1 ||
+                !nada_valid_lambda_params(args->data.pair.car)) {
+                compile_form(c, builtin_lambda, op, args);
+            } else {
+                emit(c, OP_LAMBDA);
+                emit(c, add_template(c, NULL, args->data.pair.car, args->data.pair.cdr, c->scope));
+                stack_effect(c, 1);
+            }
+            return;
+        case NADA_FORM_COND:
+            compile_cond(c, op, args);
+            return;
+        case NADA_FORM_LET:
+            compile_let(c, op, args);
+            return;
+        case NADA_FORM_IF:
+            compile_if(c, op, args);
+            return;
+        case NADA_FORM_BEGIN:
+            if (nada_list_length(args) < 0) {
+                compile_form(c, builtin_begin, op, args);
+            } else {
+                compile_seq(c, args);
+            }
+            return;
+        case NADA_FORM_AND:
+        case NADA_FORM_OR: {
+            int is_and = nada_symbol_dispatch(op->data.symbol)->special_form == NADA_FORM_AND;
+            count = nada_list_length(args);
+            if (count < 0) {
+                compile_form(c, is_and ? builtin_and : builtin_or, op, args);
+            } else {
+                compile_junction(c, is_and ? OP_AND : OP_OR, args, count, is_and);
+            }
+            return;
+        }
+        case NADA_FORM_SET:
+            if (nada_list_length(args) != 2 || args->data.pair.car->type != NADA_SYMBOL) {
+                compile_form(c, builtin_set, op, args);
+            } else {
+                compile_operand(c, args->data.pair.cdr->data.pair.car);
+                emit(c, OP_SET);
+                emit(c, add_ref(c, args->data.pair.car->data.symbol));
+            }
+            return;
+        default:
+            break;
+        }
+    }
+
+    compile_call(c, op, args);
+}
+
+static void compile_expr(Compiler *c, NadaValue *expr) {
+    switch (expr->type) {
+    case NADA_SYMBOL:
+        emit(c, OP_REF);
+        emit(c, add_ref(c, expr->data.symbol));
+        stack_effect(c, 1);
+        break;
+    case NADA_PAIR:
+        compile_pair(c, expr);
+        break;
+    default:
+        // Numbers, strings, booleans, nil, errors and functions evaluate to themselves
+        emit_const(c, expr);
+        break;
+    }
+}
+
+// Expressions evaluated in order for the value of the last one
+static void compile_seq(Compiler *c, NadaValue *exprs) {
+    if (exprs->type != NADA_PAIR) {
+        emit_const(c, nada_create_nil());
+        return;
+    }
+    for (; exprs->type == NADA_PAIR; exprs = exprs->data.pair.cdr) {
+        if (exprs->data.pair.cdr->type == NADA_PAIR) {
+            compile_operand(c, exprs->data.pair.car);
+            emit(c, OP_POP);
+            stack_effect(c, -1);
+        } else {
+            compile_expr(c, exprs->data.pair.car);
+        }
+    }
+}
+
+NadaBytecode *nada_compile(NadaValue *body, NadaFrameLayout *layout) {
+    nada_init_dispatch();
+
+    NadaBytecode *bc = calloc(1, sizeof(NadaBytecode));
+    if (bc == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(1);
+    }
+
+    Compiler c = {bc, 0, 0, layout, 1};
+    compile_seq(&c, body);
+    emit(&c, OP_RETURN);
+    return bc;
+}
+
+void nada_bytecode_free(NadaBytecode *bc) {
+    if (bc == NULL) return;
+
+    for (int i = 0; i < bc->const_count; i++) {
+        nada_free(bc->consts[i]);
+    }
+    for (int i = 0; i < bc->site_count; i++) {
+        nada_free(bc->sites[i].op);
+        nada_free(bc->sites[i].args);
+    }
+    for (int i = 0; i < bc->template_count; i++) {
+        Template *t = &bc->templates[i];
+        if (t->params != NULL) nada_free(t->params);
+        if (t->body != NULL) nada_free(t->body);
+        nada_code_release(t->code);
+        nada_layout_release(t->layout);
+    }
+    free(bc->code);
+    free(bc->consts);
+    free(bc->names);
+    free(bc->refs);
+    free(bc->sites);
+    free(bc->templates);
+    free(bc);
+}
+
+// ----- Virtual machine -----
+
+// Value stack shared by nested runs; each run reserves its max_stack on entry.
+// It can move when a nested run grows it, so entries are addressed by index.
+static NadaValue **stack = NULL;
+static int stack_capacity = 0;
+static int sp = 0;
+
+static void reserve_stack(int count) {
+    if (sp + count <= stack_capacity) return;
+    while (stack_capacity < sp + count) {
+        stack_capacity = stack_capacity ? 2 * stack_capacity : 256;
+    }
+    stack = checked_realloc(stack, stack_capacity * sizeof(NadaValue *));
+}
+
+static int is_false(NadaValue *val) {
+    return val->type == NADA_BOOL && val->data.boolean == 0;
+}
+
+// cond, and and or also treat nil as false
+static int is_false_or_nil(NadaValue *val) {
+    return is_false(val) || val->type == NADA_NIL;
+}
+
+// Calls of closures made by nada_vm_run, which runs the callee's body in
+// the same loop: what to resume when the callee returns. Nested runs share
+// the stack, each returns once its own calls are done.
+typedef struct {
+    NadaBytecode *bc;
+    int pc;
+    NadaEnv *env;
+    NadaCode *code;  // Of the callee, held while it runs
+    int lets;        // nada_deferred_let_count before the call
+} CallFrame;
+
+static CallFrame *frames = NULL;
+static int frame_capacity = 0;
+static int frame_count = 0;
+
+static CallFrame *push_frame(void) {
+    if (frame_count == frame_capacity) {
+        frame_capacity = frame_capacity ? 2 * frame_capacity : 64;
+        frames = checked_realloc(frames, frame_capacity * sizeof(CallFrame));
+    }
+    return &frames[frame_count++];
+}
+
+static int is_closure(NadaValue *func) {
+    return func->type == NADA_FUNC && func->data.function.builtin == NULL;
+}
+
+// Apply a builtin or a value that is not a function to evaluated arguments;
+// func is borrowed
+static NadaValue *apply_value(CallSite *site, NadaValue *func, NadaValue **argv, int argc, NadaEnv *env) {
+    if (func->type != NADA_FUNC) {
+        return nada_not_a_function(site->op, nada_retain(func));
+    }
+    return nada_call_builtin_values(func->data.function.builtin, argv, argc, env);
+}
+
+// Leave a call of the closure func to the trampoline, which takes over the
+// arguments (see nada_tail_call); func is borrowed
+static NadaValue *tail_call(NadaValue *func, NadaValue **argv, int argc) {
+    NadaCode *code = nada_code_retain(nada_closure_code(func));
+    nada_env_add_ref(func->data.function.env);
+    return nada_tail_call(code, func->data.function.env, argv, argc);
+}
+
+// A builtin taking unevaluated arguments whose name was rebound
+static NadaValue *call_rebound(CallSite *site, NadaEnv *env) {
+    NadaValue *func = nada_env_find_symbol(env, site->sym);
+    if (func == NULL) {
+        return site->dispatch->builtin(site->args, env);
+    }
+    if (func->type != NADA_FUNC) {
+        return nada_not_a_function(site->op, func);
+    }
+
+    NadaValue *result;
+    if (func->data.function.builtin != NULL) {
+        result = func->data.function.builtin(site->args, env);
+    } else {
+        int argc = 0;
+        for (NadaValue *arg = site->args; arg->type == NADA_PAIR; arg = arg->data.pair.cdr) {
+            argc++;
+        }
+        NadaValue **argv = malloc((argc > 0 ? argc : 1) * sizeof(NadaValue *));
+        if (argv == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+        NadaValue *arg = site->args;
+        for (int i = 0; i < argc; i++, arg = arg->data.pair.cdr) {
+            argv[i] = nada_eval(arg->data.pair.car, env);
+        }
+        result = nada_run_code(nada_closure_code(func), func->data.function.env, argv, argc);
+        free(argv);
+    }
+    nada_free(func);
+    return result;
+}
+
+static void drop(int count) {
+    for (int i = 0; i < count; i++) {
+        nada_free(stack[--sp]);
+    }
+}
+
+NadaValue *nada_vm_run(NadaBytecode *bc, NadaEnv *env) {
+    reserve_stack(bc->max_stack);
+
+    const int *code = bc->code;
+    int pc = 0;
+    NadaValue *val;
+    int base = frame_count;
+
+    // Operands of a closure call: the function, its argc arguments on top of
+    // the stack, and extra values below them to drop with the arguments
+    NadaValue *func;
+    int argc, extra;
+
+#define PUSH(v) (stack[sp++] = (v))
+#define POP() (stack[--sp])
+#define TOP() (stack[sp - 1])
+#define ARG() (code[pc++])
+
+#ifdef VM_COMPUTED_GOTO
+    // Same order as OpCode
+    static void *labels[] = {
+        &&do_OP_CONST, &&do_OP_REF, &&do_OP_POP, &&do_OP_JUMP, &&do_OP_JUMP_IF_FALSE,
+        &&do_OP_JUMP_UNLESS, &&do_OP_AND, &&do_OP_OR, &&do_OP_JUMP_IF_ERROR, &&do_OP_BAIL,
+        &&do_OP_DEFINE, &&do_OP_DEFINE_FUNC, &&do_OP_SET, &&do_OP_LAMBDA, &&do_OP_LET,
+        &&do_OP_LEAVE_LET, &&do_OP_NAMED_LET, &&do_OP_LEAVE_NAMED_LET, &&do_OP_CALL_RAW,
+        &&do_OP_CALL_NAMED, &&do_OP_CALL, &&do_OP_TAIL_CALL_NAMED, &&do_OP_TAIL_CALL, &&do_OP_FORM,
+        &&do_OP_RETURN};
+#define CASE(op) do_##op:
+#define NEXT() goto *labels[code[pc++]]
+    NEXT();
+#else
+#define CASE(op) case op:
+#define NEXT() continue
+    for (;;) {
+        switch (code[pc++]) {
+#endif
+
+    CASE(OP_CONST) {
+        PUSH(nada_retain(bc->consts[ARG()]));
+        NEXT();
+    }
+    CASE(OP_REF) {
+        NadaVarRef *ref = &bc->refs[ARG()];
+        val = nada_env_peek_var(env, ref);
+        if (val != NULL) {
+            PUSH(nada_retain(val));
+        } else {
+            // Reports the unbound symbol
+            PUSH(nada_env_get_symbol(env, ref->sym, nada_is_global_silent_symbol_lookup()));
+        }
+        NEXT();
+    }
+    CASE(OP_POP) {
+        nada_free(POP());
+        NEXT();
+    }
+    CASE(OP_JUMP) {
+        pc = code[pc];
+        NEXT();
+    }
+    CASE(OP_JUMP_IF_FALSE) {
+        val = POP();
+        int target = ARG();
+        if (is_false(val)) pc = target;
+        nada_free(val);
+        NEXT();
+    }
+    CASE(OP_JUMP_UNLESS) {
+        val = POP();
+        int target = ARG();
+        if (is_false_or_nil(val)) pc = target;
+        nada_free(val);
+        NEXT();
+    }
+    CASE(OP_AND) {
+        int target = ARG();
+        if (is_false_or_nil(TOP())) {
+            pc = target;
+        } else {
+            nada_free(POP());
+        }
+        NEXT();
+    }
+    CASE(OP_OR) {
+        int target = ARG();
+        if (!is_false_or_nil(TOP())) {
+            pc = target;
+        } else {
+            nada_free(POP());
+        }
+        NEXT();
+    }
+    CASE(OP_JUMP_IF_ERROR) {
+        int target = ARG();
+        if (TOP()->type == NADA_ERROR) pc = target;
+        NEXT();
+    }
+    CASE(OP_BAIL) {
+        int count = ARG();
+        int target = ARG();
+        if (TOP()->type == NADA_ERROR) {
+            val = POP();
+            drop(count);
+            PUSH(val);
+            pc = target;
+        }
+        NEXT();
+    }
+    CASE(OP_DEFINE) {
+        const char *sym = bc->names[ARG()];
+        val = POP();
+        nada_env_set_symbol(env, sym, val);
+        nada_free(val);
+        PUSH(nada_create_symbol(sym));
+        NEXT();
+    }
+    CASE(OP_DEFINE_FUNC) {
+        Template *t = &bc->templates[ARG()];
+        nada_define_closure(env, t->sym, t->params, t->body, t->code);
+        PUSH(nada_create_symbol(t->sym));
+        NEXT();
+    }
+    CASE(OP_SET) {
+        NadaVarRef *ref = &bc->refs[ARG()];
+        if (!nada_env_assign_var(env, ref, TOP())) {
+            nada_report_error(NADA_ERROR_UNDEFINED_SYMBOL, "set! variable '%s' not found", ref->sym);
+            nada_free(POP());
+            PUSH(nada_create_nil());
+        }
+        NEXT();
+    }
+    CASE(OP_LAMBDA) {
+        Template *t = &bc->templates[ARG()];
+        PUSH(nada_make_closure(t->params, t->body, t->code, env));
+        NEXT();
+    }
+    CASE(OP_LET) {
+        Template *t = &bc->templates[ARG()];
+        NadaEnv *let_env = nada_env_create_frame(env, t->layout);
+        sp -= t->count;
+        for (int i = 0; i < t->count; i++) {
+            let_env->slots[i] = stack[sp + i];
+        }
+        env = let_env;
+        NEXT();
+    }
+    CASE(OP_LEAVE_LET) {
+        NadaEnv *let_env = env;
+        env = let_env->parent;
+        TOP() = nada_leave_let(let_env, TOP(), false);
+        NEXT();
+    }
+    CASE(OP_NAMED_LET) {
+        Template *t = &bc->templates[ARG()];
+
+        // The loop environment holds an extra reference, see builtin_let
+        NadaEnv *loop_env = nada_env_create_frame(env, t->layout);
+        nada_env_add_ref(loop_env);
+        sp -= t->count;
+        for (int i = 0; i < t->count; i++) {
+            loop_env->slots[i] = stack[sp + i];
+        }
+        nada_define_closure(loop_env, t->sym, t->params, t->body, t->code);
+        env = loop_env;
+        NEXT();
+    }
+    CASE(OP_LEAVE_NAMED_LET) {
+        NadaEnv *loop_env = env;
+        env = loop_env->parent;
+        if (TOP()->type == NADA_ERROR) {
+            nada_env_release(loop_env);
+            nada_env_release(loop_env);
+        } else {
+            TOP() = nada_leave_let(loop_env, TOP(), true);
+        }
+        NEXT();
+    }
+    CASE(OP_CALL_RAW) {
+        CallSite *site = &bc->sites[ARG()];
+        if (!site->dispatch->rebound) {
+            val = site->dispatch->builtin(site->args, env);
+        } else {
+            val = call_rebound(site, env);
+        }
+        PUSH(val);
+        NEXT();
+    }
+    CASE(OP_CALL_NAMED)
+    call_named: {
+        CallSite *site = &bc->sites[ARG()];
+        argc = ARG();
+        NadaSymbolDispatch *dispatch = site->dispatch;
+
+        if (dispatch->builtin != NULL && !dispatch->rebound) {
+            val = nada_call_builtin_values(dispatch->builtin, &stack[sp - argc], argc, env);
+        } else {
+            func = nada_env_peek_var(env, &site->ref);
+            if (func != NULL && is_closure(func)) {
+                extra = 0;
+                goto enter;
+            } else if (func != NULL) {
+                val = apply_value(site, func, &stack[sp - argc], argc, env);
+            } else if (dispatch->builtin != NULL) {
+                val = nada_call_builtin_values(dispatch->builtin, &stack[sp - argc], argc, env);
+            } else {
+                // Reports the unbound symbol
+                val = nada_not_a_function(site->op, nada_env_get_symbol(env, site->sym, nada_is_global_silent_symbol_lookup()));
+            }
+        }
+        drop(argc);
+        PUSH(val);
+        NEXT();
+    }
+    CASE(OP_CALL)
+    call: {
+        CallSite *site = &bc->sites[ARG()];
+        argc = ARG();
+        func = stack[sp - argc - 1];
+        if (is_closure(func)) {
+            extra = 1;
+            goto enter;
+        }
+        val = apply_value(site, func, &stack[sp - argc], argc, env);
+        drop(argc + 1);
+        PUSH(val);
+        NEXT();
+    }
+    enter: {
+        // Run the callee's body here, returning to the next instruction.
+        // The binding func came from may change while the body runs.
+        NadaCode *callee = nada_code_retain(nada_closure_code(func));
+        int lets = nada_deferred_let_count();
+        // The arguments move from the stack into the callee's frame
+        NadaEnv *func_env = nada_start_call(callee, func->data.function.env, &stack[sp - argc], argc, &val);
+        sp -= argc;
+        drop(extra);
+        if (func_env == NULL) {
+            nada_code_release(callee);
+            PUSH(val);
+            NEXT();
+        }
+
+        *push_frame() = (CallFrame){bc, pc, env, callee, lets};
+        bc = nada_code_bytecode(callee);
+        code = bc->code;
+        pc = 0;
+        env = func_env;
+        reserve_stack(bc->max_stack);
+        NEXT();
+    }
+    CASE(OP_TAIL_CALL_NAMED) {
+        // Closures are called by the trampoline, anything else as usual
+        CallSite *site = &bc->sites[code[pc]];
+        func = NULL;
+        if (site->dispatch->builtin == NULL || site->dispatch->rebound) {
+            func = nada_env_peek_var(env, &site->ref);
+        }
+        if (func == NULL || !is_closure(func)) {
+            goto call_named;
+        }
+        pc++;
+        argc = ARG();
+        sp -= argc;
+        val = tail_call(func, &stack[sp], argc);
+        PUSH(val);
+        NEXT();
+    }
+    CASE(OP_TAIL_CALL) {
+        argc = code[pc + 1];
+        func = stack[sp - argc - 1];
+        if (!is_closure(func)) {
+            goto call;
+        }
+        pc += 2;
+        sp -= argc;
+        val = tail_call(func, &stack[sp], argc);
+        nada_free(POP());
+        PUSH(val);
+        NEXT();
+    }
+    CASE(OP_FORM) {
+        CallSite *site = &bc->sites[ARG()];
+        // The form can run nested code that moves the stack
+        val = site->form(site->args, env);
+        PUSH(val);
+        NEXT();
+    }
+    CASE(OP_RETURN) {
+        val = POP();
+        if (frame_count == base) {
+            return val;
+        }
+
+        CallFrame *frame = &frames[frame_count - 1];
+        nada_env_release(env);
+        if (val->type == NADA_NIL && nada_is_tail_call(val)) {
+            // The pending call takes the place of this one
+            nada_code_release(frame->code);
+            env = nada_take_tail_call(&frame->code);
+            if (env != NULL) {
+                bc = nada_code_bytecode(frame->code);
+                code = bc->code;
+                pc = 0;
+                reserve_stack(bc->max_stack);
+                NEXT();
+            }
+            val = nada_create_nil();
+        }
+        nada_code_release(frame->code);
+        val = nada_end_call(frame->lets, val);
+
+        bc = frame->bc;
+        code = bc->code;
+        pc = frame->pc;
+        env = frame->env;
+        frame_count--;
+        PUSH(val);
+        NEXT();
+    }
+
+#ifndef VM_COMPUTED_GOTO
+        }
+    }
+#endif
+
+#undef PUSH
+#undef POP
+#undef TOP
+#undef ARG
+#undef CASE
+#undef NEXT
+}
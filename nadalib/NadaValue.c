@@ -5,6 +5,9 @@
 #include "NadaValue.h"
 #include "NadaEval.h"
 #include "NadaOutput.h"
+#include "NadaPool.h"
+#include "NadaSymbol.h"
+#include "NadaAnalyze.h"
 
 // Initialize counters
 static int value_allocations = 0;
@@ -53,25 +56,72 @@ const char *nada_type_name(int type) {
     }
 }
 
-// Have a static nil for car, cdr
+// Immediate values: nil and the booleans are shared, never-freed singletons
 NadaValue nada_static_nil = {
     .type = NADA_NIL,
+    .ref_count = NADA_REF_IMMORTAL,
 };
 
+static NadaValue nada_static_true = {
+    .type = NADA_BOOL,
+    .ref_count = NADA_REF_IMMORTAL,
+    .data.boolean = 1,
+};
+
+static NadaValue nada_static_false = {
+    .type = NADA_BOOL,
+    .ref_count = NADA_REF_IMMORTAL,
+    .data.boolean = 0,
+};
+
+// Small integers are created once on first use and then shared
+static NadaValue small_ints[NADA_SMALL_INT_MAX - NADA_SMALL_INT_MIN + 1];
+
+static NadaValue *small_int_value(int value) {
+    NadaValue *val = &small_ints[value - NADA_SMALL_INT_MIN];
+    if (val->data.number == NULL) {
+        val->type = NADA_NUM;
+        val->ref_count = NADA_REF_IMMORTAL;
+        val->data.number = nada_num_from_int(value);
+    }
+    return val;
+}
+
+// Allocate a value cell with a single owner
+static NadaValue *alloc_value(NadaValueType type) {
+    NadaValue *val = nada_pool_alloc(NADA_POOL_VALUE);
+    val->type = type;
+    val->ref_count = 1;
+    nada_increment_allocations();
+    return val;
+}
+
+// Same, but outside the nursery
+static NadaValue *alloc_old_value(NadaValueType type) {
+    NadaValue *val = nada_pool_alloc_old(NADA_POOL_VALUE);
+    val->type = type;
+    val->ref_count = 1;
+    nada_increment_allocations();
+    return val;
+}
+
 // Create a new number value
 NadaValue *nada_create_num(NadaNum *num) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    if (val == NULL) {
-        fprintf(stderr, "Error: Out of memory\n");
-        exit(1);
+    int small;
+    if (nada_num_fits_int(num, &small) &&
+        small >= NADA_SMALL_INT_MIN && small <= NADA_SMALL_INT_MAX) {
+        return small_int_value(small);
     }
-    val->type = NADA_NUM;
+
+    NadaValue *val = alloc_value(NADA_NUM);
     val->data.number = nada_num_copy(num);  // Make a copy to own the number
-    nada_increment_allocations();
     return val;
 }
 
 NadaValue *nada_create_num_from_int(int value) {
+    if (value >= NADA_SMALL_INT_MIN && value <= NADA_SMALL_INT_MAX) {
+        return small_int_value(value);
+    }
     NadaNum *num = nada_num_from_int(value);
     NadaValue *val = nada_create_num(num);
     nada_num_free(num);  // Free the original since nada_create_num makes a copy
@@ -91,59 +141,42 @@ NadaValue *nada_create_num_from_string(const char *str) {
 
 // Create a new string value
 NadaValue *nada_create_string(const char *str) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    val->type = NADA_STRING;
+    NadaValue *val = alloc_value(NADA_STRING);
     val->data.string = strdup(str);
-    nada_increment_allocations();
     return val;
 }
 
-// Create a new symbol
+// Create a new symbol (symbols are interned and shared)
 NadaValue *nada_create_symbol(const char *name) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    val->type = NADA_SYMBOL;
-    val->data.symbol = strdup(name);
-    nada_increment_allocations();
-    return val;
+    return nada_symbol_value(name);
 }
 
 // Create nil value
 NadaValue *nada_create_nil(void) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    val->type = NADA_NIL;
-    nada_increment_allocations();
-    return val;
+    return &nada_static_nil;
 }
 
 // Create a boolean value
 NadaValue *nada_create_bool(int boolean) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    val->type = NADA_BOOL;
-    val->data.boolean = boolean ? 1 : 0;
-    nada_increment_allocations();
-    return val;
+    return boolean ? &nada_static_true : &nada_static_false;
 }
 
 // Create a cons cell / pair
 NadaValue *nada_cons(NadaValue *car, NadaValue *cdr) {
-    NadaValue *pair = malloc(sizeof(NadaValue));
-    pair->type = NADA_PAIR;
-    // Make deep copies of car and cdr
-    pair->data.pair.car = nada_deep_copy(car);
-    pair->data.pair.cdr = nada_deep_copy(cdr);
-    nada_increment_allocations();
+    NadaValue *pair = alloc_value(NADA_PAIR);
+    // Share car and cdr, the caller keeps its own references
+    pair->data.pair.car = nada_retain(car);
+    pair->data.pair.cdr = nada_retain(cdr);
     return pair;
 }
 
 // Create a function value
 NadaValue *nada_create_function(NadaValue *params, NadaValue *body, NadaEnv *env) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    if (!val) return NULL;
-
-    val->type = NADA_FUNC;
+    NadaValue *val = alloc_value(NADA_FUNC);
     val->data.function.params = params;
     val->data.function.body = body;
     val->data.function.env = env;
+    val->data.function.code = NULL;
     val->data.function.builtin = NULL;
 
     // Add a reference to the environment
@@ -152,7 +185,6 @@ NadaValue *nada_create_function(NadaValue *params, NadaValue *body, NadaEnv *env
         nada_env_add_ref(env);
     }
 
-    nada_increment_allocations();
     return val;
 }
 
@@ -160,7 +192,7 @@ NadaValue *nada_create_function(NadaValue *params, NadaValue *body, NadaEnv *env
 NadaValue *nada_car(NadaValue *pair) {
     if (pair->type != NADA_PAIR) {
         fprintf(stderr, "Error: car called on non-pair\n");
-        return &nada_static_nil;  //  nada_create_nil();
+        return &nada_static_nil;
     }
     return pair->data.pair.car;
 }
@@ -169,7 +201,7 @@ NadaValue *nada_car(NadaValue *pair) {
 NadaValue *nada_cdr(NadaValue *pair) {
     if (pair->type != NADA_PAIR) {
         fprintf(stderr, "Error: cdr called on non-pair\n");
-        return &nada_static_nil;  // nada_create_nil();
+        return &nada_static_nil;
     }
     return pair->data.pair.cdr;
 }
@@ -179,76 +211,163 @@ int nada_is_nil(NadaValue *val) {
     return val->type == NADA_NIL;
 }
 
-// Free a value and its children
+// Drop a reference to a value, freeing it and its children once unowned
 void nada_free(NadaValue *val) {
-    if (val == NULL) return;
+    // Walk list spines iteratively so long lists don't exhaust the C stack
+    while (val != NULL) {
+        if (val->ref_count == NADA_REF_IMMORTAL) return;
+        if (--val->ref_count > 0) return;
+
+        NadaValue *next = NULL;
+        switch (val->type) {
+        case NADA_NUM:
+            nada_num_free(val->data.number);
+            break;
+        case NADA_STRING:
+            free(val->data.string);
+            break;
+        case NADA_SYMBOL:
+            // Interned, owned by the symbol table
+            break;
+        case NADA_PAIR:
+            nada_free(val->data.pair.car);
+            next = val->data.pair.cdr;
+            break;
+        case NADA_FUNC:
+            nada_free(val->data.function.params);
+            nada_free(val->data.function.body);
+            nada_code_release(val->data.function.code);
+            // Only release the environment if it's not NULL
+            // This handles functions with broken circular references
+            if (val->data.function.env) {
+                // First null out the environment pointer to break any potential cycles
+                NadaEnv *temp_env = val->data.function.env;
+                val->data.function.env = NULL;  // Break potential cycles BEFORE releasing
+
+                // Now it's safe to release the environment
+                nada_env_release(temp_env);
+            }
+            break;
+        case NADA_NIL:
+            // No special cleanup needed for nil
+            break;
+        case NADA_BOOL:
+            // No special cleanup needed for boolean
+            break;
+        case NADA_ERROR:
+            free(val->data.error);  // Free the error message string
+            break;
+        }
+
+        nada_pool_free(NADA_POOL_VALUE, val);
+        nada_increment_frees();
+        val = next;
+    }
+}
+
+// Take a reference to a value
+NadaValue *nada_retain(NadaValue *val) {
+    if (val == NULL) return NULL;
+
+#ifndef NADA_ENABLE_GC
+    // Closures get their own cell: environment cycle handling rewrites
+    // data.function.env in place, so function cells must not be shared
+    if (val->type == NADA_FUNC && val->data.function.builtin == NULL) {
+        NadaValue *copy = nada_create_function(nada_retain(val->data.function.params),
+                                               nada_retain(val->data.function.body),
+                                               val->data.function.env);
+        copy->data.function.code = nada_code_retain(val->data.function.code);
+        return copy;
+    }
+#endif
+
+    if (val->ref_count != NADA_REF_IMMORTAL) {
+        val->ref_count++;
+    }
+    return val;
+}
+
+// Print a value (for debugging and REPL output)
+void nada_print(NadaValue *val) {
+    nada_write_value(val);
+}
+
+static int is_young(const NadaValue *val) {
+    return val->ref_count != NADA_REF_IMMORTAL && nada_pool_is_young(val);
+}
+
+// Copy a single young cell into the old generation, promoting its children
+static NadaValue *promote_cell(NadaValue *val) {
+    NadaValue *result = alloc_old_value(val->type);
 
     switch (val->type) {
     case NADA_NUM:
-        nada_num_free(val->data.number);
+        result->data.number = nada_num_copy(val->data.number);
         break;
     case NADA_STRING:
-        free(val->data.string);
-        break;
-    case NADA_SYMBOL:
-        free(val->data.symbol);
+        result->data.string = strdup(val->data.string);
         break;
-    case NADA_PAIR:
-        if (val->data.pair.car) {
-            nada_free(val->data.pair.car);
-            val->data.pair.car = NULL;  // Prevent double-free
-        }
-        if (val->data.pair.cdr) {
-            nada_free(val->data.pair.cdr);
-            val->data.pair.cdr = NULL;  // Prevent double-free
-        }
+    case NADA_ERROR:
+        result->data.error = strdup(val->data.error);
         break;
     case NADA_FUNC:
-        if (val->data.function.params) {
-            nada_free(val->data.function.params);
-            val->data.function.params = NULL;  // Prevent double-free
-        }
-        if (val->data.function.body) {
-            nada_free(val->data.function.body);
-            val->data.function.body = NULL;  // Prevent double-free
-        }
-        // Only release the environment if it's not NULL
-        // This handles functions with broken circular references
-        if (val->data.function.env) {
-            // First null out the environment pointer to break any potential cycles
-            NadaEnv *temp_env = val->data.function.env;
-            val->data.function.env = NULL;  // Break potential cycles BEFORE releasing
-
-            // Now it's safe to release the environment
-            nada_env_release(temp_env);
+        result->data.function.params = nada_promote(val->data.function.params);
+        result->data.function.body = nada_promote(val->data.function.body);
+        result->data.function.env = val->data.function.env;
+        result->data.function.code = nada_code_retain(val->data.function.code);
+        result->data.function.builtin = val->data.function.builtin;
+        if (result->data.function.env) {
+            nada_env_add_ref(result->data.function.env);
         }
         break;
-    case NADA_NIL:
-        // No special cleanup needed for nil
-        break;
-    case NADA_BOOL:
-        // No special cleanup needed for boolean
-        break;
-    case NADA_ERROR:
-        free(val->data.error);  // Free the error message string
+    default:
+        // Pairs are handled by nada_promote, the rest are immortal
+        result->data = val->data;
         break;
     }
-
-    free(val);
-    nada_increment_frees();
+    return result;
 }
 
-// Print a value (for debugging and REPL output)
-void nada_print(NadaValue *val) {
-    nada_write_value(val);
+// Take a reference for a long-lived place, copying young cells out of the nursery
+NadaValue *nada_promote(NadaValue *val) {
+    if (val == NULL) return NULL;
+#ifndef NADA_ENABLE_GC
+    // Closures always get their own cell (see nada_retain)
+    if (val->type == NADA_FUNC && val->data.function.builtin == NULL) {
+        return promote_cell(val);
+    }
+#endif
+    if (!is_young(val)) {
+        return nada_retain(val);
+    }
+    if (val->type != NADA_PAIR) {
+        return promote_cell(val);
+    }
+
+    // Copy the young prefix of a list spine iteratively
+    NadaValue *head = NULL;
+    NadaValue **tail = &head;
+    while (val->type == NADA_PAIR && is_young(val)) {
+        NadaValue *pair = alloc_old_value(NADA_PAIR);
+        pair->data.pair.car = nada_promote(val->data.pair.car);
+        *tail = pair;
+        tail = &pair->data.pair.cdr;
+        val = val->data.pair.cdr;
+    }
+    *tail = nada_promote(val);
+    return head;
 }
 
 // Deep copy a value and all its children
 NadaValue *nada_deep_copy(NadaValue *val) {
     if (val == NULL) return NULL;
+    if (val->ref_count == NADA_REF_IMMORTAL) return val;
+
+    if (val->type == NADA_ERROR) {
+        return nada_create_error(val->data.error);
+    }
 
-    NadaValue *result = malloc(sizeof(NadaValue));
-    result->type = val->type;
+    NadaValue *result = alloc_value(val->type);
 
     switch (val->type) {
     case NADA_NUM:
@@ -258,7 +377,7 @@ NadaValue *nada_deep_copy(NadaValue *val) {
         result->data.string = strdup(val->data.string);
         break;
     case NADA_SYMBOL:
-        result->data.symbol = strdup(val->data.symbol);
+        result->data.symbol = val->data.symbol;  // Interned
         break;
     case NADA_NIL:
         // No additional initialization needed for nil
@@ -271,6 +390,7 @@ NadaValue *nada_deep_copy(NadaValue *val) {
         result->data.function.params = nada_deep_copy(val->data.function.params);
         result->data.function.body = nada_deep_copy(val->data.function.body);
         result->data.function.env = val->data.function.env;          // Share environment
+        result->data.function.code = nada_code_retain(val->data.function.code);
         result->data.function.builtin = val->data.function.builtin;  // Copy the built-in function pointer
 
         // Add reference to shared environment
@@ -282,28 +402,20 @@ NadaValue *nada_deep_copy(NadaValue *val) {
         result->data.boolean = val->data.boolean;
         break;
     case NADA_ERROR:
-        return nada_create_error(val->data.error);
+        break;
     }
 
-    nada_increment_allocations();
     return result;
 }
 
 // Create an error value
 NadaValue *nada_create_error(const char *message) {
-    NadaValue *val = malloc(sizeof(NadaValue));
-    if (val == NULL) {
-        fprintf(stderr, "Error: Out of memory when creating error value\n");
-        exit(1);
-    }
-    val->type = NADA_ERROR;
+    NadaValue *val = alloc_value(NADA_ERROR);
     val->data.error = strdup(message);
     if (val->data.error == NULL) {
         fprintf(stderr, "Error: Out of memory when duplicating error message\n");
-        free(val);
         exit(1);
     }
-    nada_increment_allocations();
     return val;
 }
 
@@ -62,39 +62,31 @@
           ;; n = d*q + r  ⇒  q = (n – r)/d
           (/ (- n r) d)))))
 
-(define integer-sqrt-loop (lambda (low high n)
-  (let ((mid (quotient (+ low high) 2)))
-    (if (= mid low)
-        low
-        (if (> (* mid mid) n)
-            (integer-sqrt-loop low mid n)
-            (integer-sqrt-loop mid high n))))))
-
 ;; Integer square root - returns largest integer not exceeding sqrt(n)
 (define integer-sqrt
   (lambda (n)
     (if (< n 0)
         (error "Cannot compute square root of negative number")
-        (integer-sqrt-loop 0 (+ n 1) n))))
+        (exact-integer-sqrt n))))
 
 (define zero?
   (lambda (x)
     (cond ((number? x) (= x 0))
           (else #f))))
 
-;; Extract the largest square divisor of n by walking down from integer‑sqrt(n)
-;; Extract the largest square divisor of n using mutation (`set!`)
+;; Multiply one copy of each prime that occurs twice in a row in the
+;; sorted list primes into i
+(define square-divisor-loop
+  (lambda (primes i)
+    (cond
+      ((or (null? primes) (null? (cdr primes))) i)
+      ((= (car primes) (cadr primes)) (square-divisor-loop (cddr primes) (* i (car primes))))
+      (else (square-divisor-loop (cdr primes) i)))))
+
+;; Largest i with i^2 dividing n, from the prime factorization of n
 (define largest-square-divisor
   (lambda (n)
-    (let ((i (integer-sqrt n)))
-      (let loop ()
-        (cond
-          ((<= i 1) 1)
-          ((zero? (remainder n (* i i))) i)
-          (else
-            (begin
-              (set! i (- i 1))   ; decrement i by 1
-              (loop))))))))
+    (square-divisor-loop (factor n) 1)))
 
 (define notnumber?
   (lambda (x)
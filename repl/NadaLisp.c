@@ -13,6 +13,8 @@
 #include "NadaString.h"
 #include "NadaError.h"
 #include "NadaOutput.h"  // Include the new output header
+#include "NadaVM.h"
+#include "NadaAnalyze.h"
 
 // Global environment
 static NadaEnv *global_env;
@@ -206,8 +208,11 @@ void run_repl(void) {
 }
 
 void print_usage() {
-    nada_write_string("Usage: nada [-n] [-c expr | -e expr | filename]\n");
+    nada_write_string("Usage: nada [-n] [--vm] [--max-depth n] [-c expr | -e expr | filename]\n");
     nada_write_string("  -n: do not load the standard libraries\n");
+    nada_write_string("  --vm: run functions with the bytecode VM instead of the tree interpreter\n");
+    nada_write_string("  --max-depth n: allow at most n nested function calls (default 1000000); a deeper\n");
+    nada_write_string("                 call fails with an error that the innermost (error? expr) catches\n");
     nada_write_string("  -e expr: interpret expr as Scheme expression, evaluate it, exit\n");
     nada_write_string("  -c expr: interpret expr as textual algebraic expression, evaluate it, exit\n");
     nada_write_string("  If neither -e nor -c is given, expr is interpreted as a Scheme filename\n");
@@ -234,6 +239,18 @@ int main(int argc, char *argv[]) {
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-n") == 0) {
             load_libs = 0;
+        } else if (strcmp(argv[i], "--vm") == 0) {
+            nada_set_engine(NADA_ENGINE_VM);
+        } else if (strcmp(argv[i], "--max-depth") == 0) {
+            int depth = i + 1 < argc ? atoi(argv[++i]) : 0;
+            if (depth <= 0) {
+                nada_write_format("Error: --max-depth requires a positive number\n");
+                print_usage();
+                nada_cleanup_env(global_env);
+                nada_output_cleanup();
+                return 1;
+            }
+            nada_set_max_depth(depth);
         } else if (strcmp(argv[i], "-e") == 0) {
             eval_scheme = 1;
             // Get the expression from the next argument
@@ -14,6 +14,9 @@
 (define-test "integer-sqrt-above-square"
   (assert-equal (integer-sqrt 17) 4))
 
+(define-test "integer-sqrt-big"
+  (assert-equal (integer-sqrt (expt 2 201)) 1792728671193156477399422023278))
+
 
 ;; Tests for largest-square-divisor
 (define-test "largest-square-divisor-prime"
@@ -28,6 +31,9 @@
 (define-test "largest-square-divisor-composite-18"
   (assert-equal (largest-square-divisor 18) 3))
 
+(define-test "largest-square-divisor-big"
+  (assert-equal (largest-square-divisor (* 4 9 7 10007 10007 1000000007)) 60042))
+
 ;; Symbolic evaluation tests
 (define-test "eval-symbolic-1"
   (assert-equal (eval-symbolic '(+ 1 (+ x 2) x 3 y)) '(+ 6 (* 2 x) y)))
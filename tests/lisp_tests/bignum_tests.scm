@@ -0,0 +1,63 @@
+; Tests for arbitrary precision integers and rationals
+
+(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))
+(define big-a 123456789012345678901234567890123456789)
+(define big-b 98765432109876543210987)
+
+; ----- Limb Boundaries -----
+(define-test "bignum-carry-32" (assert-equal (+ 4294967295 1) 4294967296))
+(define-test "bignum-carry-64" (assert-equal (+ 18446744073709551615 1) 18446744073709551616))
+(define-test "bignum-borrow-64" (assert-equal (- 18446744073709551616 1) 18446744073709551615))
+(define-test "bignum-square-64" (assert-equal (* 18446744073709551616 4294967296) 79228162514264337593543950336))
+(define-test "bignum-sign-cross" (assert-equal (- 1 18446744073709551616) -18446744073709551615))
+
+; ----- Multiplication and Division -----
+(define-test "bignum-factorial" (assert-equal (fact 50) 30414093201713378043612608166064768844377641568960512000000000000))
+(define-test "bignum-multiply" (assert-equal (* big-a big-b) 12193263113702179522618422493004842249299264898618678204540743))
+(define-test "bignum-remainder" (assert-equal (remainder big-a big-b) 14063317902772253664))
+(define-test "bignum-quotient" (assert-equal (/ (- big-a (remainder big-a big-b)) big-b) 1249999988609375))
+(define-test "bignum-modulo-negative" (assert-equal (modulo (- big-a) big-b) (- big-b 14063317902772253664)))
+(define-test "bignum-divide-exact" (assert-equal (/ (fact 40) (fact 38)) 1560))
+(define-test "bignum-expt-rational" (assert-equal (expt -2/3 -65) -10301051460877537453973547267843/36893488147419103232))
+(define-test "bignum-expt-mod-word" (assert-equal (expt-mod 3 1000 1000000007) 56888193))
+(define-test "bignum-expt-mod-odd" (assert-equal (expt-mod 7 (expt 10 40) (- (expt 2 127) 1)) 160547947082116214724962510854064275266))
+(define-test "bignum-expt-mod-even" (assert-equal (expt-mod 2 (expt 2 64) (expt 10 30)) 804367570259007866971447361536))
+(define-test "bignum-remainder-long-divisor" (assert-equal (remainder (fact 100) (+ (expt 2 200) 1)) 1341983381356805572777851679393776150974560920604900279812935))
+(define-test "bignum-quotient-long-divisor" (assert-equal (/ (- (fact 100) (remainder (fact 100) (+ (expt 2 200) 1))) (+ (expt 2 200) 1)) 58077046453262489576172766509561862644074070833915725568956775306606909088634596728769577563356345))
+(define-test "bignum-remainder-huge" (assert-equal (remainder (remainder (expt 3 25000) (+ (expt 7 6000) 1)) 1000000007) 778727363))
+(define-test "bignum-quotient-huge" (assert-equal (remainder (/ (- (expt 3 25000) (remainder (expt 3 25000) (+ (expt 7 6000) 1))) (+ (expt 7 6000) 1)) 1000000007) 402101867))
+
+; ----- Rationals -----
+(define-test "bignum-rational-reduce" (assert-equal (/ (fact 30) (+ (fact 32) 1)) 265252859812191058636308480000000/263130836933693530167218012160000001))
+(define-test "bignum-rational-add" (assert-equal (+ 1/3 (/ 1 (expt 2 40))) 1099511627779/3298534883328))
+(define-test "bignum-rational-compare" (assert-equal (< (/ (fact 20) (+ (fact 21) 1)) 1/21) #t))
+(define-test "bignum-numerator" (assert-equal (numerator (/ big-b big-a)) 32921810703292181070329))
+(define (harmonic n) (if (= n 0) 0 (+ (/ 1 n) (harmonic (- n 1)))))
+(define-test "bignum-rational-sum" (assert-equal (harmonic 50) 13943237577224054960759/3099044504245996706400))
+(define-test "bignum-rational-cancel" (assert-equal (* (/ (expt 2 100) (expt 3 90)) (/ (expt 3 90) (expt 2 99))) 2))
+(define-test "bignum-rational-sum-integer" (assert-equal (integer? (+ (/ 1 (+ (expt 2 70) 1)) (/ (expt 2 70) (+ (expt 2 70) 1)))) #t))
+(define-test "bignum-nary-sum-cancel" (assert-equal (+ 18446744073709551615 1 -18446744073709551616 1/2 1/3 1/6) 1))
+(define-test "bignum-nary-sum-denominators" (assert-equal (apply + (list 1/4294967311 1/4294967357 (/ -1 (* 4294967311 4294967357)))) (/ 8589934667 (* 4294967311 4294967357))))
+(define-test "bignum-nary-product" (assert-equal (apply * (list 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30)) 265252859812191058636308480000000))
+(define-test "bignum-nary-product-rational" (assert-equal (* 4294967296 4294967296 -4294967296 2/3 3/2 (/ 1 (expt 2 95))) -2))
+(define-test "bignum-nary-inexact" (assert-equal (+ (expt 2 70) 1/3 (inexact 1) (- (expt 2 70))) (inexact 0)))
+
+; ----- Conversion -----
+(define-test "bignum-to-string" (assert-equal (number->string (expt 10 30)) "1000000000000000000000000000000"))
+(define-test "bignum-from-string" (assert-equal (string->number "-1000000000000000000000000000000") (- (expt 10 30))))
+(define-test "bignum-decimal-literal" (assert-equal 0.000000000000000000001 (/ 1 (expt 10 21))))
+(define-test "bignum-float" (assert-equal (float (/ (fact 25) 29) 3) "534869311838999516689655.172"))
+(define-test "bignum-denominator" (assert-equal (denominator (/ 1 (expt 10 20))) 100000000000000000000))
+
+; ----- 64-bit Promotion -----
+(define-test "bignum-promote-add" (assert-equal (+ 18446744073709551615 18446744073709551615) 36893488147419103230))
+(define-test "bignum-promote-multiply" (assert-equal (* 4294967296 4294967296) 18446744073709551616))
+(define-test "bignum-promote-rational" (assert-equal (+ 1/18446744073709551615 1/18446744073709551614) 36893488147419103229/340282366920938463408034375210639556610))
+(define-test "bignum-demote" (assert-equal (= (- (* 4294967296 4294967296) 18446744073709551615) 1) #t))
+(define-test "bignum-demote-divide" (assert-equal (/ (expt 2 100) (expt 2 98)) 4))
+(define-test "bignum-compare-overflow" (assert-equal (< 9223372036854775807/3 9223372036854775806/2) #t))
+(define-test "bignum-long-literal"
+  (assert-equal (- 1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000001 (expt 10 1200)) 1))
+(define-test "bignum-decimal-round-trip" (assert-equal (= (string->number (number->string (expt 7 5000))) (expt 7 5000)) #t))
+(define-test "bignum-decimal-length" (assert-equal (string-length (number->string (expt 7 5000))) 4226))
+(define-test "bignum-decimal-padding" (assert-equal (string-length (number->string (+ (expt 10 400) 7))) 401))
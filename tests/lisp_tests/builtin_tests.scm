@@ -97,6 +97,18 @@
     (undef 'test-var-2)
     (assert-equal (member? 'test-var-2 (env-symbols)) #f)))
 
+(define-test "environment-globals-from-closure"
+  (begin
+    (define global-cell 1)
+    (define (read-global-cell) global-cell)
+    (set! global-cell 2)
+    (define a (read-global-cell))
+    (define global-cell 3)
+    (define b (read-global-cell))
+    (undef 'global-cell)
+    (define global-cell 4)
+    (assert-equal (list a b (read-global-cell)) '(2 3 4))))
+
 ; ----- String and I/O Function Tests -----
 (define-test "string-functions-1" (assert-equal (string-length "hello") 5))
 (define-test "string-functions-3" (assert-equal (string-split "a,b,c" ",") '("a" "b" "c")))
@@ -109,4 +121,14 @@
 
 ; ----- Eval Function Test -----
 (define-test "eval-function-1" (assert-equal (eval '(+ 1 2)) 3))
-(define-test "eval-function-2" (assert-equal (eval (list '+ 2 3)) 5))
\ No newline at end of file
+(define-test "eval-function-2" (assert-equal (eval (list '+ 2 3)) 5))
+; ----- Shadowing Builtins -----
+(define-test "shadow-builtin-parameter" (assert-equal ((lambda (list) (list 1 2)) +) 3))
+(define-test "shadow-builtin-let"
+  (assert-equal (let ((length (lambda (x) 'mine))) (length '(1 2))) 'mine))
+(define-test "shadow-builtin-outside" (assert-equal (length '(1 2)) 2))
+(define (string-upcase s) (string-append s "!"))
+(define-test "shadow-builtin-define" (assert-equal (string-upcase "a") "a!"))
+(define-test "shadow-builtin-map" (assert-equal (map string-upcase '("a" "b")) '("a!" "b!")))
+(undef 'string-upcase)
+(define-test "shadow-builtin-undef" (assert-equal (string-upcase "a") "A"))
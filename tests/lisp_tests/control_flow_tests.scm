@@ -75,4 +75,67 @@
 (define-test "define-sugar" 
   (begin
     (define (mul-ten x) (* x 10))
-    (assert-equal (mul-ten 5) 50)))
\ No newline at end of file
+    (assert-equal (mul-ten 5) 50)))
+; The stray cond clause keeps the cond as a special form call, whose
+; nested deep call grows the VM value stack while the form runs
+(define-test "recursion-inside-special-form"
+  (begin
+    (define (depth n) (if (= n 0) 0 (+ 1 (depth (- n 1)))))
+    (define (wrapped) (list 1 (cond (#t (depth 1000)) 5) 3))
+    (assert-equal (wrapped) '(1 1000 3))))
+
+(define-test "tail-call-if"
+  (begin
+    (define (count-down n) (if (= n 0) 'done (count-down (- n 1))))
+    (assert-equal (count-down 200000) 'done)))
+
+(define-test "tail-call-cond-let-begin"
+  (begin
+    (define (sum-to n acc)
+      (cond ((= n 0) acc)
+            (else (let ((next (- n 1)))
+                    (begin (sum-to next (+ acc n)))))))
+    (assert-equal (sum-to 200000 0) 20000100000)))
+
+(define-test "tail-call-and-or"
+  (begin
+    (define (even-n? n) (or (= n 0) (odd-n? (- n 1))))
+    (define (odd-n? n) (and (not (= n 0)) (even-n? (- n 1))))
+    (assert-equal (list (even-n? 200000) (odd-n? 200001)) '(#t #t))))
+
+(define-test "tail-call-named-let"
+  (begin
+    (define (count-loop n)
+      (let loop ((i 0))
+        (if (< i n) (loop (+ i 1)) i)))
+    (assert-equal (count-loop 200000) 200000)))
+
+(define-test "tail-call-closure-argument"
+  (begin
+    (define (apply-to f v) (f v))
+    (define (scale n) (let ((k 3)) (apply-to (lambda (v) (* v k)) n)))
+    (assert-equal (scale 5) 15)))
+
+(define-test "recursion-around-tail-calls"
+  (begin
+    (define (sum-to n) (let loop ((i n) (acc 0)) (if (= i 0) acc (loop (- i 1) (+ acc i)))))
+    (define (sums n) (if (= n 0) '() (cons (sum-to n) (sums (- n 1)))))
+    (assert-equal (sums 4) '(10 6 3 1))))
+
+(define-test "recursion-around-let-tail-calls"
+  (begin
+    (define (call-thunk t) (t))
+    (define (boxed n) (let ((k (* n 10))) (call-thunk (lambda () k))))
+    (define (collect n) (if (= n 0) '() (cons (boxed n) (collect (- n 1)))))
+    (assert-equal (collect 3) '(30 20 10))))
+
+(define-test "recursion-depth-error"
+  (begin
+    (define (count-up n) (if (= n 0) 0 (+ 1 (count-up (- n 1)))))
+    (assert-equal (error? (count-up 2000000)) #t)))
+
+(define-test "recursion-depth-error-caught-in-function"
+  (begin
+    (define (count-up n) (if (= n 0) 0 (+ 1 (count-up (- n 1)))))
+    (define (checked n) (if (error? (count-up n)) 'too-deep (count-up n)))
+    (assert-equal (list (checked 2000000) (checked 10)) '(too-deep 10))))
@@ -102,6 +102,20 @@
 (define-test "expt-neg-both" (assert-equal (expt -3 -2) 1/9))
 (define-test "expt-large" (assert-equal (expt 2 10) 1024))
 (define-test "expt-fraction-base" (assert-equal (expt 1/2 3) 1/8))
+(define-test "expt-mod-basic" (assert-equal (expt-mod 3 4 5) 1))
+(define-test "expt-mod-zero-exp" (assert-equal (expt-mod 7 0 13) 1))
+(define-test "expt-mod-one" (assert-equal (expt-mod 7 5 1) 0))
+(define-test "expt-mod-neg-base" (assert-equal (expt-mod -5 3 7) 1))
+(define-test "exact-integer-sqrt-zero" (assert-equal (exact-integer-sqrt 0) 0))
+(define-test "exact-integer-sqrt-floor" (assert-equal (exact-integer-sqrt 15) 3))
+(define-test "exact-integer-sqrt-square" (assert-equal (exact-integer-sqrt 16) 4))
+(define-test "exact-integer-sqrt-big" (assert-equal (exact-integer-sqrt (expt 10 100)) (expt 10 50)))
+(define-test "exact-integer-sqrt-big-floor" (assert-equal (exact-integer-sqrt (- (expt 10 100) 1)) (- (expt 10 50) 1)))
+(define-test "exact-integer-root-cube" (assert-equal (exact-integer-root 1000 3) 10))
+(define-test "exact-integer-root-floor" (assert-equal (exact-integer-root 999 3) 9))
+(define-test "exact-integer-root-first" (assert-equal (exact-integer-root 5 1) 5))
+(define-test "exact-integer-root-big" (assert-equal (exact-integer-root (expt 12345 7) 7) 12345))
+(define-test "exact-integer-root-big-floor" (assert-equal (exact-integer-root (- (expt 12345 7) 1) 7) 12344))
 
 ;; Tests for number components and factorization
 
@@ -132,6 +146,12 @@
 (define-test "factor-zero" (assert-equal (factor 0) '()))
 (define-test "factor-one" (assert-equal (factor 1) '()))
 (define-test "factor-negative-one" (assert-equal (factor -1) '(-1)))
+(define-test "factor-above-int" (assert-equal (factor (* 4294967291 4294967279)) '(4294967279 4294967291)))
+(define-test "factor-word" (assert-equal (factor 18446744073709551615) '(3 5 17 257 641 65537 6700417)))
+(define-test "factor-fermat-7" (assert-equal (factor (+ (expt 2 128) 1)) '(59649589127497217 5704689200685129054721)))
+(define-test "factor-big-prime" (assert-equal (factor (+ (expt 10 60) 7)) (list (+ (expt 10 60) 7))))
+(define-test "factor-big-negative" (assert-equal (factor (- (* 360 1000000007 (+ (expt 2 89) -1))))
+                                                 (list -1 2 2 2 3 3 5 1000000007 (+ (expt 2 89) -1))))
 
 ;; Helper function to check prime factorization
 (define check-factorization
@@ -51,4 +51,31 @@
 ; ----- Complex Numeric Tests -----
 (define-test "numeric-expressions-1" (assert-equal (+ (* 2 3) (/ 6 2)) 9))
 (define-test "numeric-expressions-2" (assert-equal (- (* 3 (+ 2 1)) 4) 5))
-(define-test "numeric-expressions-3" (assert-equal (/ (* 8 2) (- 5 1)) 4))
\ No newline at end of file
+(define-test "numeric-expressions-3" (assert-equal (/ (* 8 2) (- 5 1)) 4))
+; ----- Inexact Number Tests -----
+(define-test "inexact-convert" (assert-equal (number->string (exact->inexact 1/3)) "0.3333333333333333"))
+(define-test "inexact-round-trip" (assert-equal (inexact->exact (exact->inexact 1/10)) 3602879701896397/36028797018963968))
+(define-test "inexact-rounding" (assert-equal (number->string (inexact 9007199254740993)) "9007199254740992.0"))
+(define-test "inexact-big" (assert-equal (number->string (inexact (/ (+ (expt 2 100) 1) (expt 3 50)))) "1765780.963259017"))
+(define-test "inexact-predicates" (assert-equal (list (exact? 1/2) (inexact? 1/2) (inexact? (inexact 1/2))) '(#t #f #t)))
+(define-test "inexact-contagion" (assert-equal (exact? (+ 1 (inexact 1/2))) #f))
+(define-test "inexact-arithmetic" (assert-equal (* (+ (inexact 1/2) 1/4) 4) (inexact 3)))
+(define-test "inexact-compare" (assert-equal (list (= 1/2 (inexact 1/2)) (< 1/3 (inexact 1/3)) (> (inexact 1) 1/2)) '(#t #f #t)))
+(define-test "inexact-eqv" (assert-equal (equal? 2 (inexact 2)) #f))
+(define-test "inexact-divide-by-zero" (assert-equal (number->string (/ -1 (inexact 0))) "-inf.0"))
+(define-test "inexact-integer" (assert-equal (integer? (inexact 3)) #t))
+(define-test "inexact-modulo" (assert-equal (modulo (inexact -7) 2) (inexact 1)))
+(define-test "inexact-expt" (assert-equal (number->string (expt (inexact 2) 1/2)) "1.4142135623730951"))
+(define-test "inexact-print-positional" (assert-equal (map number->string (list (inexact 100) (inexact 1/1024) (inexact -25/2))) '("100.0" "0.0009765625" "-12.5")))
+(define-test "inexact-print-exponent" (assert-equal (map number->string (list (expt (inexact 10) 20) (inexact 3/20000000))) '("1e+20" "1.5e-07")))
+(define-test "inexact-read-exponent" (assert-equal (list (exact? 1e3) (= 1e3 1000) (string->number "2.5E-1")) (list #f #t (inexact 1/4))))
+(define-test "inexact-string-round-trip"
+  (assert-equal (map (lambda (x) (= (string->number (number->string x)) x))
+                     (list (inexact 1/3) (inexact 100) (expt (inexact 10) 20) (inexact 3/20000000) (inexact -2/7)))
+                '(#t #t #t #t #t)))
+(define-test "inexact-compare-exact" (assert-equal (list (= 1/10 (inexact 1/10)) (< 1/10 (inexact 1/10)) (> 9007199254740993 (inexact 9007199254740992)) (= 9007199254740993 (inexact 9007199254740992))) '(#f #t #t #f)))
+(define-test "inexact-compare-special"
+  (begin
+    (define zero (inexact 0))
+    (assert-equal (list (< (expt 10 400) (/ 1 zero)) (> (expt 10 400) (/ -1 zero)) (= (/ zero zero) 0) (< (/ zero zero) 1) (> (/ zero zero) 1))
+                  '(#t #t #f #f #f))))
@@ -17,3 +17,55 @@
         (lambda (x) (+ x n))))
     (assert-equal ((make-adder 2) 10) 12)))
 
+
+(define-test "lambda-rest-args-evaluated"
+  (begin
+    (define (first-and-rest a . rest) (list a rest))
+    (assert-equal (first-and-rest (+ 1 0) (+ 1 1) (* 2 2)) '(1 (2 4)))))
+
+(define-test "lambda-list-args-to-builtins"
+  (begin
+    (define (parts x) (list (car x) x 'y (cdr x)))
+    (assert-equal (parts '(a b)) '(a (a b) y (b)))))
+
+(define-test "lambda-body-special-forms"
+  (begin
+    (define (classify x)
+      (let ((small 10) (count 0))
+        (set! count (+ count 1))
+        (cond ((and (number? x) (< x small)) 'small)
+              ((or (string? x) (symbol? x)) 'word)
+              (else (let loop ((i 0) (acc '()))
+                      (if (= i 3) acc (loop (+ i 1) (cons i acc))))))))
+    (assert-equal (map classify (list 3 "s" 'a 20)) '(small word word (2 1 0)))))
+
+(define-test "map-closure-lexical-scope"
+  (begin
+    (define n 1)
+    (define (add-n x) (+ x n))
+    (define (add-all n) (map add-n (list n)))
+    (assert-equal (add-all 10) '(11))))
+
+(define-test "lambda-internal-define-shadows-param"
+  (begin
+    (define (shadow x)
+      (define y (* x 2))
+      (define x 5)
+      (list x y))
+    (assert-equal (shadow 3) '(5 6))))
+
+(define-test "lambda-set-param-from-inner-closure"
+  (begin
+    (define (counter n)
+      (define (bump!) (set! n (+ n 1)) n)
+      (bump!)
+      (bump!))
+    (assert-equal (counter 10) 12)))
+
+(define-test "let-nested-frames-resolve-outer-names"
+  (begin
+    (define (nest a b)
+      (let ((x (+ a 1)))
+        (let ((y (* x b)) (a 100))
+          (list a b x y))))
+    (assert-equal (nest 1 3) '(100 3 2 6))))
@@ -73,14 +73,13 @@
 (define-test "apply-with-lambda"
   (assert-equal (apply (lambda (x y) (+ x (* y 2))) '(5 7)) 19))
 
-;; currently not working
-;;(define-test "apply-nested"
-;;  (begin
-;;    (define op-list (list + - * /))
-;;    (define arg-lists '((10 5) (10 5) (10 5) (10 5)))
-;;    (assert-equal 
-;;      (map (lambda (op args) (apply op args)) op-list arg-lists)
-;;      '(15 5 50 2))))
+(define-test "apply-nested"
+  (begin
+    (define op-list (list + - * /))
+    (define arg-lists '((10 5) (10 5) (10 5) (10 5)))
+    (assert-equal 
+      (map (lambda (op args) (apply op args)) op-list arg-lists)
+      '(15 5 50 2))))
 
 (define-test "apply-with-varargs-function"
   (begin
@@ -0,0 +1,13 @@
+; Recursion the bytecode VM runs on its heap control stack
+
+(define-test "non-tail-recursion-300k"
+  (begin
+    (define (count-up n) (if (= n 0) 0 (+ 1 (count-up (- n 1)))))
+    (assert-equal (count-up 300000) 300000)))
+
+(define-test "recursion-depth-error-below-deep-frames"
+  (begin
+    (define (count-up n) (if (= n 0) 0 (+ 1 (count-up (- n 1)))))
+    (define (nest n) (if (= n 0) (error? (count-up 2000000)) (nest2 (- n 1))))
+    (define (nest2 n) (let ((r (nest n))) r))
+    (assert-equal (nest 100000) #t)))
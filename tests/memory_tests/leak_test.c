@@ -5,6 +5,7 @@
 #include "NadaError.h"
 #include "NadaConfig.h"
 #include "NadaOutput.h"  // Add the new output header
+#include "NadaPool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -56,8 +57,21 @@ int main(int argc, char *argv[]) {
     nada_free(result);
     nada_cleanup_env(global_env);
 
+    // Pooled objects live in slabs that stay reachable from the pools, so
+    // valgrind cannot see them leak; check the pool counters instead
+    static const char *pool_names[NADA_POOL_CLASS_COUNT] = {"values", "environments", "bindings"};
+    int leaked = 0;
+    for (int cls = 0; cls < NADA_POOL_CLASS_COUNT; cls++) {
+        size_t in_use = nada_pool_in_use(cls);
+        if (in_use != 0) {
+            nada_write_format("Leak: %zu %s still in use after cleanup\n", in_use, pool_names[cls]);
+            leaked = 1;
+        }
+    }
+    nada_pool_trim();
+
     // Clean up output system before exiting
     nada_output_cleanup();
 
-    return 0;
+    return leaked;
 }
\ No newline at end of file
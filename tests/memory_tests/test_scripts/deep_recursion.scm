@@ -0,0 +1,5 @@
+;; tests/memory_tests/test_scripts/deep_recursion.scm
+;; Recursion deeper than the C stack allows ends with an error value
+(define count-up (lambda (n) (if (= n 0) 0 (+ 1 (count-up (- n 1))))))
+(error? (count-up 2000000))
+(count-up 10)
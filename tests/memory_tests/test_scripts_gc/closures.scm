@@ -0,0 +1,17 @@
+;; tests/memory_tests/test_scripts_gc/closures.scm
+;; Closures that capture the environment they are stored in form cycles
+(define (make-counter)
+  (let ((count 0))
+    (lambda () (set! count (+ count 1)) count)))
+(define c (make-counter))
+(c)
+(c)
+(define (make-adders n)
+  (let loop ((i 0) (acc '()))
+    (if (= i n) acc (loop (+ i 1) (cons (lambda (x) (+ x i)) acc)))))
+(define adders (make-adders 10))
+((car adders) 5)
+(define (outer x)
+  (define (inner y) (+ x y))
+  (inner 1))
+(outer 41)
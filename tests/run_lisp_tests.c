@@ -10,6 +10,7 @@
 #include "NadaValue.h"
 #include "NadaConfig.h"
 #include "NadaOutput.h"  // Include the new output header
+#include "NadaVM.h"
 
 static NadaEnv *global_env = NULL;
 static int had_evaluation_error = 0;
@@ -221,22 +222,30 @@ int main(int argc, char *argv[]) {
 
     nada_write_string("=== NadaLisp Test Runner ===\n");
 
+    // --vm runs function bodies as bytecode instead of the node tree
+    int arg = 1;
+    if (argc > arg && strcmp(argv[arg], "--vm") == 0) {
+        nada_set_engine(NADA_ENGINE_VM);
+        nada_write_string("Engine: bytecode VM\n");
+        arg++;
+    }
+
     // If a specific file is provided, just run that file
-    if (argc > 1 && strstr(argv[1], ".scm")) {
+    if (argc > arg && strstr(argv[arg], ".scm")) {
         // Initialize test environment
         init_test_env();
 
-        validate_test_file(argv[1]);
+        validate_test_file(argv[arg]);
 
         // Run the specific test file
-        int result = run_test_file(argv[1]);
+        int result = run_test_file(argv[arg]);
 
         // Clean up output system
         nada_output_cleanup();
 
         return result ? 0 : 1;
     } else {
-        nada_write_format("Usage: %s [test-file.scm]\n", argv[0]);
+        nada_write_format("Usage: %s [--vm] [test-file.scm]\n", argv[0]);
 
         // Clean up output system
         nada_output_cleanup();